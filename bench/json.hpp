@@ -0,0 +1,171 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+#ifndef UMINTL_BENCH_JSON_HPP_
+#define UMINTL_BENCH_JSON_HPP_
+
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <utility>
+
+#include "umintl/tools/exception.hpp"
+
+/** @brief A JSON value, as read by json_parser */
+struct json_value{
+    enum type_t{ NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+
+    json_value() : type(NUL), number(0), boolean(false){ }
+
+    /** @brief Member of an object, or NULL if there is none */
+    json_value const * find(std::string const & key) const{
+        for(std::size_t i = 0 ; i < members.size() ; ++i)
+            if(members[i].first==key)
+                return &members[i].second;
+        return NULL;
+    }
+
+    type_t type;
+    double number;
+    bool boolean;
+    std::string str;
+    std::vector<json_value> elements;
+    std::vector<std::pair<std::string, json_value> > members;
+};
+
+/** @brief Minimal JSON reader, for the files written by umintl-bench. Throws umintl::exceptions::io_error on malformed input */
+class json_parser{
+public:
+    json_parser(std::string const & text) : text_(text), pos_(0){ }
+
+    json_value parse(){
+        json_value res = value();
+        skip();
+        if(pos_ != text_.size())
+            fail("trailing characters");
+        return res;
+    }
+
+private:
+    void fail(std::string const & what) const{
+        std::ostringstream oss;
+        oss << "Invalid JSON at offset " << pos_ << " : " << what;
+        throw umintl::exceptions::io_error(oss.str());
+    }
+
+    void skip(){
+        while(pos_ < text_.size() && std::string(" \t\r\n").find(text_[pos_]) != std::string::npos)
+            ++pos_;
+    }
+
+    void expect(char c){
+        skip();
+        if(pos_ >= text_.size() || text_[pos_] != c)
+            fail(std::string("expected '") + c + "'");
+        ++pos_;
+    }
+
+    bool consume(std::string const & word){
+        if(text_.compare(pos_, word.size(), word) != 0)
+            return false;
+        pos_ += word.size();
+        return true;
+    }
+
+    std::string string(){
+        expect('"');
+        std::string res;
+        while(pos_ < text_.size() && text_[pos_] != '"'){
+            char c = text_[pos_++];
+            if(c == '\\'){
+                if(pos_ >= text_.size())
+                    break;
+                char e = text_[pos_++];
+                switch(e){
+                    case 'n': res += '\n'; break;
+                    case 't': res += '\t'; break;
+                    case 'r': res += '\r'; break;
+                    case 'b': res += '\b'; break;
+                    case 'f': res += '\f'; break;
+                    //Only the control characters written by umintl-bench are expected
+                    case 'u': res += (char)std::strtol(text_.substr(pos_, 4).c_str(), NULL, 16); pos_ += 4; break;
+                    default: res += e;
+                }
+            }
+            else
+                res += c;
+        }
+        expect('"');
+        return res;
+    }
+
+    json_value value(){
+        skip();
+        if(pos_ >= text_.size())
+            fail("unexpected end of input");
+        json_value res;
+        char c = text_[pos_];
+        if(c == '{'){
+            res.type = json_value::OBJECT;
+            ++pos_;
+            skip();
+            if(pos_ < text_.size() && text_[pos_] == '}'){
+                ++pos_;
+                return res;
+            }
+            do{
+                std::string key = string();
+                expect(':');
+                res.members.push_back(std::make_pair(key, value()));
+                skip();
+            }while(pos_ < text_.size() && text_[pos_] == ',' && ++pos_);
+            expect('}');
+        }
+        else if(c == '['){
+            res.type = json_value::ARRAY;
+            ++pos_;
+            skip();
+            if(pos_ < text_.size() && text_[pos_] == ']'){
+                ++pos_;
+                return res;
+            }
+            do{
+                res.elements.push_back(value());
+                skip();
+            }while(pos_ < text_.size() && text_[pos_] == ',' && ++pos_);
+            expect(']');
+        }
+        else if(c == '"'){
+            res.type = json_value::STRING;
+            res.str = string();
+        }
+        else if(consume("null"))
+            res.type = json_value::NUL;
+        else if(consume("true")){
+            res.type = json_value::BOOLEAN;
+            res.boolean = true;
+        }
+        else if(consume("false"))
+            res.type = json_value::BOOLEAN;
+        else{
+            char const * begin = text_.c_str() + pos_;
+            char * end;
+            res.type = json_value::NUMBER;
+            res.number = std::strtod(begin, &end);
+            if(end == begin)
+                fail("unexpected character");
+            pos_ += end - begin;
+        }
+        return res;
+    }
+
+    std::string const & text_;
+    std::size_t pos_;
+};
+
+#endif
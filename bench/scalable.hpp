@@ -0,0 +1,159 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+#ifndef UMINTL_BENCH_SCALABLE_HPP_
+#define UMINTL_BENCH_SCALABLE_HPP_
+
+#include <cmath>
+#include <string>
+
+#include "umintl/forwards.h"
+
+/** @file scalable.hpp
+ *  @brief Large-scale versions of some of the test functions of tests/mghfuns
+ *
+ *  Same functions and starting points as in tests/mghfuns. The value and the gradient are computed in O(N) time and memory
+ *  instead of through the dense M x N jacobian, so that they can be evaluated for N up to 10^7.
+ */
+
+/** @brief Extended Rosenbrock function */
+template<class BackendType>
+class scalable_rosenbrock{
+    typedef typename BackendType::VectorType VectorType;
+    typedef double ScalarType;
+public:
+    scalable_rosenbrock(std::size_t n) : N_(n){
+        if(n%2>0)
+            throw "Provide an even size for the rosenbrock function!";
+    }
+    std::string name() const { return "rosenbrock"; }
+    std::size_t N() const { return N_; }
+    void init(VectorType & X) const{
+        for(std::size_t i = 0 ; i < N_ ; i+=2){
+            X[i] = -1.2;
+            X[i+1] = 1;
+        }
+    }
+    void operator()(VectorType const & X, ScalarType & val, VectorType & grad, umintl::value_gradient) const{
+        val = 0;
+        for(std::size_t i = 0 ; i < N_ ; i+=2){
+            ScalarType r0 = 10*(X[i+1] - X[i]*X[i]);
+            ScalarType r1 = 1 - X[i];
+            val += r0*r0 + r1*r1;
+            grad[i] = -40*X[i]*r0 - 2*r1;
+            grad[i+1] = 20*r0;
+        }
+    }
+private:
+    std::size_t N_;
+};
+
+/** @brief Extended Powell singular function */
+template<class BackendType>
+class scalable_powell_singular{
+    typedef typename BackendType::VectorType VectorType;
+    typedef double ScalarType;
+public:
+    scalable_powell_singular(std::size_t n) : N_(n){
+        if(n%4>0)
+            throw "Invalid";
+    }
+    std::string name() const { return "powell_singular"; }
+    std::size_t N() const { return N_; }
+    void init(VectorType & X) const{
+        for(std::size_t i = 0 ; i < N_ ; i+=4){
+            X[i+0] = 3;
+            X[i+1] = -1;
+            X[i+2] = 0;
+            X[i+3] = 1;
+        }
+    }
+    void operator()(VectorType const & X, ScalarType & val, VectorType & grad, umintl::value_gradient) const{
+        ScalarType sqrt5 = std::sqrt(5.0), sqrt10 = std::sqrt(10.0);
+        val = 0;
+        for(std::size_t i = 0 ; i < N_ ; i+=4){
+            ScalarType d12 = X[i+1] - 2*X[i+2];
+            ScalarType d03 = X[i+0] - X[i+3];
+            ScalarType r0 = X[i+0] + 10*X[i+1];
+            ScalarType r1 = sqrt5*(X[i+2] - X[i+3]);
+            ScalarType r2 = d12*d12;
+            ScalarType r3 = sqrt10*d03*d03;
+            val += r0*r0 + r1*r1 + r2*r2 + r3*r3;
+            grad[i+0] = 2*r0 + 4*sqrt10*r3*d03;
+            grad[i+1] = 20*r0 + 4*r2*d12;
+            grad[i+2] = 2*sqrt5*r1 - 8*r2*d12;
+            grad[i+3] = -2*sqrt5*r1 - 4*sqrt10*r3*d03;
+        }
+    }
+private:
+    std::size_t N_;
+};
+
+/** @brief Trigonometric function. The residuals only depend on the other variables through the sum of their cosines */
+template<class BackendType>
+class scalable_trigonometric{
+    typedef typename BackendType::VectorType VectorType;
+    typedef double ScalarType;
+public:
+    scalable_trigonometric(std::size_t n) : N_(n){ }
+    std::string name() const { return "trigonometric"; }
+    std::size_t N() const { return N_; }
+    void init(VectorType & X) const{
+        for(std::size_t i = 0 ; i < N_ ; i++)
+            X[i] = 1/(ScalarType)N_;
+    }
+    void operator()(VectorType const & X, ScalarType & val, VectorType & grad, umintl::value_gradient) const{
+        ScalarType sum_cos = 0;
+        for(std::size_t i = 0 ; i < N_ ; ++i)
+            sum_cos += std::cos(X[i]);
+        //d(r_i)/d(x_j) = sin(x_j) + delta_ij*((i+1)*sin(x_i) - cos(x_i))
+        ScalarType sum_r = 0;
+        val = 0;
+        for(std::size_t i = 0 ; i < N_ ; ++i){
+            ScalarType r = N_ - sum_cos + (i+1)*(1 - std::cos(X[i])) - std::sin(X[i]);
+            val += r*r;
+            sum_r += r;
+            grad[i] = 2*r*((i+1)*std::sin(X[i]) - std::cos(X[i]));
+        }
+        for(std::size_t i = 0 ; i < N_ ; ++i)
+            grad[i] += 2*sum_r*std::sin(X[i]);
+    }
+private:
+    std::size_t N_;
+};
+
+/** @brief Penalty function I */
+template<class BackendType>
+class scalable_penalty1{
+    typedef typename BackendType::VectorType VectorType;
+    typedef double ScalarType;
+public:
+    scalable_penalty1(std::size_t n) : N_(n){ }
+    std::string name() const { return "penalty1"; }
+    std::size_t N() const { return N_; }
+    void init(VectorType & X) const{
+        for(std::size_t n = 0 ; n < N_ ; ++n)
+            X[n] = n;
+    }
+    void operator()(VectorType const & X, ScalarType & val, VectorType & grad, umintl::value_gradient) const{
+        ScalarType a = 1e-5;
+        ScalarType sum_squares = 0;
+        val = 0;
+        for(std::size_t n = 0 ; n < N_ ; ++n){
+            sum_squares += X[n]*X[n];
+            val += a*(X[n]-1)*(X[n]-1);
+        }
+        ScalarType r = sum_squares - 0.25;
+        val += r*r;
+        for(std::size_t n = 0 ; n < N_ ; ++n)
+            grad[n] = 2*a*(X[n]-1) + 4*r*X[n];
+    }
+private:
+    std::size_t N_;
+};
+
+#endif
@@ -0,0 +1,772 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+/** @file umintl-bench.cpp
+ *  @brief Benchmark suite : runs every direction, line-search and backend on the problems of tests/mghfuns and on large-scale
+ *  versions of some of them, and writes the measurements to JSON.
+ *
+ *  Each run is performed in a child process, so that its peak resident set size is measured independently of the other runs,
+ *  and so that a crash or a timeout only affects that run. Build in Release mode for meaningful timings.
+ *
+ *  With --baseline, the runs of a previous output are performed again with the same settings and compared to it : the status,
+ *  the termination cause and the numbers of iterations and evaluations must match exactly, and the wall-clock time must not
+ *  exceed the baseline by more than a tolerance. The differences are printed, and the exit status is non-zero if there are any.
+ *  The wall-clock times are compared as multiples of the time of a reference run, measured along with them, so that a baseline
+ *  measured on another host remains usable. The numbers of evaluations depend on the rounding, hence on the compiler flags : a
+ *  baseline is only meaningful for the build type it was measured with, which --same-build-type enforces.
+ */
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+#include <unistd.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+//Fortran interface of the BLAS, as expected by the f77blas backend
+#define FORTRAN_WRAPPER(name) name##_
+#define UMINTL_BENCH_DECLARE_BLAS(T, p) \
+    void p##copy_(std::ptrdiff_t *, T *, std::ptrdiff_t *, T *, std::ptrdiff_t *); \
+    void p##axpy_(std::ptrdiff_t *, T *, T *, std::ptrdiff_t *, T *, std::ptrdiff_t *); \
+    void p##scal_(std::ptrdiff_t *, T *, T *, std::ptrdiff_t *); \
+    T p##asum_(std::ptrdiff_t *, T *, std::ptrdiff_t *); \
+    T p##nrm2_(std::ptrdiff_t *, T *, std::ptrdiff_t *); \
+    T p##dot_(std::ptrdiff_t *, T *, std::ptrdiff_t *, T *, std::ptrdiff_t *); \
+    void p##symv_(char *, std::ptrdiff_t *, T *, T *, std::ptrdiff_t *, T *, std::ptrdiff_t *, T *, T *, std::ptrdiff_t *); \
+    void p##gemv_(char *, std::ptrdiff_t *, std::ptrdiff_t *, T *, T *, std::ptrdiff_t *, T *, std::ptrdiff_t *, T *, T *, std::ptrdiff_t *); \
+    void p##syr_(char *, std::ptrdiff_t *, T *, T *, std::ptrdiff_t *, T *, std::ptrdiff_t *); \
+    void p##syr2_(char *, std::ptrdiff_t *, T *, T *, std::ptrdiff_t *, T *, std::ptrdiff_t *, T *, std::ptrdiff_t *); \
+    void p##spmv_(char *, std::ptrdiff_t *, T *, T *, T *, std::ptrdiff_t *, T *, T *, std::ptrdiff_t *); \
+    void p##spr_(char *, std::ptrdiff_t *, T *, T *, std::ptrdiff_t *, T *); \
+    void p##spr2_(char *, std::ptrdiff_t *, T *, T *, std::ptrdiff_t *, T *, std::ptrdiff_t *, T *); \
+    void p##tpmv_(char *, char *, char *, std::ptrdiff_t *, T *, T *, std::ptrdiff_t *); \
+    void p##tpsv_(char *, char *, char *, std::ptrdiff_t *, T *, T *, std::ptrdiff_t *); \
+    void p##rot_(std::ptrdiff_t *, T *, std::ptrdiff_t *, T *, std::ptrdiff_t *, T *, T *);
+extern "C"{
+    UMINTL_BENCH_DECLARE_BLAS(float, s)
+    UMINTL_BENCH_DECLARE_BLAS(double, d)
+}
+
+#include "umintl/backends/cblas.hpp"
+#include "umintl/backends/f77blas.hpp"
+#ifdef UMINTL_BENCH_EIGEN
+#include "umintl/backends/eigen.hpp"
+#endif
+#include "umintl/minimize.hpp"
+#include "umintl/tools/timer.hpp"
+
+#include "mghfuns/beale.hpp"
+#include "mghfuns/biggs_exp6.hpp"
+#include "mghfuns/box_3d.hpp"
+#include "mghfuns/brown_badly_scaled.hpp"
+//Defines a member of powell_singular
+#include "mghfuns/powell_singular.hpp"
+#include "mghfuns/brown_dennis.hpp"
+#include "mghfuns/freudenstein_roth.hpp"
+#include "mghfuns/gaussian.hpp"
+#include "mghfuns/gulf.hpp"
+#include "mghfuns/helical_valley.hpp"
+#include "mghfuns/jenrich_sampson.hpp"
+#include "mghfuns/meyer.hpp"
+#include "mghfuns/penalty1.hpp"
+#include "mghfuns/penalty2.hpp"
+#include "mghfuns/powell_badly_scaled.hpp"
+#include "mghfuns/rosenbrock.hpp"
+#include "mghfuns/trigonometric.hpp"
+#include "mghfuns/variably_dimensioned.hpp"
+#include "mghfuns/watson.hpp"
+#include "mghfuns/wood.hpp"
+
+#include "json.hpp"
+#include "scalable.hpp"
+
+#ifndef UMINTL_VERSION
+#define UMINTL_VERSION "unknown"
+#endif
+
+#ifndef UMINTL_BUILD_TYPE
+#define UMINTL_BUILD_TYPE "unknown"
+#endif
+
+using namespace umintl;
+
+/** @brief Options of the command line */
+struct options{
+    options() : max_dimension(10000000), max_dense_dimension(10000), max_iter(10000), tolerance(1e-5), time_limit(600), list(false)
+              , time_tolerance(0.25), min_time(0.1), same_build_type(false){ }
+    std::vector<std::string> filters;
+    std::size_t max_dimension;
+    std::size_t max_dense_dimension;
+    unsigned int max_iter;
+    double tolerance;
+    unsigned int time_limit;
+    bool list;
+    std::string output;
+    std::string baseline;
+    double time_tolerance;
+    double min_time;
+    bool same_build_type;
+};
+
+/** @brief One run of the suite : a direction, a line-search and a backend on a problem */
+struct benchmark{
+    benchmark(std::string const & _suite, std::string const & _problem, std::size_t _N, std::string const & _direction, std::string const & _line_search, std::string const & _backend)
+        : suite(_suite), problem(_problem), N(_N), direction(_direction), line_search(_line_search), backend(_backend){ }
+    std::string id() const{
+        std::ostringstream oss;
+        oss << suite << "/" << problem << "/" << N << "/" << direction << "/" << line_search << "/" << backend;
+        return oss.str();
+    }
+    std::string suite;
+    std::string problem;
+    std::size_t N;
+    std::string direction;
+    std::string line_search;
+    std::string backend;
+};
+
+/** @brief Measurements of a run, sent back by the child process */
+struct measurement{
+    int termination_cause;
+    double f;
+    unsigned long long iterations;
+    unsigned long long n_value_computations;
+    unsigned long long n_gradient_computations;
+    unsigned long long n_hessian_vector_product_computations;
+    double wall_time;
+    char error[256];
+};
+
+/** @brief Outcome of a run, as seen by the parent process */
+struct outcome{
+    outcome() : peak_rss_kb(0){ std::memset(&m, 0, sizeof(m)); }
+    std::string status;
+    measurement m;
+    long peak_rss_kb;
+};
+
+//Only the backends storing vectors as plain arrays can evaluate the functions of tests/mghfuns, which fill a jacobian through a pointer
+template<class T> struct has_array_storage{ static const bool value = false; };
+template<class T> struct has_array_storage<T*>{ static const bool value = true; };
+template<bool> struct bool_type{ };
+
+template<class BackendType>
+struct problem{
+    virtual ~problem(){ }
+    virtual void run(minimizer<BackendType> & minimizer, measurement & m) = 0;
+};
+
+template<class BackendType, class Fun>
+struct problem_impl : public problem<BackendType>{
+    typedef typename BackendType::VectorType VectorType;
+    problem_impl(Fun const & fun) : fun_(fun){ }
+    void run(minimizer<BackendType> & minimizer, measurement & m){
+        std::size_t N = fun_.N();
+        VectorType X0 = BackendType::create_vector(N);
+        VectorType S = BackendType::create_vector(N);
+        fun_.init(X0);
+        tools::timer timer;
+        optimization_result res = minimizer(S,fun_,X0,N);
+        m.wall_time = timer.get();
+        m.termination_cause = res.termination_cause;
+        m.f = res.f;
+        m.iterations = res.iteration;
+        m.n_value_computations = res.n_functions_eval;
+        m.n_gradient_computations = res.n_gradient_eval;
+        m.n_hessian_vector_product_computations = res.n_hessian_vector_product_computations;
+        BackendType::delete_if_dynamically_allocated(X0);
+        BackendType::delete_if_dynamically_allocated(S);
+    }
+private:
+    Fun fun_;
+};
+
+template<class BackendType, class Fun>
+problem<BackendType> * make_problem(Fun const & fun){
+    return new problem_impl<BackendType, Fun>(fun);
+}
+
+/** @brief Problems of tests/mghfuns, with the dimensions used by the tests */
+struct mgh_problem{
+    const char * name;
+    std::size_t N;
+};
+
+static const mgh_problem mgh_problems[] = {
+    {"beale", 2}, {"biggs_exp6", 6}, {"box_3d", 3}, {"brown_badly_scaled", 2}, {"brown_dennis", 4}, {"freudenstein_roth", 2},
+    {"gaussian", 3}, {"gulf", 3}, {"helical_valley", 3}, {"jenrich_sampson", 2}, {"meyer", 3}, {"penalty1", 10}, {"penalty2", 10},
+    {"powell_badly_scaled", 2}, {"powell_singular", 4}, {"rosenbrock", 2}, {"trigonometric", 10}, {"variably_dimensioned", 20},
+    {"watson", 6}, {"wood", 4}
+};
+
+static const char * scalable_problems[] = {"rosenbrock", "powell_singular", "trigonometric", "penalty1"};
+
+static const char * directions[] = {"bfgs", "factored-bfgs", "lbfgs", "vlbfgs", "cg", "truncated-newton", "steepest-descent", "levenberg-marquardt"};
+
+static const char * line_searches[] = {"strong-wolfe-powell"};
+
+static const char * backends[] = {"cblas", "f77blas"
+#ifdef UMINTL_BENCH_EIGEN
+                                  , "eigen"
+#endif
+                                 };
+
+#define UMINTL_BENCH_SIZE(array) (sizeof(array)/sizeof(array[0]))
+
+template<class BackendType>
+problem<BackendType> * create_mgh_problem(std::string const &, bool_type<false>){
+    return NULL;
+}
+
+template<class BackendType>
+problem<BackendType> * create_mgh_problem(std::string const & name, bool_type<true>){
+    typedef BackendType B;
+    if(name=="beale") return make_problem<B>(beale<B>());
+    if(name=="biggs_exp6") return make_problem<B>(biggs_exp6<B>());
+    if(name=="box_3d") return make_problem<B>(box_3d<B>());
+    if(name=="brown_badly_scaled") return make_problem<B>(brown_badly_scaled<B>());
+    if(name=="brown_dennis") return make_problem<B>(brown_dennis<B>());
+    if(name=="freudenstein_roth") return make_problem<B>(freudenstein_roth<B>());
+    if(name=="gaussian") return make_problem<B>(gaussian<B>());
+    if(name=="gulf") return make_problem<B>(gulf<B>(20));
+    if(name=="helical_valley") return make_problem<B>(helical_valley<B>());
+    if(name=="jenrich_sampson") return make_problem<B>(jenrich_sampson<B>());
+    if(name=="meyer") return make_problem<B>(meyer<B>());
+    if(name=="penalty1") return make_problem<B>(penalty1<B>(10));
+    if(name=="penalty2") return make_problem<B>(penalty2<B>(10));
+    if(name=="powell_badly_scaled") return make_problem<B>(powell_badly_scaled<B>());
+    if(name=="powell_singular") return make_problem<B>(powell_singular<B>(4));
+    if(name=="rosenbrock") return make_problem<B>(rosenbrock<B>(2));
+    if(name=="trigonometric") return make_problem<B>(trigonometric<B>(10));
+    if(name=="variably_dimensioned") return make_problem<B>(variably_dimensioned<B>(20));
+    if(name=="watson") return make_problem<B>(watson<B>(6));
+    if(name=="wood") return make_problem<B>(wood<B>());
+    return NULL;
+}
+
+template<class BackendType>
+problem<BackendType> * create_scalable_problem(std::string const & name, std::size_t N){
+    typedef BackendType B;
+    if(name=="rosenbrock") return make_problem<B>(scalable_rosenbrock<B>(N));
+    if(name=="powell_singular") return make_problem<B>(scalable_powell_singular<B>(N));
+    if(name=="trigonometric") return make_problem<B>(scalable_trigonometric<B>(N));
+    if(name=="penalty1") return make_problem<B>(scalable_penalty1<B>(N));
+    return NULL;
+}
+
+/** @brief Number of residuals of the least-squares problems of tests/mghfuns, for the Levenberg-Marquardt direction */
+template<class BackendType>
+std::size_t n_residuals(std::string const & name){
+    typedef BackendType B;
+    if(name=="beale") return beale<B>().M();
+    if(name=="biggs_exp6") return biggs_exp6<B>().M();
+    if(name=="box_3d") return box_3d<B>().M();
+    if(name=="brown_badly_scaled") return brown_badly_scaled<B>().M();
+    if(name=="brown_dennis") return brown_dennis<B>().M();
+    if(name=="freudenstein_roth") return freudenstein_roth<B>().M();
+    if(name=="gaussian") return gaussian<B>().M();
+    if(name=="gulf") return gulf<B>(20).M();
+    if(name=="helical_valley") return helical_valley<B>().M();
+    if(name=="jenrich_sampson") return jenrich_sampson<B>().M();
+    if(name=="meyer") return meyer<B>().M();
+    if(name=="penalty1") return penalty1<B>(10).M();
+    if(name=="penalty2") return penalty2<B>(10).M();
+    if(name=="powell_badly_scaled") return powell_badly_scaled<B>().M();
+    if(name=="powell_singular") return powell_singular<B>(4).M();
+    if(name=="rosenbrock") return rosenbrock<B>(2).M();
+    if(name=="trigonometric") return trigonometric<B>(10).M();
+    if(name=="variably_dimensioned") return variably_dimensioned<B>(20).M();
+    if(name=="watson") return watson<B>(6).M();
+    if(name=="wood") return wood<B>().M();
+    return 0;
+}
+
+template<class BackendType>
+direction<BackendType> * create_least_squares_direction(benchmark const &, bool_type<false>){
+    return NULL;
+}
+
+template<class BackendType>
+direction<BackendType> * create_least_squares_direction(benchmark const & b, bool_type<true>){
+    return new levenberg_marquardt<BackendType>(n_residuals<BackendType>(b.problem));
+}
+
+template<class BackendType>
+direction<BackendType> * create_direction(benchmark const & b){
+    if(b.direction=="bfgs") return new quasi_newton<BackendType>();
+    if(b.direction=="factored-bfgs") return new factored_quasi_newton<BackendType>();
+    if(b.direction=="lbfgs") return new low_memory_quasi_newton<BackendType>();
+    if(b.direction=="vlbfgs") return new vector_free_low_memory_quasi_newton<BackendType>();
+    if(b.direction=="cg") return new conjugate_gradient<BackendType>();
+    if(b.direction=="truncated-newton") return new truncated_newton<BackendType>();
+    if(b.direction=="steepest-descent") return new steepest_descent<BackendType>();
+    if(b.direction=="levenberg-marquardt")
+        return create_least_squares_direction<BackendType>(b, bool_type<has_array_storage<typename BackendType::VectorType>::value>());
+    return NULL;
+}
+
+template<class BackendType>
+line_search<BackendType> * create_line_search(benchmark const & b){
+    if(b.line_search=="strong-wolfe-powell") return new strong_wolfe_powell<BackendType>();
+    return NULL;
+}
+
+/** @brief Performs a run with the given backend. Throws exceptions::incompatible_parameters for an unknown configuration */
+template<class BackendType>
+void run(benchmark const & b, options const & o, measurement & m){
+    tools::shared_ptr<problem<BackendType> > p(b.suite=="mgh"?create_mgh_problem<BackendType>(b.problem, bool_type<has_array_storage<typename BackendType::VectorType>::value>())
+                                                             :create_scalable_problem<BackendType>(b.problem, b.N));
+    direction<BackendType> * d = create_direction<BackendType>(b);
+    line_search<BackendType> * ls = create_line_search<BackendType>(b);
+    if(!p.get() || !d || !ls){
+        delete d;
+        delete ls;
+        throw exceptions::incompatible_parameters("Unsupported benchmark " + b.id());
+    }
+    minimizer<BackendType> minimizer(d, new gradient_treshold<BackendType>(o.tolerance), o.max_iter);
+    minimizer.line_search = ls;
+    p->run(minimizer, m);
+}
+
+void dispatch(benchmark const & b, options const & o, measurement & m){
+    if(b.backend=="cblas")
+        run<backend::cblas_types<double> >(b, o, m);
+    else if(b.backend=="f77blas")
+        run<backend::blas_types<double> >(b, o, m);
+#ifdef UMINTL_BENCH_EIGEN
+    else if(b.backend=="eigen")
+        run<backend::eigen_types<double> >(b, o, m);
+#endif
+    else
+        throw exceptions::incompatible_parameters("Unknown backend " + b.backend);
+}
+
+/** @brief Lists the runs of the suite, restricted by the options */
+std::vector<benchmark> enumerate(options const & o){
+    std::vector<benchmark> res;
+    for(std::size_t k = 0 ; k < UMINTL_BENCH_SIZE(backends) ; ++k){
+        bool has_mgh = std::string(backends[k])!="eigen";
+        for(std::size_t l = 0 ; l < UMINTL_BENCH_SIZE(line_searches) ; ++l){
+            for(std::size_t d = 0 ; d < UMINTL_BENCH_SIZE(directions) ; ++d){
+                std::string direction = directions[d];
+                if(has_mgh)
+                    for(std::size_t p = 0 ; p < UMINTL_BENCH_SIZE(mgh_problems) ; ++p)
+                        res.push_back(benchmark("mgh", mgh_problems[p].name, mgh_problems[p].N, direction, line_searches[l], backends[k]));
+                //The large-scale problems do not provide the residuals
+                if(direction=="levenberg-marquardt")
+                    continue;
+                for(std::size_t p = 0 ; p < UMINTL_BENCH_SIZE(scalable_problems) ; ++p)
+                    for(std::size_t N = 100 ; N <= o.max_dimension ; N *= 10)
+                        if((direction!="bfgs" && direction!="factored-bfgs") || N <= o.max_dense_dimension)
+                            res.push_back(benchmark("scalable", scalable_problems[p], N, direction, line_searches[l], backends[k]));
+            }
+        }
+    }
+    if(o.filters.empty())
+        return res;
+    std::vector<benchmark> filtered;
+    for(std::size_t i = 0 ; i < res.size() ; ++i)
+        for(std::size_t f = 0 ; f < o.filters.size() ; ++f)
+            if(res[i].id().find(o.filters[f]) != std::string::npos){
+                filtered.push_back(res[i]);
+                break;
+            }
+    return filtered;
+}
+
+/** @brief Performs a run in a child process, killed after the time limit */
+outcome execute(benchmark const & b, options const & o){
+    outcome res;
+    int fds[2];
+    if(pipe(fds) != 0){
+        res.status = "error";
+        std::strcpy(res.m.error, "Cannot create a pipe");
+        return res;
+    }
+    std::cout.flush();
+    std::cerr.flush();
+    pid_t pid = fork();
+    if(pid == 0){
+        close(fds[0]);
+        if(o.time_limit)
+            alarm(o.time_limit);
+        measurement m;
+        std::memset(&m, 0, sizeof(m));
+        try{
+            dispatch(b, o, m);
+        }
+        catch(std::exception const & e){
+            std::strncpy(m.error, e.what(), sizeof(m.error)-1);
+        }
+        catch(const char * e){
+            std::strncpy(m.error, e, sizeof(m.error)-1);
+        }
+        catch(...){
+            std::strcpy(m.error, "Unknown exception");
+        }
+        ssize_t written = write(fds[1], &m, sizeof(m));
+        _exit(written == (ssize_t)sizeof(m) ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+    close(fds[1]);
+    if(pid < 0){
+        close(fds[0]);
+        res.status = "error";
+        std::strcpy(res.m.error, "Cannot fork");
+        return res;
+    }
+    std::size_t received = 0;
+    char * ptr = reinterpret_cast<char *>(&res.m);
+    ssize_t n;
+    while(received < sizeof(res.m) && (n = read(fds[0], ptr + received, sizeof(res.m) - received)) > 0)
+        received += n;
+    close(fds[0]);
+    int status;
+    struct rusage usage;
+    wait4(pid, &status, 0, &usage);
+    res.peak_rss_kb = usage.ru_maxrss;
+    if(WIFSIGNALED(status))
+        res.status = WTERMSIG(status)==SIGALRM?"timeout":"crashed";
+    else if(received != sizeof(res.m))
+        res.status = "crashed";
+    else if(res.m.error[0])
+        res.status = "error";
+    else
+        res.status = "ok";
+    return res;
+}
+
+std::string json_string(std::string const & str){
+    std::ostringstream oss;
+    oss << '"';
+    for(std::size_t i = 0 ; i < str.size() ; ++i){
+        char c = str[i];
+        if(c=='"' || c=='\\')
+            oss << '\\' << c;
+        else if((unsigned char)c < 0x20)
+            oss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c << std::dec << std::setfill(' ');
+        else
+            oss << c;
+    }
+    oss << '"';
+    return oss.str();
+}
+
+std::string json_number(double x){
+    if(x!=x || std::fabs(x)==INFINITY)
+        return "null";
+    std::ostringstream oss;
+    oss << std::setprecision(17) << x;
+    return oss.str();
+}
+
+const char * termination_name(int cause){
+    switch(cause){
+        case optimization_result::LINE_SEARCH_FAILED: return "line-search-failed";
+        case optimization_result::STOPPING_CRITERION: return "stopping-criterion";
+        case optimization_result::MAX_ITERATION_REACHED: return "max-iteration-reached";
+        case optimization_result::OBSERVER_REQUEST: return "observer-request";
+        default: return "unknown";
+    }
+}
+
+/** @brief Writes a run on a single line, so that the output is easy to diff and to process line by line */
+void write_run(std::ostream & os, benchmark const & b, outcome const & r){
+    os << "{\"id\": " << json_string(b.id())
+       << ", \"suite\": " << json_string(b.suite) << ", \"problem\": " << json_string(b.problem) << ", \"N\": " << b.N
+       << ", \"direction\": " << json_string(b.direction) << ", \"line_search\": " << json_string(b.line_search)
+       << ", \"backend\": " << json_string(b.backend) << ", \"status\": " << json_string(r.status);
+    if(r.status=="ok")
+        os << ", \"termination\": " << json_string(termination_name(r.m.termination_cause)) << ", \"f\": " << json_number(r.m.f)
+           << ", \"iterations\": " << r.m.iterations << ", \"n_value_computations\": " << r.m.n_value_computations
+           << ", \"n_gradient_computations\": " << r.m.n_gradient_computations
+           << ", \"n_hessian_vector_product_computations\": " << r.m.n_hessian_vector_product_computations
+           << ", \"wall_time\": " << json_number(r.m.wall_time);
+    else if(r.status=="error")
+        os << ", \"error\": " << json_string(r.m.error);
+    os << ", \"peak_rss_kb\": " << r.peak_rss_kb << "}";
+}
+
+/** @brief Runs of a previous output of the suite, with the settings they were measured with */
+struct baseline{
+    baseline() : reference_time(0){ }
+    std::string build_type;
+    double reference_time;
+    unsigned int max_iter;
+    double tolerance;
+    std::vector<benchmark> runs;
+    std::vector<json_value> results;
+};
+
+/** @brief Reads a baseline. Throws exceptions::io_error if the file cannot be read or is not an output of umintl-bench */
+baseline load_baseline(std::string const & filename){
+    std::ifstream file(filename.c_str());
+    if(!file)
+        throw exceptions::io_error("Cannot open " + filename);
+    std::ostringstream oss;
+    oss << file.rdbuf();
+    std::string text = oss.str();
+    json_value root = json_parser(text).parse();
+    json_value const * build_type = root.find("build_type");
+    json_value const * max_iter = root.find("max_iter");
+    json_value const * tolerance = root.find("tolerance");
+    json_value const * runs = root.find("runs");
+    if(!build_type || !max_iter || !tolerance || !runs || runs->type != json_value::ARRAY)
+        throw exceptions::io_error(filename + " is not an output of umintl-bench");
+    baseline res;
+    res.build_type = build_type->str;
+    res.max_iter = (unsigned int)max_iter->number;
+    res.tolerance = tolerance->number;
+    json_value const * reference_time = root.find("reference_time");
+    if(reference_time)
+        res.reference_time = reference_time->number;
+    for(std::size_t i = 0 ; i < runs->elements.size() ; ++i){
+        json_value const & run = runs->elements[i];
+        json_value const * fields[] = {run.find("suite"), run.find("problem"), run.find("N"), run.find("direction"), run.find("line_search"), run.find("backend"), run.find("status")};
+        for(std::size_t f = 0 ; f < UMINTL_BENCH_SIZE(fields) ; ++f)
+            if(!fields[f])
+                throw exceptions::io_error(filename + " : incomplete run");
+        res.runs.push_back(benchmark(fields[0]->str, fields[1]->str, (std::size_t)fields[2]->number, fields[3]->str, fields[4]->str, fields[5]->str));
+        res.results.push_back(run);
+    }
+    return res;
+}
+
+bool has_backend(std::string const & name){
+    for(std::size_t k = 0 ; k < UMINTL_BENCH_SIZE(backends) ; ++k)
+        if(name==backends[k])
+            return true;
+    return false;
+}
+
+/** @brief Wall-clock time of a fixed run : the best of a few repetitions, which is less sensitive to the load of the host than a single one.
+ *  Zero if the run fails */
+double reference_time(options const & o){
+    benchmark reference("scalable", "rosenbrock", 1000, "bfgs", "strong-wolfe-powell", "cblas");
+    double res = 0;
+    for(int i = 0 ; i < 5 ; ++i){
+        outcome r = execute(reference, o);
+        if(r.status != "ok")
+            return 0;
+        if(i==0 || r.m.wall_time < res)
+            res = r.m.wall_time;
+    }
+    return res;
+}
+
+/** @brief Differences between a run and its baseline, one per line. Empty if they match
+ *
+ *  The wall-clock times are compared after scaling the baseline by time_scale, the ratio of the times of the reference run now and in the baseline.
+ *  A null time_scale disables the comparison.
+ */
+std::vector<std::string> compare(json_value const & expected, outcome const & r, options const & o, double time_scale){
+    std::vector<std::string> res;
+    std::string status = expected.find("status")->str;
+    if(status != r.status){
+        res.push_back("status : " + status + " -> " + r.status + (r.status=="error"?" (" + std::string(r.m.error) + ")":""));
+        return res;
+    }
+    if(status != "ok")
+        return res;
+    json_value const * termination = expected.find("termination");
+    if(termination && termination->str != termination_name(r.m.termination_cause))
+        res.push_back("termination : " + termination->str + " -> " + termination_name(r.m.termination_cause));
+    const char * counters[] = {"iterations", "n_value_computations", "n_gradient_computations", "n_hessian_vector_product_computations"};
+    unsigned long long values[] = {r.m.iterations, r.m.n_value_computations, r.m.n_gradient_computations, r.m.n_hessian_vector_product_computations};
+    for(std::size_t i = 0 ; i < UMINTL_BENCH_SIZE(counters) ; ++i){
+        json_value const * counter = expected.find(counters[i]);
+        if(counter && (unsigned long long)counter->number != values[i]){
+            std::ostringstream oss;
+            oss << counters[i] << " : " << (unsigned long long)counter->number << " -> " << values[i]
+                << " (" << std::showpos << (long long)values[i] - (long long)counter->number << std::noshowpos << ")";
+            res.push_back(oss.str());
+        }
+    }
+    json_value const * wall_time = expected.find("wall_time");
+    //Short runs are dominated by noise
+    if(time_scale > 0 && wall_time && wall_time->number >= o.min_time && r.m.wall_time > time_scale*wall_time->number*(1 + o.time_tolerance)){
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(3) << "wall_time : " << wall_time->number << "s -> " << r.m.wall_time << "s ("
+            << std::setprecision(0) << std::showpos << 100*(r.m.wall_time/(time_scale*wall_time->number) - 1) << "%" << std::noshowpos
+            << " relative to the reference run, tolerance " << 100*o.time_tolerance << "%)";
+        res.push_back(oss.str());
+    }
+    return res;
+}
+
+void usage(const char * program){
+    std::cerr << "Usage : " << program << " [OPTIONS]" << std::endl
+              << "Runs every direction, line-search and backend on the test problems, and writes the measurements to JSON." << std::endl
+              << "  --output FILE               output file. Defaults to the standard output" << std::endl
+              << "  --filter STRING             only runs whose id contains STRING. May be repeated" << std::endl
+              << "  --list                      prints the ids of the runs, and exits" << std::endl
+              << "  --max-dimension N           largest dimension of the large-scale problems (default : 10000000)" << std::endl
+              << "  --max-dense-dimension N     largest dimension for the dense BFGS directions (default : 10000)" << std::endl
+              << "  --max-iter N                maximum number of iterations (default : 10000)" << std::endl
+              << "  --tolerance X               tolerance on the norm of the gradient (default : 1e-5)" << std::endl
+              << "  --time-limit SECONDS        the runs are killed after this time. 0 for no limit (default : 600)" << std::endl
+              << "  --baseline FILE             performs the runs of FILE, a previous output, with its settings, and reports the differences." << std::endl
+              << "                              Fails if the status, termination cause or numbers of iterations and evaluations differ," << std::endl
+              << "                              or if a run is slower than allowed. --output then writes the new measurements" << std::endl
+              << "  --time-tolerance X          allowed relative increase of the wall-clock time with --baseline (default : 0.25)." << std::endl
+              << "                              The times are only compared if the baseline was measured with the same build type," << std::endl
+              << "                              relative to the time of a reference run, measured with the baseline and again now" << std::endl
+              << "  --min-time SECONDS          runs shorter than this in the baseline are not timed (default : 0.1)" << std::endl
+              << "  --same-build-type           with --baseline, fails without performing the runs if the baseline was measured with" << std::endl
+              << "                              another build type, whose numbers of evaluations may differ by rounding" << std::endl
+              << "The ids are of the form suite/problem/N/direction/line-search/backend" << std::endl;
+}
+
+bool parse(int argc, char* argv[], options & o){
+    for(int i = 1 ; i < argc ; ++i){
+        std::string arg = argv[i];
+        if(arg=="--list"){
+            o.list = true;
+            continue;
+        }
+        if(arg=="--same-build-type"){
+            o.same_build_type = true;
+            continue;
+        }
+        if(i+1 >= argc)
+            return false;
+        std::string value = argv[++i];
+        std::istringstream iss(value);
+        if(arg=="--output") o.output = value;
+        else if(arg=="--filter") o.filters.push_back(value);
+        else if(arg=="--max-dimension") iss >> o.max_dimension;
+        else if(arg=="--max-dense-dimension") iss >> o.max_dense_dimension;
+        else if(arg=="--max-iter") iss >> o.max_iter;
+        else if(arg=="--tolerance") iss >> o.tolerance;
+        else if(arg=="--time-limit") iss >> o.time_limit;
+        else if(arg=="--baseline") o.baseline = value;
+        else if(arg=="--time-tolerance") iss >> o.time_tolerance;
+        else if(arg=="--min-time") iss >> o.min_time;
+        else return false;
+        if(iss.fail())
+            return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]){
+    options o;
+    if(!parse(argc, argv, o)){
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    std::vector<benchmark> runs;
+    baseline base;
+    if(o.baseline.empty())
+        runs = enumerate(o);
+    else{
+        try{
+            base = load_baseline(o.baseline);
+        }
+        catch(exceptions::io_error const & e){
+            std::cerr << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+        if(o.same_build_type && base.build_type!=UMINTL_BUILD_TYPE){
+            std::string build_type = UMINTL_BUILD_TYPE;
+            for(std::size_t i = 0 ; i < build_type.size() ; ++i)
+                build_type[i] = (char)std::tolower(build_type[i]);
+            std::string directory = o.baseline.substr(0, o.baseline.find_last_of('/')+1);
+            std::cout << o.baseline << " was measured with a \"" << base.build_type << "\" build, this is a \"" << UMINTL_BUILD_TYPE << "\" build." << std::endl
+                      << "Generate the baseline of this build type, check its runs, and configure again :" << std::endl
+                      << "  " << argv[0] << " --baseline " << o.baseline << " --output " << directory << "regression-" << build_type << ".json" << std::endl;
+            return EXIT_FAILURE;
+        }
+        o.max_iter = base.max_iter;
+        o.tolerance = base.tolerance;
+        runs = base.runs;
+    }
+    if(o.list){
+        for(std::size_t i = 0 ; i < runs.size() ; ++i)
+            std::cout << runs[i].id() << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    std::ofstream file;
+    if(!o.output.empty()){
+        file.open(o.output.c_str());
+        if(!file){
+            std::cerr << "Cannot open " << o.output << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    //In baseline mode, the standard output is left to the report
+    std::ofstream null;
+    std::ostream & os = !o.output.empty()?file:o.baseline.empty()?std::cout:null;
+    //The reference run is only needed in the output, and to compare the times with the baseline
+    std::string no_time_comparison;
+    if(o.time_tolerance <= 0)
+        no_time_comparison = "disabled by --time-tolerance 0";
+    else if(base.build_type!=UMINTL_BUILD_TYPE)
+        no_time_comparison = "the baseline was measured with a \"" + base.build_type + "\" build, this is a \"" + UMINTL_BUILD_TYPE + "\" build";
+    else if(base.reference_time <= 0)
+        no_time_comparison = "the baseline has no reference time";
+    double reference = (&os != &null || no_time_comparison.empty())?reference_time(o):0;
+    if(no_time_comparison.empty() && reference <= 0)
+        no_time_comparison = "the reference run failed";
+    double time_scale = no_time_comparison.empty()?reference/base.reference_time:0;
+    os << "{\n\"version\": " << json_string(UMINTL_VERSION) << ",\n\"build_type\": " << json_string(UMINTL_BUILD_TYPE)
+       << ",\n\"max_iter\": " << o.max_iter << ",\n\"tolerance\": " << json_number(o.tolerance)
+       << ",\n\"reference_time\": " << json_number(reference) << ",\n\"runs\": [\n";
+    std::size_t n_written = 0, n_skipped = 0, n_different = 0;
+    std::ostringstream report;
+    for(std::size_t i = 0 ; i < runs.size() ; ++i){
+        if(!o.baseline.empty() && !has_backend(runs[i].backend)){
+            report << runs[i].id() << "\n    skipped : backend not built\n";
+            n_skipped++;
+            continue;
+        }
+        std::cerr << "[" << i+1 << "/" << runs.size() << "] " << runs[i].id() << "..." << std::flush;
+        outcome r = execute(runs[i], o);
+        std::cerr << " " << r.status;
+        if(r.status=="ok")
+            std::cerr << " (" << r.m.iterations << " iterations, " << r.m.wall_time << "s, " << r.peak_rss_kb << "KB)";
+        else if(r.status=="error")
+            std::cerr << " (" << r.m.error << ")";
+        std::cerr << std::endl;
+        os << (n_written++?",\n":"");
+        write_run(os, runs[i], r);
+        os << std::flush;
+        if(!o.baseline.empty()){
+            std::vector<std::string> differences = compare(base.results[i], r, o, time_scale);
+            if(!differences.empty()){
+                report << runs[i].id() << "\n";
+                for(std::size_t d = 0 ; d < differences.size() ; ++d)
+                    report << "    " << differences[d] << "\n";
+                n_different++;
+            }
+        }
+    }
+    os << "\n]\n}\n";
+    if(o.baseline.empty())
+        return EXIT_SUCCESS;
+
+    std::cout << "Comparison with " << o.baseline << " (baseline -> now)" << std::endl;
+    if(no_time_comparison.empty())
+        std::cout << "Reference run : " << base.reference_time << "s -> " << reference << "s, the wall-clock times of the baseline are scaled by " << time_scale << std::endl;
+    else
+        std::cout << "Wall-clock times not compared : " << no_time_comparison << std::endl;
+    std::cout << report.str();
+    std::cout << runs.size() - n_skipped << " runs compared, " << n_different << " different, " << n_skipped << " skipped" << std::endl;
+    return n_different?EXIT_FAILURE:EXIT_SUCCESS;
+}
@@ -0,0 +1,175 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include "stochastic-common.hpp"
+#include "mghfuns/rosenbrock.hpp"
+
+static const char * filename = "checkpoint-test.ckpt";
+
+/** @brief Builds the same minimizer for the reference, the interrupted and the resumed runs */
+struct minimizer_factory{
+    virtual ~minimizer_factory(){ }
+    virtual minimizer<BackendType> * create(unsigned int max_iter) const = 0;
+};
+
+template<class DirectionType>
+struct deterministic_factory : public minimizer_factory{
+    deterministic_factory(DirectionType const & direction) : direction_(direction){ }
+    minimizer<BackendType> * create(unsigned int max_iter) const{
+        return new minimizer<BackendType>(new DirectionType(direction_), new gradient_treshold<BackendType>(1e-12), max_iter);
+    }
+private:
+    DirectionType direction_;
+};
+
+struct dynamically_sampled_factory : public minimizer_factory{
+    dynamically_sampled_factory(std::size_t dataset_size) : dataset_size_(dataset_size){ }
+    minimizer<BackendType> * create(unsigned int max_iter) const{
+        minimizer<BackendType> * res = new minimizer<BackendType>(new low_memory_quasi_newton<BackendType>(), new gradient_treshold<BackendType>(1e-12), max_iter);
+        res->model = new dynamically_sampled<BackendType>(0.1, 20, dataset_size_);
+        return res;
+    }
+private:
+    std::size_t dataset_size_;
+};
+
+template<class DirectionType>
+struct mini_batch_factory : public minimizer_factory{
+    mini_batch_factory(DirectionType const & direction, std::size_t sample_size, std::size_t dataset_size) : direction_(direction), sample_size_(sample_size), dataset_size_(dataset_size){ }
+    minimizer<BackendType> * create(unsigned int max_iter) const{
+        minimizer<BackendType> * res = new minimizer<BackendType>(new DirectionType(direction_), new gradient_treshold<BackendType>(1e-12), max_iter);
+        res->model = new mini_batch<BackendType>(sample_size_, dataset_size_, true);
+        return res;
+    }
+private:
+    DirectionType direction_;
+    std::size_t sample_size_;
+    std::size_t dataset_size_;
+};
+
+/** 100(x1 - x0^2)^2 + (1 - x0)^2 */
+struct rosenbrock_element : public element_function<BackendType>{
+    void operator()(ScalarType const * x, ScalarType & value, ScalarType * gradient) const{
+        ScalarType a = x[1] - x[0]*x[0];
+        value = 100*a*a + (1-x[0])*(1-x[0]);
+        gradient[0] = -400*x[0]*a - 2*(1-x[0]);
+        gradient[1] = 200*a;
+    }
+};
+
+bool same_result(optimization_result const & a, optimization_result const & b){
+    return a.f==b.f && a.iteration==b.iteration && a.n_functions_eval==b.n_functions_eval
+        && a.n_gradient_eval==b.n_gradient_eval && a.n_datapoints_accessed==b.n_datapoints_accessed;
+}
+
+/** @brief Interrupts a run after interrupt iterations, resumes it from the last checkpoint, and compares with an uninterrupted run */
+template<class Fun>
+int test_resume(std::string const & name, Fun & fun, std::size_t N, VectorType const & X0, minimizer_factory const & factory, unsigned int max_iter, unsigned int interrupt){
+    std::cout << "- Testing " << name << "..." << std::flush;
+    VectorType S[2];
+    S[0] = BackendType::create_vector(N);
+    S[1] = BackendType::create_vector(N);
+    std::remove(filename);
+
+    minimizer<BackendType> * reference = factory.create(max_iter);
+    optimization_result expected = (*reference)(S[0],fun,X0,N);
+    delete reference;
+
+    minimizer<BackendType> * interrupted = factory.create(interrupt);
+    interrupted->checkpoint_file = filename;
+    interrupted->checkpoint_frequency = 4;
+    (*interrupted)(S[1],fun,X0,N);
+    delete interrupted;
+
+    minimizer<BackendType> * resumed = factory.create(max_iter);
+    optimization_result result = resumed->resume(S[1],fun,filename,N);
+    delete resumed;
+
+    bool identical = same_result(result,expected) && std::memcmp(&S[0][0],&S[1][0],N*sizeof(ScalarType))==0;
+    BackendType::delete_if_dynamically_allocated(S[0]);
+    BackendType::delete_if_dynamically_allocated(S[1]);
+    std::remove(filename);
+    if(!identical){
+        std::cout << " Fail! /* The resumed run differs : f = " << result.f << " after " << result.iteration << " iterations"
+                  << ", against " << expected.f << " after " << expected.iteration << " iterations */" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << " " << expected.iteration << " iterations" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+/** @brief A checkpoint cannot be resumed with another direction */
+template<class Fun>
+int test_mismatch(Fun & fun, std::size_t N, VectorType const & X0){
+    std::cout << "- Testing incompatible checkpoint..." << std::flush;
+    VectorType S = BackendType::create_vector(N);
+    std::remove(filename);
+    minimizer<BackendType> interrupted(new quasi_newton<BackendType>(), new gradient_treshold<BackendType>(1e-12), 10);
+    interrupted.checkpoint_file = filename;
+    interrupted.checkpoint_frequency = 4;
+    interrupted(S,fun,X0,N);
+
+    bool thrown = false;
+    minimizer<BackendType> resumed(new low_memory_quasi_newton<BackendType>(), new gradient_treshold<BackendType>(1e-12), 100);
+    try{
+        resumed.resume(S,fun,filename,N);
+    }
+    catch(exceptions::io_error const &){
+        thrown = true;
+    }
+    BackendType::delete_if_dynamically_allocated(S);
+    std::remove(filename);
+    if(!thrown){
+        std::cout << " Fail! /* The checkpoint was accepted */" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << std::endl;
+    return EXIT_SUCCESS;
+}
+
+int main(){
+    srand(0);
+    int result = EXIT_SUCCESS;
+    std::cout << "Testing checkpoints..." << std::endl;
+
+    std::size_t N = 20;
+    rosenbrock<BackendType> rosen(N);
+    VectorType X0 = BackendType::create_vector(N);
+    rosen.init(X0);
+    result |= test_resume("BFGS", rosen, N, X0, deterministic_factory<quasi_newton<BackendType> >(quasi_newton<BackendType>()), 200, 18);
+    result |= test_resume("L-BFGS", rosen, N, X0, deterministic_factory<low_memory_quasi_newton<BackendType> >(low_memory_quasi_newton<BackendType>(8)), 200, 18);
+    result |= test_resume("Vector-free L-BFGS", rosen, N, X0, deterministic_factory<vector_free_low_memory_quasi_newton<BackendType> >(vector_free_low_memory_quasi_newton<BackendType>(8)), 200, 18);
+    result |= test_resume("Out-of-core BFGS", rosen, N, X0, deterministic_factory<out_of_core_quasi_newton<BackendType> >(out_of_core_quasi_newton<BackendType>("checkpoint-test.tmp", 3, 2)), 200, 18);
+    result |= test_resume("Nonlinear CG", rosen, N, X0, deterministic_factory<conjugate_gradient<BackendType> >(conjugate_gradient<BackendType>()), 500, 18);
+    result |= test_mismatch(rosen, N, X0);
+
+    partially_separable_function<BackendType> chained(N);
+    for(std::size_t i = 0 ; i + 1 < N ; ++i){
+        std::vector<std::size_t> idx(2);
+        idx[0] = i; idx[1] = i+1;
+        chained.add(new rosenbrock_element(), idx);
+    }
+    result |= test_resume("Partitioned BFGS", chained, N, X0, deterministic_factory<partitioned_quasi_newton<BackendType> >(partitioned_quasi_newton<BackendType>(chained)), 200, 18);
+    BackendType::delete_if_dynamically_allocated(X0);
+
+    linear_regression fun(10, 1000);
+    std::size_t D = fun.N();
+    VectorType Z0 = BackendType::create_vector(D);
+    BackendType::set_to_value(Z0,0,D);
+    result |= test_resume("L-BFGS with a dynamic sample size", fun, D, Z0, dynamically_sampled_factory(fun.dataset_size()), 50, 10);
+    result |= test_resume("Adam on mini-batches", fun, D, Z0, mini_batch_factory<adam<BackendType> >(adam<BackendType>(step_size(0.01)), 50, fun.dataset_size()), 200, 30);
+    result |= test_resume("SAGA on mini-batches", fun, D, Z0, mini_batch_factory<saga<BackendType> >(saga<BackendType>(step_size(0.1), fun.dataset_size()), 10, fun.dataset_size()), 200, 30);
+    result |= test_resume("Stochastic quasi-newton", fun, D, Z0, mini_batch_factory<stochastic_quasi_newton<BackendType> >(stochastic_quasi_newton<BackendType>(step_size(0.3), step_size(1e-2), 10, 10), 50, fun.dataset_size()), 200, 30);
+    BackendType::delete_if_dynamically_allocated(Z0);
+
+    return result;
+}
@@ -0,0 +1,166 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "stochastic-common.hpp"
+
+/** @brief Same objective, without the fused overload : the variance is computed in a separate pass */
+struct two_pass{
+    two_pass(linear_regression const & fun) : fun_(fun){ }
+    void operator()(VectorType const & x, ScalarType & value, VectorType & gradient, umintl::value_gradient tag) const{ fun_(x,value,gradient,tag); }
+    void operator()(VectorType const & x, VectorType & variance, umintl::gradient_variance tag) const{ fun_(x,variance,tag); }
+private:
+    linear_regression const & fun_;
+};
+
+ScalarType max_relative_difference(std::size_t N, VectorType const & x, VectorType const & y){
+    ScalarType res = 0;
+    ScalarType nrm = BackendType::nrm2(N,y);
+    for(std::size_t n = 0 ; n < N ; ++n)
+        res = std::max(res, std::abs(x[n] - y[n])/nrm);
+    return res;
+}
+
+int test_wrapper(linear_regression & fun, std::size_t n_shards){
+    std::size_t N = fun.N();
+    std::cout << "- Testing fused evaluation on " << n_shards << " shard(s)..." << std::flush;
+    VectorType x = BackendType::create_vector(N);
+    for(std::size_t n = 0 ; n < N ; ++n)
+        x[n] = (ScalarType)rand()/RAND_MAX;
+    VectorType g[2], var[2];
+    ScalarType val[2];
+    for(unsigned int k = 0 ; k < 2 ; ++k){
+        g[k] = BackendType::create_vector(N);
+        var[k] = BackendType::create_vector(N);
+    }
+    two_pass ref(fun);
+    detail::function_wrapper_impl<BackendType, two_pass> reference(ref,N,CENTERED_DIFFERENCE);
+    detail::function_wrapper_impl<BackendType, linear_regression> fused(fun,N,CENTERED_DIFFERENCE,n_shards);
+    reference.compute_value_gradient_variance(x,val[0],g[0],var[0],value_gradient_variance(STOCHASTIC,500,100));
+    fused.compute_value_gradient_variance(x,val[1],g[1],var[1],value_gradient_variance(STOCHASTIC,500,100));
+    ScalarType diff = std::max(std::abs(val[1]-val[0])/std::abs(val[0]), std::max(max_relative_difference(N,g[1],g[0]), max_relative_difference(N,var[1],var[0])));
+
+    //The variance tracked along with the gradient is reused at the same point, without accessing the data again
+    fused.track_gradient_variance(true);
+    fused.compute_value_gradient(x,val[1],g[1],value_gradient(STOCHASTIC,500,100));
+    unsigned int accessed = fused.n_datapoints_accessed();
+    fused.compute_gradient_variance(x,var[1],gradient_variance(STOCHASTIC,500,100));
+    diff = std::max(diff, max_relative_difference(N,var[1],var[0]));
+    bool reused = fused.n_datapoints_accessed()==accessed;
+
+    for(unsigned int k = 0 ; k < 2 ; ++k){
+        BackendType::delete_if_dynamically_allocated(g[k]);
+        BackendType::delete_if_dynamically_allocated(var[k]);
+    }
+    BackendType::delete_if_dynamically_allocated(x);
+    if(diff > 1e-10){
+        std::cout << " Fail! /* Difference = " << diff << " */" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if(!reused){
+        std::cout << " Fail! /* The variance was not reused */" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << std::endl;
+    return EXIT_SUCCESS;
+}
+
+int test_incremental(linear_regression & fun, bool track_variance){
+    std::size_t N = fun.N();
+    std::cout << "- Testing incremental evaluation" << (track_variance?" with variance":"") << "..." << std::flush;
+    VectorType x = BackendType::create_vector(N);
+    for(std::size_t n = 0 ; n < N ; ++n)
+        x[n] = (ScalarType)rand()/RAND_MAX;
+    VectorType g[2], var[2];
+    ScalarType val[2];
+    for(unsigned int k = 0 ; k < 2 ; ++k){
+        g[k] = BackendType::create_vector(N);
+        var[k] = BackendType::create_vector(N);
+    }
+    detail::function_wrapper_impl<BackendType, linear_regression> reference(fun,N,CENTERED_DIFFERENCE);
+    detail::function_wrapper_impl<BackendType, linear_regression> incremental(fun,N,CENTERED_DIFFERENCE);
+    reference.compute_value_gradient_variance(x,val[0],g[0],var[0],value_gradient_variance(STOCHASTIC,500,100));
+    incremental.track_gradient_variance(track_variance);
+    //The second window contains the first one : only its 300 new samples, on both sides of it, are evaluated
+    incremental.compute_value_gradient(x,val[1],g[1],value_gradient(STOCHASTIC,200,300));
+    incremental.extend_value_gradient(x,val[1],g[1],value_gradient(STOCHASTIC,200,300),value_gradient(STOCHASTIC,500,100));
+    bool incremental_access = incremental.n_datapoints_accessed()==500 && incremental.n_value_computations()==3;
+    ScalarType diff = std::max(std::abs(val[1]-val[0])/std::abs(val[0]), max_relative_difference(N,g[1],g[0]));
+    if(track_variance){
+        //The variance of the first window does not apply to the second one, which is evaluated again
+        incremental.compute_gradient_variance(x,var[1],gradient_variance(STOCHASTIC,500,100));
+        incremental_access = incremental_access && incremental.n_datapoints_accessed()==1000;
+        diff = std::max(diff, max_relative_difference(N,var[1],var[0]));
+    }
+
+    for(unsigned int k = 0 ; k < 2 ; ++k){
+        BackendType::delete_if_dynamically_allocated(g[k]);
+        BackendType::delete_if_dynamically_allocated(var[k]);
+    }
+    BackendType::delete_if_dynamically_allocated(x);
+    if(diff > 1e-10){
+        std::cout << " Fail! /* Difference = " << diff << " */" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if(!incremental_access){
+        std::cout << " Fail! /* " << incremental.n_datapoints_accessed() << " datapoints accessed */" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << std::endl;
+    return EXIT_SUCCESS;
+}
+
+template<class Fun>
+optimization_result minimize(Fun & fun, std::size_t N, std::size_t dataset_size, VectorType S){
+    VectorType X0 = BackendType::create_vector(N);
+    BackendType::set_to_value(X0,0,N);
+    umintl::minimizer<BackendType> minimizer(new quasi_newton<BackendType>(), new gradient_treshold<BackendType>(1e-8), 50);
+    minimizer.model = new dynamically_sampled<BackendType>(0.1, 20, dataset_size);
+    optimization_result result = minimizer(S,fun,X0,N);
+    BackendType::delete_if_dynamically_allocated(X0);
+    return result;
+}
+
+int test_minimizer(linear_regression & fun){
+    std::size_t N = fun.N();
+    std::cout << "- Testing Quasi-Newton with a dynamic sample size..." << std::flush;
+    VectorType S1 = BackendType::create_vector(N);
+    VectorType S2 = BackendType::create_vector(N);
+    two_pass ref(fun);
+    optimization_result reference = minimize(ref,N,fun.dataset_size(),S1);
+    optimization_result fused = minimize(fun,N,fun.dataset_size(),S2);
+    ScalarType diff = max_relative_difference(N,S2,S1);
+    ScalarType error = fun.error(S2);
+    BackendType::delete_if_dynamically_allocated(S1);
+    BackendType::delete_if_dynamically_allocated(S2);
+    if(diff > 1e-8 || error > 1e-3){
+        std::cout << " Fail! /* Difference = " << diff << ", Error = " << error << " */" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if(fused.n_datapoints_accessed >= reference.n_datapoints_accessed){
+        std::cout << " Fail! /* " << fused.n_datapoints_accessed << " datapoints accessed, against " << reference.n_datapoints_accessed << " */" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << " " << fused.n_datapoints_accessed << " datapoints accessed, against " << reference.n_datapoints_accessed << std::endl;
+    return EXIT_SUCCESS;
+}
+
+int main(){
+    srand(0);
+    int result = EXIT_SUCCESS;
+    linear_regression fun(10, 1000);
+    std::cout << "Testing Dynamic Sampling..." << std::endl;
+    result |= test_wrapper(fun, 1);
+    result |= test_wrapper(fun, 4);
+    result |= test_incremental(fun, false);
+    result |= test_incremental(fun, true);
+    result |= test_minimizer(fun);
+    return result;
+}
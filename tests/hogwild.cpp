@@ -0,0 +1,102 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <iostream>
+
+#include "umintl/backends/cblas.hpp"
+#include "umintl/parallel/hogwild.hpp"
+
+using namespace umintl;
+
+typedef double ScalarType;
+typedef umintl::backend::cblas_types<ScalarType> BackendType;
+typedef BackendType::VectorType VectorType;
+
+/** @brief Sparse least-squares f(x) = 1/S sum_{i in batch} (a_i'x - b_i)^2, with nnz nonzeros per sample and b = A*x_star */
+class sparse_regression{
+public:
+    sparse_regression(std::size_t N, std::size_t dataset_size, std::size_t nnz) : N_(N), D_(dataset_size), nnz_(nnz), idx_(dataset_size*nnz), val_(dataset_size*nnz), b_(dataset_size), x_star_(N){
+        for(std::size_t n = 0 ; n < N_ ; ++n)
+            x_star_[n] = (ScalarType)rand()/RAND_MAX - 0.5;
+        for(std::size_t d = 0 ; d < D_ ; ++d){
+            b_[d] = 0;
+            for(std::size_t k = 0 ; k < nnz_ ; ++k){
+                idx_[d*nnz_+k] = rand()%N_;
+                val_[d*nnz_+k] = (ScalarType)rand()/RAND_MAX - 0.5;
+                b_[d] += val_[d*nnz_+k]*x_star_[idx_[d*nnz_+k]];
+            }
+        }
+    }
+
+    std::size_t N() const { return N_; }
+    std::size_t dataset_size() const { return D_; }
+
+    ScalarType error(VectorType const & x) const{
+        ScalarType res = 0;
+        for(std::size_t n = 0 ; n < N_ ; ++n)
+            res += (x[n] - x_star_[n])*(x[n] - x_star_[n]);
+        return std::sqrt(res);
+    }
+
+    void operator()(VectorType const & x, std::vector<std::size_t> & indices, std::vector<ScalarType> & values, umintl::sparse_gradient tag) const{
+        for(std::size_t d = tag.offset ; d < tag.offset + tag.sample_size ; ++d){
+            ScalarType r = -b_[d];
+            for(std::size_t k = 0 ; k < nnz_ ; ++k)
+                r += val_[d*nnz_+k]*x[idx_[d*nnz_+k]];
+            for(std::size_t k = 0 ; k < nnz_ ; ++k){
+                indices.push_back(idx_[d*nnz_+k]);
+                values.push_back(2*r*val_[d*nnz_+k]/tag.sample_size);
+            }
+        }
+    }
+
+private:
+    std::size_t N_;
+    std::size_t D_;
+    std::size_t nnz_;
+    std::vector<std::size_t> idx_;
+    std::vector<ScalarType> val_;
+    std::vector<ScalarType> b_;
+    std::vector<ScalarType> x_star_;
+};
+
+int test(sparse_regression & fun, unsigned int n_threads){
+    std::size_t N = fun.N();
+    unsigned int n_epochs = 30;
+    std::cout << "- Testing " << n_threads << " thread(s)..." << std::flush;
+    VectorType X0 = BackendType::create_vector(N);
+    VectorType S = BackendType::create_vector(N);
+    BackendType::set_to_value(X0,0,N);
+    hogwild<BackendType> solver(step_size(0.5), 1, fun.dataset_size(), n_threads, n_epochs);
+    hogwild_result result = solver(S,fun,X0,N);
+    ScalarType error = fun.error(S)/fun.error(X0);
+    BackendType::delete_if_dynamically_allocated(X0);
+    BackendType::delete_if_dynamically_allocated(S);
+    if(result.n_samples != n_epochs*fun.dataset_size() || result.n_updates != result.n_samples){
+        std::cout << " Fail! /* " << result.n_samples << " samples */" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if(error > 1e-3){
+        std::cout << " Fail! /* Relative error = " << error << " */" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << " " << result.samples_per_second << " samples/s" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+int main(){
+    srand(0);
+    int result = EXIT_SUCCESS;
+    sparse_regression fun(1000, 20000, 5);
+    std::cout << "Testing Hogwild..." << std::endl;
+    result |= test(fun, 1);
+    result |= test(fun, 4);
+    return result;
+}
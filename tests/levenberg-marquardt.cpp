@@ -0,0 +1,64 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+#include <cstdlib>
+#include <iostream>
+
+#include "test-common.hpp"
+#include "mghfuns/freudenstein_roth.hpp"
+#include "mghfuns/jenrich_sampson.hpp"
+#include "mghfuns/meyer.hpp"
+
+using namespace umintl;
+
+/** @param max_iterations bound on the number of iterations, about twice what the slowest of the solvers needs */
+template<class FunctionType>
+int test_lm(FunctionType const & fun, umintl::tag::levenberg_marquardt::solver solver, std::size_t max_iterations){
+    typedef typename FunctionType::BackendType BackendType;
+    umintl::minimizer<BackendType> minimizer(new levenberg_marquardt<BackendType>(fun.M(),solver), new gradient_treshold<BackendType>(), 4096, 0);
+    return test_function(fun,minimizer,max_iterations);
+}
+
+template<class BackendType>
+int test_solver(std::string const & name, umintl::tag::levenberg_marquardt::solver solver){
+    std::cout << "Testing " << name << "..." << std::endl;
+    int res = EXIT_SUCCESS;
+    res |= test_lm(helical_valley<BackendType>(),solver,20);
+    res |= test_lm(biggs_exp6<BackendType>(),solver,120);
+    res |= test_lm(gaussian<BackendType>(),solver,10);
+    res |= test_lm(powell_badly_scaled<BackendType>(),solver,200);
+    res |= test_lm(box_3d<BackendType>(),solver,30);
+    res |= test_lm(variably_dimensioned<BackendType>(20),solver,30);
+    res |= test_lm(watson<BackendType>(6),solver,20);
+    res |= test_lm(penalty1<BackendType>(10),solver,50);
+    res |= test_lm(penalty2<BackendType>(10),solver,70);
+    res |= test_lm(brown_badly_scaled<BackendType>(),solver,50);
+    res |= test_lm(brown_dennis<BackendType>(),solver,70);
+    res |= test_lm(gulf<BackendType>(20),solver,250);
+    res |= test_lm(trigonometric<BackendType>(10),solver,15);
+    res |= test_lm(rosenbrock<BackendType>(2),solver,40);
+    res |= test_lm(powell_singular<BackendType>(4),solver,20);
+    res |= test_lm(rosenbrock<BackendType>(20),solver,40);
+    res |= test_lm(powell_singular<BackendType>(40),solver,20);
+    res |= test_lm(jenrich_sampson<BackendType>(),solver,20);
+    res |= test_lm(freudenstein_roth<BackendType>(),solver,50);
+    res |= test_lm(meyer<BackendType>(),solver,1000);
+    res |= test_lm(beale<BackendType>(),solver,10);
+    res |= test_lm(wood<BackendType>(),solver,60);
+    return res;
+}
+
+int main(){
+    srand(0);
+    int result = EXIT_SUCCESS;
+    typedef typename get_backend<double>::type BackendType;
+
+    result |= test_solver<BackendType>("Levenberg-Marquardt [Dense QR]", umintl::tag::levenberg_marquardt::SOLVE_DENSE_QR);
+    result |= test_solver<BackendType>("Levenberg-Marquardt [Matrix-free CG]", umintl::tag::levenberg_marquardt::SOLVE_MATRIX_FREE_CG);
+
+    return result;
+}
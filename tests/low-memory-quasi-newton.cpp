@@ -21,6 +21,9 @@ int main(){
     result |= test_option("lbfgs [Double, M=4]", new low_memory_quasi_newton<BackendType>(4));
     result |= test_option("lbfgs [Double, M=8]", new low_memory_quasi_newton<BackendType>(8));
     result |= test_option("lbfgs [Double, M=32]", new low_memory_quasi_newton<BackendType>(32));
+    result |= test_option("vector-free lbfgs [Double, M=2]", new vector_free_low_memory_quasi_newton<BackendType>(2));
+    result |= test_option("vector-free lbfgs [Double, M=8]", new vector_free_low_memory_quasi_newton<BackendType>(8));
+    result |= test_option("vector-free lbfgs [Double, M=32]", new vector_free_low_memory_quasi_newton<BackendType>(32));
 
     return result;
 
@@ -0,0 +1,160 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "umintl/backends/cblas.hpp"
+#include "umintl/minimize.hpp"
+#include "umintl/dataset/mapped_dataset.hpp"
+
+using namespace umintl;
+
+typedef double ScalarType;
+typedef umintl::backend::cblas_types<ScalarType> BackendType;
+typedef BackendType::VectorType VectorType;
+
+/** @brief f(x) = 1/S sum_{i in window} (a_i'x - b_i)^2, read from a mapped dataset (dense or CSR) */
+class mapped_least_squares{
+public:
+    mapped_least_squares(mapped_dataset<ScalarType> & data) : data_(data){ }
+
+    void operator()(VectorType const & x, ScalarType & value, VectorType & gradient, umintl::value_gradient tag) const{
+        dataset_window<ScalarType> w = data_.window(tag);
+        value = 0;
+        for(std::size_t n = 0 ; n < w.cols ; ++n)
+            gradient[n] = 0;
+        for(std::size_t i = 0 ; i < w.rows ; ++i){
+            ScalarType r = -w.targets[i];
+            if(w.row_ptr){
+                for(uint64_t k = w.row_ptr[i] ; k < w.row_ptr[i+1] ; ++k)
+                    r += w.values[k]*x[w.col_idx[k]];
+                for(uint64_t k = w.row_ptr[i] ; k < w.row_ptr[i+1] ; ++k)
+                    gradient[w.col_idx[k]] += 2*r*w.values[k]/w.rows;
+            }
+            else{
+                ScalarType const * a = w.values + i*w.cols;
+                for(std::size_t n = 0 ; n < w.cols ; ++n)
+                    r += a[n]*x[n];
+                for(std::size_t n = 0 ; n < w.cols ; ++n)
+                    gradient[n] += 2*r*a[n]/w.rows;
+            }
+            value += r*r/w.rows;
+        }
+    }
+
+private:
+    mapped_dataset<ScalarType> & data_;
+};
+
+int fail(std::string const & message){
+    std::cout << " Fail! /* " << message << " */" << std::endl;
+    return EXIT_FAILURE;
+}
+
+/** @brief Checks that every window matches the dense matrix A, and that the minimizer recovers x_star */
+int test(std::string const & name, std::string const & path, std::vector<ScalarType> const & A, std::vector<ScalarType> const & b, std::vector<ScalarType> const & x_star, std::size_t rows, std::size_t cols){
+    std::cout << "- Testing " << name << "..." << std::flush;
+    mapped_dataset<ScalarType> data(path);
+    if(data.rows()!=rows || data.cols()!=cols || !data.has_targets())
+        return fail("Wrong header");
+    data.advise(tools::mapped_file::ADVICE_SEQUENTIAL);
+
+    std::size_t sample_size = 7;
+    for(std::size_t offset = 0 ; offset + sample_size <= rows ; offset+=sample_size){
+        value_gradient tag(STOCHASTIC, sample_size, offset);
+        data.next_window(value_gradient(STOCHASTIC, sample_size, (offset + sample_size)%rows));
+        dataset_window<ScalarType> w = data.window(tag);
+        for(std::size_t i = 0 ; i < w.rows ; ++i){
+            std::vector<ScalarType> row(cols, 0);
+            if(w.row_ptr)
+                for(uint64_t k = w.row_ptr[i] ; k < w.row_ptr[i+1] ; ++k)
+                    row[w.col_idx[k]] = w.values[k];
+            else
+                for(std::size_t n = 0 ; n < cols ; ++n)
+                    row[n] = w.values[i*cols+n];
+            for(std::size_t n = 0 ; n < cols ; ++n)
+                if(row[n] != A[(offset+i)*cols+n])
+                    return fail("Wrong window content");
+            if(w.targets[i] != b[offset+i])
+                return fail("Wrong targets");
+        }
+    }
+
+    mapped_least_squares fun(data);
+    VectorType X0 = BackendType::create_vector(cols);
+    VectorType S = BackendType::create_vector(cols);
+    BackendType::set_to_value(X0,0,cols);
+    umintl::minimizer<BackendType> minimizer(new quasi_newton<BackendType>(), new gradient_treshold<BackendType>(1e-10), 1000);
+    //The gradient is evaluated on the whole dataset, the model only hints its windows to the dataset
+    mini_batch<BackendType> * model = new mini_batch<BackendType>(sample_size, rows);
+    model->set_window_hint(&data);
+    minimizer.model = model;
+    minimizer(S,fun,X0,cols);
+    ScalarType error = 0;
+    for(std::size_t n = 0 ; n < cols ; ++n)
+        error = std::max(error, std::fabs(S[n] - x_star[n]));
+    BackendType::delete_if_dynamically_allocated(X0);
+    BackendType::delete_if_dynamically_allocated(S);
+    if(error > 1e-6)
+        return fail("Wrong minimum");
+    std::cout << std::endl;
+    return EXIT_SUCCESS;
+}
+
+int main(){
+    srand(0);
+    int result = EXIT_SUCCESS;
+    std::size_t rows = 200, cols = 8;
+    std::string dense_path = "mapped-dataset-dense.bin";
+    std::string csr_path = "mapped-dataset-csr.bin";
+
+    //Sparse consistent dataset, roughly half of the entries are zero
+    std::vector<ScalarType> A(rows*cols, 0), b(rows, 0), x_star(cols);
+    std::vector<uint64_t> row_ptr(1, 0);
+    std::vector<uint32_t> col_idx;
+    std::vector<ScalarType> values;
+    for(std::size_t n = 0 ; n < cols ; ++n)
+        x_star[n] = (ScalarType)rand()/RAND_MAX - 0.5;
+    for(std::size_t i = 0 ; i < rows ; ++i){
+        for(std::size_t n = 0 ; n < cols ; ++n){
+            if(rand()%2 && n!=i%cols)
+                continue;
+            A[i*cols+n] = (ScalarType)rand()/RAND_MAX - 0.5;
+            b[i] += A[i*cols+n]*x_star[n];
+            col_idx.push_back(n);
+            values.push_back(A[i*cols+n]);
+        }
+        row_ptr.push_back(values.size());
+    }
+
+    std::cout << "Testing Mapped Dataset..." << std::endl;
+    dataset_format::write_dense(dense_path, rows, cols, &A[0], &b[0]);
+    dataset_format::write_csr(csr_path, rows, cols, &row_ptr[0], &col_idx[0], &values[0], &b[0]);
+    result |= test("Dense", dense_path, A, b, x_star, rows, cols);
+    result |= test("CSR", csr_path, A, b, x_star, rows, cols);
+
+    std::cout << "- Testing Invalid files..." << std::flush;
+    try{
+        mapped_dataset<float> data(dense_path);
+        result |= fail("Scalar type mismatch not detected");
+    }
+    catch(exceptions::incompatible_parameters const &){ }
+    try{
+        mapped_dataset<ScalarType> data("mapped-dataset-missing.bin");
+        result |= fail("Missing file not detected");
+    }
+    catch(exceptions::io_error const &){ }
+    std::cout << std::endl;
+
+    std::remove(dense_path.c_str());
+    std::remove(csr_path.c_str());
+    return result;
+}
@@ -24,7 +24,9 @@ class biggs_exp6 : public sum_square<BackendType>{
     using base_type::N_;
     using base_type::get;
 public:
-    biggs_exp6() : base_type("Biggs EXP6",13,6,5.65565e-3){ }
+    biggs_exp6() : base_type("Biggs EXP6",13,6,0){
+        base_type::local_minima_.push_back(5.65565e-3);
+    }
     void init(VectorType & X) const
     {
         X[0] = 1;
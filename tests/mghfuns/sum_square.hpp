@@ -23,6 +23,7 @@ public:
     typedef _BackendType BackendType;
 private:
     typedef typename BackendType::VectorType VectorType;
+    typedef typename BackendType::MatrixType MatrixType;
     typedef double ScalarType;
 protected:
     ScalarType & get(ScalarType *A, std::size_t m, std::size_t n) const {
@@ -68,6 +69,32 @@ public:
         delete[] dy_dx;
         delete[] y;
     }
+    void operator()(VectorType const & V, VectorType & y, MatrixType & dy_dx, umintl::residuals_jacobian) const{
+        for(std::size_t m = 0 ; m < M_ ; ++m)
+            y[m] = 0;
+        fill_ym(V,y);
+        for(std::size_t m = 0 ; m < M_ ; ++m)
+            for(std::size_t n = 0 ; n < N_ ; ++n)
+                get(dy_dx,m,n) = 0;
+        fill_dym_dxn(V,dy_dx);
+    }
+    void operator()(VectorType const & V, VectorType const & v, VectorType & Gv, umintl::gauss_newton_vector_product) const{
+        ScalarType* dy_dx = new ScalarType[M_*N_];
+        for(std::size_t m = 0 ; m < M_ ; ++m)
+            for(std::size_t n = 0 ; n < N_ ; ++n)
+                get(dy_dx,m,n) = 0;
+        fill_dym_dxn(V,dy_dx);
+        for(std::size_t n = 0 ; n < N_ ; ++n)
+            Gv[n] = 0;
+        for(std::size_t m = 0 ; m < M_ ; ++m){
+            ScalarType Jv = 0;
+            for(std::size_t n = 0 ; n < N_ ; ++n)
+                Jv += get(dy_dx,m,n)*v[n];
+            for(std::size_t n = 0 ; n < N_ ; ++n)
+                Gv[n] += 2*get(dy_dx,m,n)*Jv;
+        }
+        delete[] dy_dx;
+    }
 protected:
     std::string name_;
     std::size_t M_;
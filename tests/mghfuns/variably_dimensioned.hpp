@@ -34,7 +34,7 @@ public:
         std::size_t N = N_;
         for(std::size_t m = 0 ; m < N ; ++m)
             for(std::size_t n = 0 ; n < N ; ++n)
-                get(res,m,n) = n;
+                get(res,m,n) = (m==n);
 
         ScalarType sum = 0;
         for(std::size_t n = 0 ; n < N ; ++n)
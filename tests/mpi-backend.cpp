@@ -0,0 +1,104 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+#include <cstdlib>
+#include <cmath>
+#include <iostream>
+
+#include "umintl/backends/mpi.hpp"
+#include "umintl/minimize.hpp"
+
+using namespace umintl;
+
+typedef double ScalarType;
+typedef umintl::backend::mpi_types<ScalarType> BackendType;
+typedef BackendType::VectorType VectorType;
+
+/** @brief f(x) = sum_i d_i(x_i - 1)^2 + (sum_i x_i - N)^2/N, whose coupling term requires a reduction over the processes */
+struct coupled_quadratic{
+    coupled_quadratic(std::size_t N) : N_(N), n_(BackendType::block_size(N)), offset_(BackendType::block_offset(N)){ }
+
+    std::size_t local_size() const { return n_; }
+
+    void operator()(VectorType const & x, ScalarType & value, VectorType & gradient, umintl::value_gradient) const{
+        ScalarType local[2] = {0, 0};
+        ScalarType global[2];
+        for(std::size_t i = 0 ; i < n_ ; ++i){
+            local[0] += d(i)*(x[i]-1)*(x[i]-1);
+            local[1] += x[i];
+        }
+        MPI_Allreduce(local, global, 2, MPI_DOUBLE, MPI_SUM, BackendType::communicator());
+        ScalarType coupling = global[1] - N_;
+        value = global[0] + coupling*coupling/N_;
+        for(std::size_t i = 0 ; i < n_ ; ++i)
+            gradient[i] = 2*d(i)*(x[i]-1) + 2*coupling/N_;
+    }
+
+private:
+    ScalarType d(std::size_t i) const { return 1 + 9*(ScalarType)(offset_+i)/N_; }
+
+    std::size_t N_;
+    std::size_t n_;
+    std::size_t offset_;
+};
+
+int test(std::string const & name, coupled_quadratic & fun, umintl::direction<BackendType> * direction, int rank){
+    std::size_t n = fun.local_size();
+    if(rank==0)
+        std::cout << "- Testing " << name << "..." << std::flush;
+    VectorType X0 = BackendType::create_vector(n);
+    VectorType S = BackendType::create_vector(n);
+    BackendType::set_to_value(X0,0,n);
+    umintl::minimizer<BackendType> minimizer(direction, new gradient_treshold<BackendType>(1e-8), 1000);
+    umintl::optimization_result result = minimizer(S,fun,X0,n);
+
+    double error = 0;
+    for(std::size_t i = 0 ; i < n ; ++i)
+        error = std::max(error, std::abs(S[i] - 1));
+    double global_error;
+    MPI_Allreduce(&error, &global_error, 1, MPI_DOUBLE, MPI_MAX, BackendType::communicator());
+    //Every process must have taken the same decisions
+    long iterations[2] = {(long)result.iteration, -(long)result.iteration};
+    long global_iterations[2];
+    MPI_Allreduce(iterations, global_iterations, 2, MPI_LONG, MPI_MAX, BackendType::communicator());
+    BackendType::delete_if_dynamically_allocated(X0);
+    BackendType::delete_if_dynamically_allocated(S);
+
+    if(global_iterations[0] != -global_iterations[1]){
+        if(rank==0) std::cout << " Fail! /* The processes diverged */" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if(global_error > 1e-6){
+        if(rank==0) std::cout << " Fail! /* Error = " << global_error << " */" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if(rank==0)
+        std::cout << " " << result.iteration << " iterations" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char * argv[]){
+    MPI_Init(&argc, &argv);
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    int result = EXIT_SUCCESS;
+    {
+        coupled_quadratic fun(1000);
+        if(rank==0)
+            std::cout << "Testing MPI Backend on " << size << " processes..." << std::endl;
+        result |= test("Steepest Descent", fun, new steepest_descent<BackendType>(), rank);
+        result |= test("Conjugate Gradient", fun, new conjugate_gradient<BackendType>(), rank);
+        result |= test("L-BFGS", fun, new low_memory_quasi_newton<BackendType>(8), rank);
+        result |= test("Vector-free L-BFGS", fun, new vector_free_low_memory_quasi_newton<BackendType>(8), rank);
+        result |= test("Truncated Newton", fun, new truncated_newton<BackendType>(), rank);
+    }
+    int global_result;
+    MPI_Allreduce(&result, &global_result, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+    MPI_Finalize();
+    return global_result;
+}
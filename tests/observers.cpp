@@ -0,0 +1,129 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <sstream>
+#include <iostream>
+
+#include "test-common.hpp"
+
+typedef get_backend<double>::type BackendType;
+typedef BackendType::VectorType VectorType;
+typedef BackendType::ScalarType ScalarType;
+
+/** @brief Records the iterations, and stops the optimization once the value falls below a threshold */
+struct recorder : public observer<BackendType>{
+    recorder(ScalarType _threshold) : threshold(_threshold), n_finish(0){ }
+    bool operator()(iteration_info<BackendType> const & info){
+        iterations.push_back(info.iter);
+        values.push_back(info.value);
+        ScalarType nrm = 0;
+        for(std::size_t i = 0 ; i < info.N ; ++i)
+            nrm += info.g[i]*info.g[i];
+        consistent = consistent && std::abs(std::sqrt(nrm) - info.gradient_norm) <= 1e-12*std::max(info.gradient_norm,(ScalarType)1)
+                                && info.elapsed_time >= info.iteration_time && info.iteration_time >= 0;
+        return info.value < threshold;
+    }
+    void init(){
+        iterations.clear();
+        values.clear();
+        consistent = true;
+    }
+    void finish(optimization_result const &){
+        n_finish++;
+    }
+    ScalarType threshold;
+    std::vector<unsigned int> iterations;
+    std::vector<ScalarType> values;
+    bool consistent;
+    unsigned int n_finish;
+};
+
+int test_recorder(){
+    std::cout << "- Testing observer..." << std::flush;
+    rosenbrock<BackendType> fun(20);
+    std::size_t N = fun.N();
+    VectorType X0 = BackendType::create_vector(N);
+    VectorType S = BackendType::create_vector(N);
+    fun.init(X0);
+    minimizer<BackendType> minimizer(new quasi_newton<BackendType>(), new gradient_treshold<BackendType>(1e-8), 1000);
+    recorder * r = new recorder(0);
+    minimizer.add_observer(r);
+    optimization_result result = minimizer(S,fun,X0,N);
+    //One call per iteration, and one with the final state. The last iteration meets the stopping criterion, and is not counted in result.iteration
+    bool ok = r->consistent && r->n_finish==1 && result.termination_cause==optimization_result::STOPPING_CRITERION
+           && r->iterations.size()==result.iteration+2 && r->values.back()==result.f;
+    for(std::size_t k = 0 ; k < r->iterations.size() ; ++k)
+        ok = ok && r->iterations[k]==k && (k==0 || r->values[k] <= r->values[k-1]);
+    BackendType::delete_if_dynamically_allocated(X0);
+    BackendType::delete_if_dynamically_allocated(S);
+    if(!ok){
+        std::cout << " Fail! /* " << r->iterations.size() << " calls for " << result.iteration << " iterations */" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << std::endl;
+    return EXIT_SUCCESS;
+}
+
+int test_early_termination(){
+    std::cout << "- Testing early termination..." << std::flush;
+    rosenbrock<BackendType> fun(20);
+    std::size_t N = fun.N();
+    VectorType X0 = BackendType::create_vector(N);
+    VectorType S = BackendType::create_vector(N);
+    fun.init(X0);
+    minimizer<BackendType> minimizer(new quasi_newton<BackendType>(), new gradient_treshold<BackendType>(1e-8), 1000);
+    recorder * r = new recorder(1e-2);
+    minimizer.add_observer(r);
+    optimization_result result = minimizer(S,fun,X0,N);
+    BackendType::delete_if_dynamically_allocated(X0);
+    BackendType::delete_if_dynamically_allocated(S);
+    //The observers have already seen the final state : it is not notified again
+    if(result.termination_cause!=optimization_result::OBSERVER_REQUEST || result.f >= 1e-2
+       || r->iterations.size()!=result.iteration+1 || r->values.back()!=result.f){
+        std::cout << " Fail! /* f = " << result.f << " */" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << std::endl;
+    return EXIT_SUCCESS;
+}
+
+int test_printer(){
+    std::cout << "- Testing buffered printer..." << std::flush;
+    rosenbrock<BackendType> fun(20);
+    std::size_t N = fun.N();
+    VectorType X0 = BackendType::create_vector(N);
+    VectorType S = BackendType::create_vector(N);
+    fun.init(X0);
+    std::ostringstream oss;
+    minimizer<BackendType> minimizer(new quasi_newton<BackendType>(), new gradient_treshold<BackendType>(1e-8), 1000);
+    minimizer.add_observer(new printer<BackendType>(oss, 1<<20));
+    optimization_result result = minimizer(S,fun,X0,N);
+    std::string output = oss.str();
+    std::size_t n_lines = 0;
+    for(std::size_t i = 0 ; i < output.size() ; ++i)
+        n_lines += output[i]=='\n';
+    BackendType::delete_if_dynamically_allocated(X0);
+    BackendType::delete_if_dynamically_allocated(S);
+    if(n_lines!=result.iteration+2){
+        std::cout << " Fail! /* " << n_lines << " lines for " << result.iteration << " iterations */" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << std::endl;
+    return EXIT_SUCCESS;
+}
+
+int main(){
+    int result = EXIT_SUCCESS;
+    std::cout << "Testing observers..." << std::endl;
+    result |= test_recorder();
+    result |= test_early_termination();
+    result |= test_printer();
+    return result;
+}
@@ -0,0 +1,122 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+#include "umintl/backends/cblas.hpp"
+#include "umintl/minimize.hpp"
+#include "umintl/debug.hpp"
+
+using namespace umintl;
+
+typedef double ScalarType;
+typedef umintl::backend::cblas_types<ScalarType> BackendType;
+typedef BackendType::VectorType VectorType;
+
+/** 100(x1 - x0^2)^2 + (1 - x0)^2. Counts its evaluations */
+struct rosenbrock_element : public element_function<BackendType>{
+    rosenbrock_element(unsigned int * n_calls = NULL) : n_calls_(n_calls){ }
+    void operator()(ScalarType const * x, ScalarType & value, ScalarType * gradient) const{
+        if(n_calls_)
+            ++*n_calls_;
+        ScalarType a = x[1] - x[0]*x[0];
+        value = 100*a*a + (1-x[0])*(1-x[0]);
+        gradient[0] = -400*x[0]*a - 2*(1-x[0]);
+        gradient[1] = 200*a;
+    }
+private:
+    unsigned int * n_calls_;
+};
+
+/** ((3 - 2x_i)x_i - x_{i-1} - 2x_{i+1} + 1)^2, with x_{-1} = x_{N} = 0 */
+struct broyden_tridiagonal_element : public element_function<BackendType>{
+    broyden_tridiagonal_element(bool has_left, bool has_right) : has_left_(has_left), has_right_(has_right){ }
+    void operator()(ScalarType const * x, ScalarType & value, ScalarType * gradient) const{
+        ScalarType const * xi = x + has_left_;
+        ScalarType r = (3 - 2*xi[0])*xi[0] + 1;
+        if(has_left_) r -= x[0];
+        if(has_right_) r -= 2*xi[1];
+        value = r*r;
+        if(has_left_) gradient[0] = -2*r;
+        gradient[has_left_] = 2*r*(3 - 4*xi[0]);
+        if(has_right_) gradient[has_left_+1] = -4*r;
+    }
+private:
+    bool has_left_;
+    bool has_right_;
+};
+
+/** @param n_calls if not NULL, number of evaluations of one of the elements, which must all be accounted for by the minimizer */
+int test(std::string const & name, partially_separable_function<BackendType> & fun, VectorType X0, std::size_t expected_colors, unsigned int * n_calls = NULL){
+    std::size_t N = fun.N();
+    std::cout << "- Testing " << name << " [" << N << "]..." << std::flush;
+    if(fun.n_colors()!=expected_colors){
+        std::cout << " Fail! /* " << fun.n_colors() << " colors */" << std::endl;
+        return EXIT_FAILURE;
+    }
+    ScalarType diff = check_grad<BackendType>(fun,X0,N,1e-6);
+    if(diff > 1e-5){
+        std::cout << " Fail! /* Gradient diff = " << diff << "*/" << std::endl;
+        return EXIT_FAILURE;
+    }
+    VectorType S = BackendType::create_vector(N);
+    if(n_calls)
+        *n_calls = 0;
+    umintl::minimizer<BackendType> minimizer(new partitioned_quasi_newton<BackendType>(fun), new gradient_treshold<BackendType>(1e-6), 4096);
+    umintl::optimization_result result = minimizer(S,fun,X0,N);
+    BackendType::delete_if_dynamically_allocated(S);
+    if(result.f > 1e-8){
+        std::cout << " Fail! /* f = " << result.f << "*/" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if(n_calls && *n_calls != result.n_functions_eval){
+        std::cout << " Fail! /* " << *n_calls << " evaluations, " << result.n_functions_eval << " accounted for */" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << " " << result.iteration << " iterations" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+int main(){
+    int result = EXIT_SUCCESS;
+    std::cout << "Testing Partitioned Quasi-Newton..." << std::endl;
+
+    std::size_t sizes[] = {10, 100, 500};
+    for(std::size_t k = 0 ; k < 3 ; ++k){
+        std::size_t N = sizes[k];
+        VectorType X0 = BackendType::create_vector(N);
+
+        partially_separable_function<BackendType> rosenbrock(N);
+        unsigned int n_calls = 0;
+        for(std::size_t i = 0 ; i + 1 < N ; ++i){
+            std::vector<std::size_t> idx(2);
+            idx[0] = i; idx[1] = i+1;
+            rosenbrock.add(new rosenbrock_element(i==0?&n_calls:NULL), idx);
+        }
+        for(std::size_t i = 0 ; i < N ; ++i)
+            X0[i] = (i%2)?1:-1.2;
+        result |= test("Chained Rosenbrock", rosenbrock, X0, 2, &n_calls);
+
+        partially_separable_function<BackendType> broyden(N);
+        for(std::size_t i = 0 ; i < N ; ++i){
+            std::vector<std::size_t> idx;
+            if(i > 0) idx.push_back(i-1);
+            idx.push_back(i);
+            if(i+1 < N) idx.push_back(i+1);
+            broyden.add(new broyden_tridiagonal_element(i>0, i+1<N), idx);
+        }
+        for(std::size_t i = 0 ; i < N ; ++i)
+            X0[i] = -1;
+        result |= test("Broyden Tridiagonal", broyden, X0, 3);
+
+        BackendType::delete_if_dynamically_allocated(X0);
+    }
+
+    return result;
+}
@@ -0,0 +1,142 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "umintl/backends/cblas.hpp"
+#include "umintl/minimize.hpp"
+#include "umintl/dataset/mapped_dataset.hpp"
+#include "umintl/dataset/prefetcher.hpp"
+
+using namespace umintl;
+
+typedef double ScalarType;
+typedef umintl::backend::cblas_types<ScalarType> BackendType;
+typedef BackendType::VectorType VectorType;
+
+/** @brief Expands a CSR window into dense rows */
+struct csr_to_dense : public window_decoder<ScalarType>{
+    void operator()(dataset_window<ScalarType> const & w, std::vector<ScalarType> & res) const{
+        res.assign(w.rows*w.cols, 0);
+        for(std::size_t i = 0 ; i < w.rows ; ++i)
+            for(uint64_t k = w.row_ptr[i] ; k < w.row_ptr[i+1] ; ++k)
+                res[i*w.cols + w.col_idx[k]] = w.values[k];
+    }
+};
+
+/** @brief f(x) = 1/S sum_{i in window} (a_i'x - b_i)^2. Reads the windows either through the prefetcher, or directly from the dataset */
+class least_squares{
+public:
+    least_squares(mapped_dataset<ScalarType> const & data, window_prefetcher<ScalarType> * prefetcher) : data_(data), prefetcher_(prefetcher){ }
+
+    void operator()(VectorType const & x, ScalarType & value, VectorType & gradient, umintl::value_gradient tag) const{
+        std::vector<ScalarType> dense;
+        dataset_window<ScalarType> w;
+        ScalarType const * A;
+        if(prefetcher_){
+            prefetched_window<ScalarType> const & p = prefetcher_->acquire(tag);
+            w = p.window;
+            A = &p.decoded[0];
+        }
+        else{
+            w = data_.window(tag);
+            csr_to_dense()(w, dense);
+            A = &dense[0];
+        }
+        value = 0;
+        for(std::size_t n = 0 ; n < w.cols ; ++n)
+            gradient[n] = 0;
+        for(std::size_t i = 0 ; i < w.rows ; ++i){
+            ScalarType r = -w.targets[i];
+            for(std::size_t n = 0 ; n < w.cols ; ++n)
+                r += A[i*w.cols+n]*x[n];
+            for(std::size_t n = 0 ; n < w.cols ; ++n)
+                gradient[n] += 2*r*A[i*w.cols+n]/w.rows;
+            value += r*r/w.rows;
+        }
+    }
+
+private:
+    mapped_dataset<ScalarType> const & data_;
+    window_prefetcher<ScalarType> * prefetcher_;
+};
+
+void run(mapped_dataset<ScalarType> const & data, window_prefetcher<ScalarType> * prefetcher, unsigned int max_iter, VectorType & S){
+    std::size_t N = data.cols();
+    least_squares fun(data, prefetcher);
+    VectorType X0 = BackendType::create_vector(N);
+    BackendType::set_to_value(X0,0,N);
+    mini_batch<BackendType> * model = new mini_batch<BackendType>(20, data.rows(), true);
+    model->set_window_hint(prefetcher);
+    umintl::minimizer<BackendType> minimizer(new stochastic_gradient<BackendType>(step_size(0.1)), new gradient_treshold<BackendType>(0), max_iter);
+    minimizer.model = model;
+    minimizer(S,fun,X0,N);
+    BackendType::delete_if_dynamically_allocated(X0);
+}
+
+int main(){
+    srand(0);
+    int result = EXIT_SUCCESS;
+    std::size_t rows = 200, cols = 8;
+    unsigned int max_iter = 100;
+    std::string path = "prefetch-dataset.bin";
+
+    std::vector<uint64_t> row_ptr(1, 0);
+    std::vector<uint32_t> col_idx;
+    std::vector<ScalarType> values, b(rows, 0), x_star(cols);
+    for(std::size_t n = 0 ; n < cols ; ++n)
+        x_star[n] = (ScalarType)rand()/RAND_MAX - 0.5;
+    for(std::size_t i = 0 ; i < rows ; ++i){
+        for(std::size_t n = 0 ; n < cols ; ++n){
+            if(rand()%2 && n!=i%cols)
+                continue;
+            ScalarType a = (ScalarType)rand()/RAND_MAX - 0.5;
+            b[i] += a*x_star[n];
+            col_idx.push_back(n);
+            values.push_back(a);
+        }
+        row_ptr.push_back(values.size());
+    }
+    dataset_format::write_csr(path, rows, cols, &row_ptr[0], &col_idx[0], &values[0], &b[0]);
+
+    std::cout << "Testing Prefetching..." << std::endl;
+    std::cout << "- Testing Mini-batch windows..." << std::flush;
+    {
+        mapped_dataset<ScalarType> data(path);
+        csr_to_dense decoder;
+        window_prefetcher<ScalarType> prefetcher(data, &decoder);
+        VectorType S_direct = BackendType::create_vector(cols);
+        VectorType S_prefetched = BackendType::create_vector(cols);
+        run(data, NULL, max_iter, S_direct);
+        run(data, &prefetcher, max_iter, S_prefetched);
+
+        //The two first windows are not announced by the model
+        if(prefetcher.misses() != 2 || prefetcher.hits() != max_iter - 1){
+            std::cout << " Fail! /* " << prefetcher.hits() << " hits, " << prefetcher.misses() << " misses */" << std::endl;
+            result = EXIT_FAILURE;
+        }
+        else{
+            for(std::size_t n = 0 ; n < cols ; ++n)
+                if(S_direct[n] != S_prefetched[n]){
+                    std::cout << " Fail! /* Different iterates */" << std::endl;
+                    result = EXIT_FAILURE;
+                    break;
+                }
+        }
+        if(result == EXIT_SUCCESS)
+            std::cout << std::endl;
+        BackendType::delete_if_dynamically_allocated(S_direct);
+        BackendType::delete_if_dynamically_allocated(S_prefetched);
+    }
+
+    std::remove(path.c_str());
+    return result;
+}
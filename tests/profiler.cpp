@@ -0,0 +1,68 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "test-common.hpp"
+
+typedef get_backend<double>::type BackendType;
+typedef BackendType::VectorType VectorType;
+typedef BackendType::ScalarType ScalarType;
+
+/** @brief Profiles a run, and checks that the profiler neither changes the iterates nor loses any evaluation */
+int test_profiler(std::string const & name, direction<BackendType> * profiled_direction, direction<BackendType> * reference_direction, bool exact_evaluations){
+    std::cout << "- Testing " << name << "..." << std::endl;
+    rosenbrock<BackendType> fun(20);
+    std::size_t N = fun.N();
+    VectorType X0 = BackendType::create_vector(N);
+    VectorType S[2];
+    S[0] = BackendType::create_vector(N);
+    S[1] = BackendType::create_vector(N);
+    fun.init(X0);
+
+    minimizer<BackendType> reference(reference_direction, new gradient_treshold<BackendType>(1e-8), 1000);
+    optimization_result expected = reference(S[0],fun,X0,N);
+
+    minimizer<BackendType> profiled(profiled_direction, new gradient_treshold<BackendType>(1e-8), 1000);
+    phase_profiler * profiler = new phase_profiler();
+    profiled.profiler = profiler;
+    optimization_result result = profiled(S[1],fun,X0,N);
+    profiler->print(std::cout);
+
+    phase_profiler const & p = *profiler;
+    //The hessian-vector products of the truncated newton direction are evaluations as well
+    std::size_t n_evaluations = result.n_functions_eval;
+    bool ok = result.iteration==expected.iteration && std::memcmp(&S[0][0],&S[1][0],N*sizeof(ScalarType))==0
+           && p[tag::phase::EVALUATION].n_calls >= n_evaluations && (!exact_evaluations || p[tag::phase::EVALUATION].n_calls==n_evaluations)
+           && p[tag::phase::DIRECTION].n_calls==result.iteration+1 && p[tag::phase::LINE_SEARCH].n_calls==result.iteration+1
+           && p[tag::phase::STOPPING_TEST].n_calls <= result.iteration+1;
+    for(int k = 0 ; k < tag::phase::N_PHASES ; ++k)
+        ok = ok && p[(tag::phase::type)k].time >= 0;
+    if(p.counters().available(tools::perf_counters::INSTRUCTIONS))
+        ok = ok && p[tag::phase::EVALUATION].counts[tools::perf_counters::INSTRUCTIONS] > 0
+                && p[tag::phase::DIRECTION].counts[tools::perf_counters::INSTRUCTIONS] > 0;
+
+    BackendType::delete_if_dynamically_allocated(X0);
+    BackendType::delete_if_dynamically_allocated(S[0]);
+    BackendType::delete_if_dynamically_allocated(S[1]);
+    if(!ok){
+        std::cout << "  Fail! /* " << p[tag::phase::EVALUATION].n_calls << " evaluations profiled, for " << n_evaluations
+                  << ", in " << result.iteration << " iterations */" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+int main(){
+    int result = EXIT_SUCCESS;
+    std::cout << "Testing phase profiler..." << std::endl;
+    result |= test_profiler("BFGS", new quasi_newton<BackendType>(), new quasi_newton<BackendType>(), true);
+    result |= test_profiler("Truncated Newton", new truncated_newton<BackendType>(), new truncated_newton<BackendType>(), false);
+    return result;
+}
@@ -18,6 +18,9 @@ int main(){
     int result = EXIT_SUCCESS;
     typedef typename get_backend<double>::type BackendType;
     result |= test_option("BFGS [Double]", new quasi_newton<BackendType>());
+    result |= test_option("Factored BFGS [Double]", new factored_quasi_newton<BackendType>());
+    result |= test_option("Out-of-core BFGS [Double, T=3]", new out_of_core_quasi_newton<BackendType>("quasi-newton-test.tmp", 3, 2));
+    result |= test_option("Out-of-core BFGS [Double, T=256]", new out_of_core_quasi_newton<BackendType>("quasi-newton-test.tmp"));
 
     return result;
 
@@ -0,0 +1,111 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "stochastic-common.hpp"
+
+/** @brief Compares the sharded and the sequential evaluations, and checks that two sharded evaluations are bitwise identical */
+int test_wrapper(linear_regression const & fun, std::size_t n_shards){
+    std::size_t N = fun.N();
+    std::cout << "- Testing " << n_shards << " shards..." << std::flush;
+    VectorType x = BackendType::create_vector(N);
+    VectorType v = BackendType::create_vector(N);
+    for(std::size_t n = 0 ; n < N ; ++n){
+        x[n] = (ScalarType)rand()/RAND_MAX;
+        v[n] = (ScalarType)rand()/RAND_MAX;
+    }
+    VectorType g[3], Hv[3];
+    ScalarType val[3];
+    linear_regression & f = const_cast<linear_regression &>(fun);
+    detail::function_wrapper_impl<BackendType, linear_regression> reference(f,N,CENTERED_DIFFERENCE);
+    detail::function_wrapper_impl<BackendType, linear_regression> sharded(f,N,CENTERED_DIFFERENCE,n_shards);
+    value_gradient vgtag(STOCHASTIC,fun.dataset_size()-3,3);
+    hessian_vector_product hvtag(STOCHASTIC,fun.dataset_size()-3,3);
+    for(unsigned int k = 0 ; k < 3 ; ++k){
+        g[k] = BackendType::create_vector(N);
+        Hv[k] = BackendType::create_vector(N);
+        detail::function_wrapper<BackendType> & w = (k==0)?static_cast<detail::function_wrapper<BackendType>&>(reference):sharded;
+        w.compute_value_gradient(x,val[k],g[k],vgtag);
+        w.compute_hv_product(x,g[k],v,Hv[k],hvtag);
+    }
+
+    int result = EXIT_SUCCESS;
+    ScalarType diff = std::abs(val[1] - val[0])/std::abs(val[0]);
+    ScalarType hv_diff = 0;
+    for(std::size_t n = 0 ; n < N ; ++n){
+        diff = std::max(diff, std::abs(g[1][n] - g[0][n])/BackendType::nrm2(N,g[0]));
+        hv_diff = std::max(hv_diff, std::abs(Hv[1][n] - Hv[0][n])/BackendType::nrm2(N,Hv[0]));
+    }
+    //The finite differences amplify the rounding differences of the gradients
+    if(diff > 1e-12 || hv_diff > 1e-6){
+        std::cout << " Fail! /* Difference = " << diff << ", " << hv_diff << " */" << std::endl;
+        result = EXIT_FAILURE;
+    }
+    else if(val[1]!=val[2] || std::memcmp(g[1],g[2],N*sizeof(ScalarType)) || std::memcmp(Hv[1],Hv[2],N*sizeof(ScalarType))){
+        std::cout << " Fail! /* Not reproducible */" << std::endl;
+        result = EXIT_FAILURE;
+    }
+    else
+        std::cout << std::endl;
+
+    for(unsigned int k = 0 ; k < 3 ; ++k){
+        BackendType::delete_if_dynamically_allocated(g[k]);
+        BackendType::delete_if_dynamically_allocated(Hv[k]);
+    }
+    BackendType::delete_if_dynamically_allocated(x);
+    BackendType::delete_if_dynamically_allocated(v);
+    return result;
+}
+
+ScalarType minimize(linear_regression const & fun, VectorType S, std::size_t n_shards){
+    std::size_t N = fun.N();
+    VectorType X0 = BackendType::create_vector(N);
+    BackendType::set_to_value(X0,0,N);
+    umintl::minimizer<BackendType> minimizer(new quasi_newton<BackendType>(), new gradient_treshold<BackendType>(1e-8), 100);
+    minimizer.model = new mini_batch<BackendType>(fun.dataset_size(), fun.dataset_size(), true);
+    minimizer.n_shards = n_shards;
+    minimizer(S,fun,X0,N);
+    BackendType::delete_if_dynamically_allocated(X0);
+    return fun.error(S);
+}
+
+int test_minimizer(linear_regression const & fun, std::size_t n_shards){
+    std::size_t N = fun.N();
+    std::cout << "- Testing Quasi-Newton on " << n_shards << " shards..." << std::flush;
+    VectorType S1 = BackendType::create_vector(N);
+    VectorType S2 = BackendType::create_vector(N);
+    ScalarType error = minimize(fun,S1,n_shards);
+    minimize(fun,S2,n_shards);
+    bool identical = std::memcmp(S1,S2,N*sizeof(ScalarType))==0;
+    BackendType::delete_if_dynamically_allocated(S1);
+    BackendType::delete_if_dynamically_allocated(S2);
+    if(error > 1e-6){
+        std::cout << " Fail! /* Error = " << error << "*/" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if(!identical){
+        std::cout << " Fail! /* Not reproducible */" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << std::endl;
+    return EXIT_SUCCESS;
+}
+
+int main(){
+    srand(0);
+    int result = EXIT_SUCCESS;
+    linear_regression fun(10, 1000, 10);
+    std::cout << "Testing Sharded Evaluation..." << std::endl;
+    std::size_t shards[] = {2, 4, 7};
+    for(unsigned int k = 0 ; k < 3 ; ++k)
+        result |= test_wrapper(fun, shards[k]);
+    result |= test_minimizer(fun, 4);
+    return result;
+}
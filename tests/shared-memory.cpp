@@ -0,0 +1,73 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+#include <cstdlib>
+#include <iostream>
+
+#include "stochastic-common.hpp"
+#include "umintl/parallel/shared_memory.hpp"
+
+typedef shared_memory_function<BackendType, linear_regression> distributed_type;
+
+int test_evaluation(linear_regression & fun, distributed_type & distributed){
+    std::size_t N = fun.N();
+    std::cout << "- Testing evaluation on " << distributed.n_processes() << " processes..." << std::flush;
+    VectorType x = BackendType::create_vector(N);
+    VectorType g[2];
+    ScalarType val[2];
+    for(std::size_t n = 0 ; n < N ; ++n)
+        x[n] = (ScalarType)rand()/RAND_MAX;
+    for(unsigned int k = 0 ; k < 2 ; ++k)
+        g[k] = BackendType::create_vector(N);
+    fun(x,val[0],g[0],value_gradient(STOCHASTIC,503,17));
+    distributed(x,val[1],g[1],value_gradient(STOCHASTIC,503,17));
+    ScalarType diff = std::abs(val[1]-val[0])/std::abs(val[0]);
+    for(std::size_t n = 0 ; n < N ; ++n)
+        diff = std::max(diff, std::abs(g[1][n]-g[0][n])/BackendType::nrm2(N,g[0]));
+    for(unsigned int k = 0 ; k < 2 ; ++k)
+        BackendType::delete_if_dynamically_allocated(g[k]);
+    BackendType::delete_if_dynamically_allocated(x);
+    if(diff > 1e-12){
+        std::cout << " Fail! /* Difference = " << diff << " */" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << std::endl;
+    return EXIT_SUCCESS;
+}
+
+int test_minimizer(linear_regression & fun, distributed_type & distributed){
+    std::size_t N = fun.N();
+    std::cout << "- Testing Quasi-Newton on " << distributed.n_processes() << " processes..." << std::flush;
+    VectorType X0 = BackendType::create_vector(N);
+    VectorType S = BackendType::create_vector(N);
+    BackendType::set_to_value(X0,0,N);
+    umintl::minimizer<BackendType> minimizer(new quasi_newton<BackendType>(), new gradient_treshold<BackendType>(1e-8), 100);
+    minimizer(S,distributed,X0,N);
+    ScalarType error = fun.error(S);
+    BackendType::delete_if_dynamically_allocated(X0);
+    BackendType::delete_if_dynamically_allocated(S);
+    if(error > 1e-6){
+        std::cout << " Fail! /* Error = " << error << " */" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << std::endl;
+    return EXIT_SUCCESS;
+}
+
+int main(){
+    srand(0);
+    int result = EXIT_SUCCESS;
+    linear_regression fun(10, 1000, 10);
+    std::cout << "Testing Shared-Memory Evaluation..." << std::endl;
+    std::size_t processes[] = {1, 4};
+    for(unsigned int k = 0 ; k < 2 ; ++k){
+        distributed_type distributed(fun, fun.N(), fun.dataset_size(), processes[k]);
+        result |= test_evaluation(fun, distributed);
+        result |= test_minimizer(fun, distributed);
+    }
+    return result;
+}
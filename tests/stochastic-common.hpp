@@ -0,0 +1,129 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+#ifndef UMINTL_STOCHASTIC_COMMON_HPP_
+#define UMINTL_STOCHASTIC_COMMON_HPP_
+
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <iostream>
+
+#include "umintl/backends/cblas.hpp"
+#include "umintl/minimize.hpp"
+#include "umintl/tools/welford.hpp"
+
+using namespace umintl;
+
+typedef double ScalarType;
+typedef umintl::backend::cblas_types<ScalarType> BackendType;
+typedef BackendType::VectorType VectorType;
+
+/** @brief Expected loss f(x) = 1/S sum_{i in batch} (a_i'x - b_i)^2, on a synthetic consistent dataset b = A*x_star
+ *
+ *  The features are scaled geometrically from 1 to scaling, so that the condition number of the hessian grows like scaling^2
+ */
+class linear_regression{
+public:
+    linear_regression(std::size_t N, std::size_t dataset_size, ScalarType scaling = 1) : N_(N), D_(dataset_size), A_(N*dataset_size), b_(dataset_size), x_star_(N){
+        for(std::size_t n = 0 ; n < N_ ; ++n)
+            x_star_[n] = (ScalarType)rand()/RAND_MAX - 0.5;
+        for(std::size_t d = 0 ; d < D_ ; ++d){
+            b_[d] = 0;
+            for(std::size_t n = 0 ; n < N_ ; ++n){
+                A_[d*N_+n] = ((ScalarType)rand()/RAND_MAX - 0.5)*std::pow(scaling,(ScalarType)n/std::max(N_-1,(std::size_t)1));
+                b_[d] += A_[d*N_+n]*x_star_[n];
+            }
+        }
+    }
+
+    std::size_t N() const { return N_; }
+    std::size_t dataset_size() const { return D_; }
+
+    /** @brief Distance to the minimizer */
+    ScalarType error(VectorType const & x) const{
+        ScalarType res = 0;
+        for(std::size_t n = 0 ; n < N_ ; ++n)
+            res += (x[n] - x_star_[n])*(x[n] - x_star_[n]);
+        return std::sqrt(res);
+    }
+
+    void operator()(VectorType const & x, ScalarType & value, VectorType & gradient, umintl::value_gradient tag) const{
+        std::size_t offset = (tag.model==DETERMINISTIC)?0:tag.offset;
+        std::size_t S = (tag.model==DETERMINISTIC)?D_:tag.sample_size;
+        value = 0;
+        for(std::size_t n = 0 ; n < N_ ; ++n)
+            gradient[n] = 0;
+        for(std::size_t d = offset ; d < offset+S ; ++d){
+            ScalarType r = -b_[d];
+            for(std::size_t n = 0 ; n < N_ ; ++n)
+                r += A_[d*N_+n]*x[n];
+            value += r*r;
+            for(std::size_t n = 0 ; n < N_ ; ++n)
+                gradient[n] += 2*r*A_[d*N_+n];
+        }
+        value/=S;
+        for(std::size_t n = 0 ; n < N_ ; ++n)
+            gradient[n]/=S;
+    }
+
+    /** @brief Per-sample derivative of the loss with respect to the output of the model : 2(a_i'x - b_i), along with the value */
+    void operator()(VectorType const & x, ScalarType & value, VectorType & derivatives, umintl::sample_derivatives tag) const{
+        value = 0;
+        for(std::size_t k = 0 ; k < tag.sample_size ; ++k){
+            std::size_t d = tag.offset + k;
+            ScalarType r = -b_[d];
+            for(std::size_t n = 0 ; n < N_ ; ++n)
+                r += A_[d*N_+n]*x[n];
+            value += r*r;
+            derivatives[k] = 2*r;
+        }
+        value/=tag.sample_size;
+    }
+
+    /** @brief res = sum_k weights[k]*a_{offset+k} */
+    void operator()(VectorType const & weights, VectorType & res, umintl::sample_combination tag) const{
+        for(std::size_t n = 0 ; n < N_ ; ++n)
+            res[n] = 0;
+        for(std::size_t k = 0 ; k < tag.sample_size ; ++k)
+            for(std::size_t n = 0 ; n < N_ ; ++n)
+                res[n] += weights[k]*A_[(tag.offset+k)*N_+n];
+    }
+
+    /** @brief Variance of the per-sample gradients */
+    void operator()(VectorType const & x, VectorType & variance, umintl::gradient_variance tag) const{
+        VectorType mean = BackendType::create_vector(N_);
+        ScalarType value;
+        (*this)(x,value,mean,variance,umintl::value_gradient_variance(tag.model,tag.sample_size,tag.offset));
+        BackendType::delete_if_dynamically_allocated(mean);
+    }
+
+    /** @brief Value, gradient and gradient variance in a single pass over the samples */
+    void operator()(VectorType const & x, ScalarType & value, VectorType & gradient, VectorType & variance, umintl::value_gradient_variance tag) const{
+        tools::welford<ScalarType> acc(N_);
+        std::vector<ScalarType> g(N_);
+        for(std::size_t d = tag.offset ; d < tag.offset+tag.sample_size ; ++d){
+            ScalarType r = -b_[d];
+            for(std::size_t n = 0 ; n < N_ ; ++n)
+                r += A_[d*N_+n]*x[n];
+            for(std::size_t n = 0 ; n < N_ ; ++n)
+                g[n] = 2*r*A_[d*N_+n];
+            acc.add(r*r,&g[0]);
+        }
+        value = acc.value();
+        acc.get(gradient,variance);
+    }
+
+private:
+    std::size_t N_;
+    std::size_t D_;
+    std::vector<ScalarType> A_;
+    std::vector<ScalarType> b_;
+    std::vector<ScalarType> x_star_;
+};
+
+#endif
@@ -0,0 +1,51 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+#include <cstdlib>
+#include <iostream>
+
+#include "stochastic-common.hpp"
+
+int test(std::string const & name, linear_regression const & fun, umintl::direction<BackendType> * direction){
+    std::size_t N = fun.N();
+    std::size_t sample_size = 50;
+    unsigned int max_iter = 2000;
+    std::cout << "- Testing " << name << "..." << std::flush;
+
+    VectorType X0 = BackendType::create_vector(N);
+    VectorType S = BackendType::create_vector(N);
+    BackendType::set_to_value(X0,0,N);
+    umintl::minimizer<BackendType> minimizer(direction, new gradient_treshold<BackendType>(0), max_iter);
+    minimizer.model = new mini_batch<BackendType>(sample_size, fun.dataset_size(), true);
+    umintl::optimization_result result = minimizer(S,fun,X0,N);
+    ScalarType error = fun.error(S);
+    BackendType::delete_if_dynamically_allocated(X0);
+    BackendType::delete_if_dynamically_allocated(S);
+
+    //One evaluation per iteration, plus the initial one
+    if(result.n_functions_eval != max_iter + 1){
+        std::cout << " Fail! /* " << result.n_functions_eval << " evaluations */" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if(error > 1e-3){
+        std::cout << " Fail! /* Error = " << error << "*/" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << std::endl;
+    return EXIT_SUCCESS;
+}
+
+int main(){
+    srand(0);
+    int result = EXIT_SUCCESS;
+    linear_regression fun(10, 1000);
+    std::cout << "Testing Stochastic Gradient..." << std::endl;
+    result |= test("Momentum", fun, new stochastic_gradient<BackendType>(step_size(0.05), 0.9, tag::stochastic_gradient::MOMENTUM_CLASSICAL));
+    result |= test("Nesterov", fun, new stochastic_gradient<BackendType>(step_size(0.05), 0.9, tag::stochastic_gradient::MOMENTUM_NESTEROV));
+    result |= test("Adam", fun, new adam<BackendType>(step_size(0.02, tag::step_size::SCHEDULE_INVERSE_SQRT, 0.01)));
+    return result;
+}
@@ -0,0 +1,56 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+#include <cstdlib>
+#include <iostream>
+
+#include "stochastic-common.hpp"
+
+int test(linear_regression & fun, umintl::computation_type hessian_vector_product_computation, std::size_t N, unsigned int max_evaluations){
+    std::size_t sample_size = 50;
+    unsigned int L = 10;
+    unsigned int max_iter = 1000;
+
+    VectorType X0 = BackendType::create_vector(N);
+    VectorType S = BackendType::create_vector(N);
+    BackendType::set_to_value(X0,0,N);
+    umintl::minimizer<BackendType> minimizer(new stochastic_quasi_newton<BackendType>(step_size(0.3), step_size(1e-2), L, 10), new gradient_treshold<BackendType>(0), max_iter);
+    minimizer.model = new mini_batch<BackendType>(sample_size, fun.dataset_size(), true);
+    minimizer.hessian_vector_product_computation = hessian_vector_product_computation;
+    umintl::optimization_result result = minimizer(S,fun,X0,N);
+    ScalarType error = fun.error(S);
+    BackendType::delete_if_dynamically_allocated(X0);
+    BackendType::delete_if_dynamically_allocated(S);
+
+    if(result.n_functions_eval < max_iter + 1 || result.n_functions_eval > max_evaluations){
+        std::cout << " Fail! /* " << result.n_functions_eval << " evaluations */" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if(error > 1e-6){
+        std::cout << " Fail! /* Error = " << error << "*/" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << std::endl;
+    return EXIT_SUCCESS;
+}
+
+int main(){
+    int result = EXIT_SUCCESS;
+    srand(0);
+    std::size_t N = 10;
+    //Condition number of the hessian around 1e2 : out of reach of the stochastic gradient in that many iterations
+    linear_regression fun(N, 1000, 10);
+
+    std::cout << "Testing Stochastic Quasi-Newton..." << std::endl;
+    //One gradient evaluation per iteration. The curvature pairs only cost hessian-vector products.
+    std::cout << "- Testing Ill-conditioned linear regression..." << std::flush;
+    result |= test(fun, umintl::CENTERED_DIFFERENCE, N, 1001);
+    //The forward differences also need the gradient at the average of the window, once per curvature pair
+    std::cout << "- Testing Ill-conditioned linear regression, forward differences..." << std::flush;
+    result |= test(fun, umintl::FORWARD_DIFFERENCE, N, 1001 + 1000/10);
+    return result;
+}
@@ -42,8 +42,9 @@ struct get_backend{
 };
 
 
+/** @param max_iterations if not 0, the test also fails when the minimizer needs more iterations */
 template<class FunctionType, class BackendType>
-int test_function(FunctionType const & fun, umintl::minimizer<BackendType> & minimizer)
+int test_function(FunctionType const & fun, umintl::minimizer<BackendType> & minimizer, std::size_t max_iterations = 0)
 {
     typedef typename BackendType::ScalarType ScalarType;
     typedef typename BackendType::VectorType VectorType;
@@ -95,6 +96,10 @@ int test_function(FunctionType const & fun, umintl::minimizer<BackendType> & min
         }\
 
     }
+    else if(max_iterations && result.iteration > max_iterations){
+        std::cout << " Fail! /* " << result.iteration << " iterations */" << std::endl;
+        res = EXIT_FAILURE;
+    }
     else
         std::cout << std::endl;
 
@@ -58,6 +58,11 @@ int test_function(FunctionType const & fun, double eps=1e-6)
         std::cout << " Fail ! Diff = " << diff << "." << std::endl;
         return EXIT_FAILURE;
     }
+    umintl::gradient_check_result sampled = umintl::check_grad_sampled<BackendType>(fun,X0,N,eps,8,4);
+    if(sampled.max_error>1e-5){
+        std::cout << " Fail ! Sampled diff = " << sampled.max_error << " (median : " << sampled.median_error << ")." << std::endl;
+        return EXIT_FAILURE;
+    }
     else
         std::cout << std::endl;
     return EXIT_SUCCESS;
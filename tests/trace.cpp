@@ -0,0 +1,112 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+#include <cstdlib>
+#include <cstdio>
+#include <vector>
+#include <iostream>
+
+#include "test-common.hpp"
+
+typedef get_backend<double>::type BackendType;
+typedef BackendType::VectorType VectorType;
+typedef BackendType::ScalarType ScalarType;
+
+static const char * filename = "trace-test.trace";
+
+/** @brief Keeps the iterations in memory, to be compared with the trace */
+struct reference : public observer<BackendType>{
+    bool operator()(iteration_info<BackendType> const & info){
+        values.push_back(info.value);
+        alphas.push_back(info.alpha);
+        n_line_search_evaluations.push_back(info.phases.n_line_search_evaluations);
+        n_value_computations.push_back(info.n_value_computations);
+        return false;
+    }
+    std::vector<ScalarType> values;
+    std::vector<ScalarType> alphas;
+    std::vector<unsigned int> n_line_search_evaluations;
+    std::vector<unsigned int> n_value_computations;
+};
+
+/** @brief Records a run with a ring of capacity records, and compares the trace with the iterations
+ *
+ *  The trace holds the state at the beginning of each iteration, and the final state, which must match the result.
+ */
+int test_trace(std::string const & name, direction<BackendType> * direction, std::size_t capacity, unsigned int max_iter = 1000){
+    std::cout << "- Testing " << name << "..." << std::flush;
+    rosenbrock<BackendType> fun(20);
+    std::size_t N = fun.N();
+    VectorType X0 = BackendType::create_vector(N);
+    VectorType S = BackendType::create_vector(N);
+    fun.init(X0);
+    std::remove(filename);
+    minimizer<BackendType> minimizer(direction, new gradient_treshold<BackendType>(1e-8), max_iter);
+    reference * r = new reference();
+    minimizer.add_observer(r);
+    minimizer.add_observer(new trace_recorder<BackendType>(filename, capacity));
+    optimization_result result = minimizer(S,fun,X0,N);
+    BackendType::delete_if_dynamically_allocated(X0);
+    BackendType::delete_if_dynamically_allocated(S);
+
+    std::vector<trace_record> records;
+    load_trace(filename, records);
+    std::remove(filename);
+    //The iteration which meets the stopping criterion is complete, but not counted in result.iteration
+    unsigned int n_iterations = result.iteration + (result.termination_cause==optimization_result::STOPPING_CRITERION);
+    bool ok = records.size()==n_iterations+1 && records.size()==r->values.size()
+           && records.back().value==result.f && records.back().n_value_computations==result.n_functions_eval
+           && records.back().n_line_search_evaluations > 0;
+    for(std::size_t k = 0 ; ok && k < records.size() ; ++k){
+        trace_record const & t = records[k];
+        ok = t.iter==k && t.value==r->values[k] && t.alpha==r->alphas[k]
+          && t.n_line_search_evaluations==r->n_line_search_evaluations[k] && t.n_value_computations==r->n_value_computations[k]
+          && t.direction_time >= 0 && t.line_search_time >= 0 && t.model_time >= 0
+          && (k==0 || (t.n_value_computations - records[k-1].n_value_computations >= t.n_line_search_evaluations
+                       && t.elapsed_time >= records[k-1].elapsed_time + t.direction_time + t.line_search_time));
+    }
+    if(!ok){
+        std::cout << " Fail! /* " << records.size() << " records for " << result.iteration << " iterations */" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << " " << records.size() << " records" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+/** @brief A file which is not a trace is rejected */
+int test_invalid(){
+    std::cout << "- Testing invalid trace..." << std::flush;
+    FILE * file = std::fopen(filename, "wb");
+    std::fputs("not a trace", file);
+    std::fclose(file);
+    bool thrown = false;
+    std::vector<trace_record> records;
+    try{
+        load_trace(filename, records);
+    }
+    catch(exceptions::io_error const &){
+        thrown = true;
+    }
+    std::remove(filename);
+    if(!thrown){
+        std::cout << " Fail! /* The file was accepted */" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << std::endl;
+    return EXIT_SUCCESS;
+}
+
+int main(){
+    int result = EXIT_SUCCESS;
+    std::cout << "Testing trace recorder..." << std::endl;
+    result |= test_trace("BFGS", new quasi_newton<BackendType>(), 1024);
+    result |= test_trace("BFGS with a small ring", new quasi_newton<BackendType>(), 3);
+    result |= test_trace("Nonlinear CG with a small ring", new conjugate_gradient<BackendType>(), 2);
+    result |= test_trace("BFGS stopped by the maximum number of iterations", new quasi_newton<BackendType>(), 1024, 5);
+    result |= test_invalid();
+    return result;
+}
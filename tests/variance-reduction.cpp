@@ -0,0 +1,80 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+#include <cstdlib>
+#include <iostream>
+
+#include "stochastic-common.hpp"
+
+int test(std::string const & name, linear_regression const & fun, umintl::direction<BackendType> * direction, VectorType & S, unsigned int evaluations_per_iteration = 0){
+    std::size_t N = fun.N();
+    std::size_t sample_size = 10;
+    unsigned int max_iter = 3000;
+    std::cout << "- Testing " << name << "..." << std::flush;
+
+    VectorType X0 = BackendType::create_vector(N);
+    BackendType::set_to_value(X0,0,N);
+    umintl::minimizer<BackendType> minimizer(direction, new gradient_treshold<BackendType>(0), max_iter);
+    minimizer.model = new mini_batch<BackendType>(sample_size, fun.dataset_size(), true);
+    umintl::optimization_result result = minimizer(S,fun,X0,N);
+    ScalarType error = fun.error(S);
+    BackendType::delete_if_dynamically_allocated(X0);
+
+    //The mini-batch value and gradient are derived from the evaluations the direction needs
+    if(evaluations_per_iteration && result.n_functions_eval != evaluations_per_iteration*(max_iter+1)){
+        std::cout << " Fail! /* " << result.n_functions_eval << " evaluations */" << std::endl;
+        return EXIT_FAILURE;
+    }
+    //Linear convergence to the minimizer
+    if(error > 1e-8){
+        std::cout << " Fail! /* Error = " << error << "*/" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << std::endl;
+    return EXIT_SUCCESS;
+}
+
+int main(){
+    srand(0);
+    int result = EXIT_SUCCESS;
+    std::size_t N = 10;
+    std::size_t dataset_size = 500;
+    linear_regression fun(N, dataset_size);
+    VectorType S1 = BackendType::create_vector(N);
+    VectorType S2 = BackendType::create_vector(N);
+    VectorType S3 = BackendType::create_vector(N);
+
+    std::cout << "Testing Variance Reduction..." << std::endl;
+    result |= test("SVRG", fun, new svrg<BackendType>(step_size(0.1), dataset_size, 2*dataset_size/10), S1);
+    result |= test("SAGA [Gradients]", fun, new saga<BackendType>(step_size(0.1), dataset_size, tag::saga::STORE_GRADIENTS), S2, 10);
+    result |= test("SAGA [Linear derivatives]", fun, new saga<BackendType>(step_size(0.1), dataset_size, tag::saga::STORE_LINEAR_DERIVATIVES), S3, 1);
+
+    //Both SAGA storages represent the same table
+    BackendType::axpy(N,-1,S2,S3);
+    if(BackendType::nrm2(N,S3) > 1e-12){
+        std::cout << "SAGA storages mismatch : " << BackendType::nrm2(N,S3) << std::endl;
+        result = EXIT_FAILURE;
+    }
+
+    //A null update frequency would never take a snapshot
+    bool thrown = false;
+    try{
+        svrg<BackendType> invalid(step_size(0.1), dataset_size, 0);
+    }
+    catch(exceptions::incompatible_parameters const &){
+        thrown = true;
+    }
+    if(!thrown){
+        std::cout << "SVRG accepted a null update frequency" << std::endl;
+        result = EXIT_FAILURE;
+    }
+
+    BackendType::delete_if_dynamically_allocated(S1);
+    BackendType::delete_if_dynamically_allocated(S2);
+    BackendType::delete_if_dynamically_allocated(S3);
+    return result;
+}
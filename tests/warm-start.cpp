@@ -0,0 +1,76 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+#include <cstdlib>
+#include <iostream>
+
+#include "stochastic-common.hpp"
+
+/** @brief Least-square fit on a window of the dataset */
+struct rolling_window{
+    rolling_window(linear_regression const & fun, std::size_t size) : fun_(fun), size_(size), offset(0){ }
+    void operator()(VectorType const & x, ScalarType & value, VectorType & gradient, umintl::value_gradient) const{
+        fun_(x,value,gradient,umintl::value_gradient(STOCHASTIC,size_,offset));
+    }
+private:
+    linear_regression const & fun_;
+    std::size_t size_;
+public:
+    std::size_t offset;
+};
+
+/** @brief Total number of iterations of a sequence of refits on rolling windows, each starting from 0 */
+unsigned int refit(minimizer<BackendType> & minimizer, linear_regression const & fun, std::size_t n_refits, ScalarType & error){
+    std::size_t N = fun.N();
+    rolling_window window(fun, fun.dataset_size()/2);
+    VectorType X0 = BackendType::create_vector(N);
+    VectorType S = BackendType::create_vector(N);
+    BackendType::set_to_value(X0,0,N);
+    unsigned int iterations = 0;
+    error = 0;
+    for(std::size_t k = 0 ; k < n_refits ; ++k){
+        window.offset = k*fun.dataset_size()/(2*n_refits);
+        iterations += minimizer(S,window,X0,N).iteration;
+        error = std::max(error, fun.error(S));
+    }
+    BackendType::delete_if_dynamically_allocated(X0);
+    BackendType::delete_if_dynamically_allocated(S);
+    return iterations;
+}
+
+int test_warm_start(std::string const & name, direction<BackendType> * cold_direction, direction<BackendType> * warm_direction, linear_regression const & fun){
+    std::cout << "- Testing " << name << "..." << std::flush;
+    std::size_t n_refits = 5;
+    minimizer<BackendType> cold(cold_direction, new gradient_treshold<BackendType>(1e-8), 1000);
+    minimizer<BackendType> warm(warm_direction, new gradient_treshold<BackendType>(1e-8), 1000);
+    warm.warm_start = true;
+    ScalarType cold_error, warm_error;
+    unsigned int cold_iterations = refit(cold, fun, n_refits, cold_error);
+    unsigned int warm_iterations = refit(warm, fun, n_refits, warm_error);
+    if(std::max(cold_error, warm_error) > 1e-4){
+        std::cout << " Fail! /* Error = " << std::max(cold_error, warm_error) << " */" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if(warm_iterations >= cold_iterations){
+        std::cout << " Fail! /* " << warm_iterations << " iterations, against " << cold_iterations << " without warm start */" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << " " << warm_iterations << " iterations, against " << cold_iterations << " without warm start" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+int main(){
+    srand(0);
+    int result = EXIT_SUCCESS;
+    linear_regression fun(20, 2000, 10);
+    std::cout << "Testing warm start on rolling windows..." << std::endl;
+    result |= test_warm_start("BFGS", new quasi_newton<BackendType>(), new quasi_newton<BackendType>(), fun);
+    result |= test_warm_start("L-BFGS", new low_memory_quasi_newton<BackendType>(16), new low_memory_quasi_newton<BackendType>(16), fun);
+    result |= test_warm_start("Vector-free L-BFGS", new vector_free_low_memory_quasi_newton<BackendType>(16), new vector_free_low_memory_quasi_newton<BackendType>(16), fun);
+    result |= test_warm_start("Out-of-core BFGS", new out_of_core_quasi_newton<BackendType>("warm-start-test.tmp", 8), new out_of_core_quasi_newton<BackendType>("warm-start-test.tmp", 8), fun);
+    return result;
+}
@@ -50,6 +50,8 @@ namespace umintl{
         { return cblas_snrm2(N,x,1); }
         static ScalarType dot(std::size_t N, VectorType const & x, VectorType const & y)
         { return cblas_dsdot(N,x,1,y,1); }
+        static void dots(std::size_t N, std::size_t K, VectorType const * const * x, VectorType const * const * y, ScalarType * res)
+        { for(std::size_t k = 0 ; k < K ; ++k) res[k] = dot(N,*x[k],*y[k]); }
         static void symv(std::size_t N, ScalarType alpha, MatrixType const& A, VectorType const & x, ScalarType beta, VectorType & y)
         { cblas_ssymv(CblasRowMajor,CblasUpper,N,alpha,A,N,x,1,beta,y,1);  }
         static void gemv(std::size_t M, std::size_t N, ScalarType alpha, MatrixType const& A, VectorType const & x, ScalarType beta, VectorType & y)
@@ -58,6 +60,21 @@ namespace umintl{
         { cblas_ssyr(CblasRowMajor,CblasUpper,N,alpha,x,1,A,N); }
         static void syr2(std::size_t N, ScalarType const & alpha, VectorType const & x, VectorType const & y, MatrixType & A)
         { cblas_ssyr2(CblasRowMajor,CblasUpper,N,alpha,x,1,y,1,A,N); }
+        //Packed symmetric storage : the upper triangle of the NxN matrix A, row by row, in a vector of N(N+1)/2 elements
+        static void spmv(std::size_t N, ScalarType alpha, VectorType const & A, VectorType const & x, ScalarType beta, VectorType & y)
+        { cblas_sspmv(CblasRowMajor,CblasUpper,N,alpha,A,x,1,beta,y,1); }
+        static void spr1(std::size_t N, ScalarType const & alpha, VectorType const & x, VectorType & A)
+        { cblas_sspr(CblasRowMajor,CblasUpper,N,alpha,x,1,A); }
+        static void spr2(std::size_t N, ScalarType const & alpha, VectorType const & x, VectorType const & y, VectorType & A)
+        { cblas_sspr2(CblasRowMajor,CblasUpper,N,alpha,x,1,y,1,A); }
+        //Triangular packed storage : the upper triangular NxN matrix A, row by row. x = op(A)*x, and x = inv(op(A))*x
+        static void tpmv(std::size_t N, bool transpose, VectorType const & A, VectorType & x)
+        { cblas_stpmv(CblasRowMajor,CblasUpper,transpose?CblasTrans:CblasNoTrans,CblasNonUnit,N,A,x,1); }
+        static void tpsv(std::size_t N, bool transpose, VectorType const & A, VectorType & x)
+        { cblas_stpsv(CblasRowMajor,CblasUpper,transpose?CblasTrans:CblasNoTrans,CblasNonUnit,N,A,x,1); }
+        //Givens rotation of the N elements of x and y starting at offx and offy : (x, y) <- (c*x + s*y, c*y - s*x)
+        static void rot(std::size_t N, VectorType & x, std::size_t offx, VectorType & y, std::size_t offy, ScalarType c, ScalarType s)
+        { cblas_srot(N,x+offx,1,y+offy,1,c,s); }
         static void set_to_value(VectorType & V, ScalarType val, std::size_t N)
         { std::memset(V, val, sizeof(ScalarType)*N); }
         static void set_to_diagonal(std::size_t N, MatrixType & A, ScalarType lambda) {
@@ -66,6 +83,11 @@ namespace umintl{
                 A[i*N+i] = lambda;
             }
         }
+        static void set_to_diagonal_packed(std::size_t N, VectorType & A, ScalarType lambda) {
+            std::memset(A,0,N*(N+1)/2*sizeof(ScalarType));
+            for(std::size_t i = 0, k = 0 ; i < N ; k += N-i, ++i)
+                A[k] = lambda;
+        }
     };
 
 
@@ -96,6 +118,8 @@ namespace umintl{
         { return cblas_dnrm2(N,x,1); }
         static ScalarType dot(std::size_t N, VectorType const & x, VectorType const & y)
         { return cblas_ddot(N,x,1,y,1); }
+        static void dots(std::size_t N, std::size_t K, VectorType const * const * x, VectorType const * const * y, ScalarType * res)
+        { for(std::size_t k = 0 ; k < K ; ++k) res[k] = dot(N,*x[k],*y[k]); }
         static void symv(std::size_t N, ScalarType alpha, MatrixType const& A, VectorType const & x, ScalarType beta, VectorType & y)
         { cblas_dsymv(CblasRowMajor,CblasUpper,N,alpha,A,N,x,1,beta,y,1);  }
         static void gemv(std::size_t M, std::size_t N, ScalarType alpha, MatrixType const& A, VectorType const & x, ScalarType beta, VectorType & y)
@@ -104,6 +128,20 @@ namespace umintl{
         { cblas_dsyr(CblasRowMajor,CblasUpper,N,alpha,x,1,A,N); }
         static void syr2(std::size_t N, ScalarType const & alpha, VectorType const & x, VectorType const & y, MatrixType & A)
         { cblas_dsyr2(CblasRowMajor,CblasUpper,N,alpha,x,1,y,1,A,N); }
+        //Packed symmetric storage
+        static void spmv(std::size_t N, ScalarType alpha, VectorType const & A, VectorType const & x, ScalarType beta, VectorType & y)
+        { cblas_dspmv(CblasRowMajor,CblasUpper,N,alpha,A,x,1,beta,y,1); }
+        static void spr1(std::size_t N, ScalarType const & alpha, VectorType const & x, VectorType & A)
+        { cblas_dspr(CblasRowMajor,CblasUpper,N,alpha,x,1,A); }
+        static void spr2(std::size_t N, ScalarType const & alpha, VectorType const & x, VectorType const & y, VectorType & A)
+        { cblas_dspr2(CblasRowMajor,CblasUpper,N,alpha,x,1,y,1,A); }
+        //Triangular packed storage
+        static void tpmv(std::size_t N, bool transpose, VectorType const & A, VectorType & x)
+        { cblas_dtpmv(CblasRowMajor,CblasUpper,transpose?CblasTrans:CblasNoTrans,CblasNonUnit,N,A,x,1); }
+        static void tpsv(std::size_t N, bool transpose, VectorType const & A, VectorType & x)
+        { cblas_dtpsv(CblasRowMajor,CblasUpper,transpose?CblasTrans:CblasNoTrans,CblasNonUnit,N,A,x,1); }
+        static void rot(std::size_t N, VectorType & x, std::size_t offx, VectorType & y, std::size_t offy, ScalarType c, ScalarType s)
+        { cblas_drot(N,x+offx,1,y+offy,1,c,s); }
         static void set_to_value(VectorType & V, ScalarType val, std::size_t N)
         { std::memset(V, val, sizeof(ScalarType)*N); }
         static void set_to_diagonal(std::size_t N, MatrixType & A, ScalarType lambda) {
@@ -112,6 +150,11 @@ namespace umintl{
                 A[i*N+i] = lambda;
             }
         }
+        static void set_to_diagonal_packed(std::size_t N, VectorType & A, ScalarType lambda) {
+            std::memset(A,0,N*(N+1)/2*sizeof(ScalarType));
+            for(std::size_t i = 0, k = 0 ; i < N ; k += N-i, ++i)
+                A[k] = lambda;
+        }
     };
 
 
@@ -33,8 +33,9 @@ namespace umintl{
 
         static void copy(std::size_t /*N*/, VectorType const & from, VectorType & to)
         { to = from; }
-        static void axpy(std::size_t /*N*/, ScalarType alpha, VectorType const & x, VectorType & y)
-        {  y = alpha*x + y; }
+        //As with the BLAS, only the N first elements of y are updated, so that y can be longer than x
+        static void axpy(std::size_t N, ScalarType alpha, VectorType const & x, VectorType & y)
+        {  y.head(N) += alpha*x.head(N); }
         static void scale(std::size_t /*N*/, ScalarType alpha, VectorType & x)
         { x = alpha*x; }
         static void scale(std::size_t /*M*/, std::size_t /*N*/, ScalarType alpha, MatrixType & A)
@@ -45,6 +46,8 @@ namespace umintl{
         { return x.norm(); }
         static ScalarType dot(std::size_t /*N*/, VectorType const & x, VectorType const & y)
         { return x.dot(y); }
+        static void dots(std::size_t N, std::size_t K, VectorType const * const * x, VectorType const * const * y, ScalarType * res)
+        { for(std::size_t k = 0 ; k < K ; ++k) res[k] = dot(N,*x[k],*y[k]); }
         static void symv(std::size_t /*N*/, ScalarType alpha, MatrixType const& A, VectorType const & x, ScalarType beta, VectorType & y)
         { y = alpha*A*x + beta*y;  }
         static void gemv(std::size_t /*M*/, std::size_t /*N*/, ScalarType alpha, MatrixType const& A, VectorType const & x, ScalarType beta, VectorType & y)
@@ -53,8 +56,77 @@ namespace umintl{
         { A+=alpha*x*x.transpose(); }
         static void syr2(std::size_t /*N*/, ScalarType const & alpha, VectorType const & x, VectorType const & y, MatrixType & A)
         { A+=alpha*x*y.transpose() + alpha*y*x.transpose(); }
+        //Packed symmetric storage, as in cblas_types. Processed row by row, since Eigen has no packed matrices
+        static void spmv(std::size_t N, ScalarType alpha, VectorType const & A, VectorType const & x, ScalarType beta, VectorType & y)
+        {
+            VectorType Ax = VectorType::Zero(N);
+            for(std::size_t i = 0, k = 0 ; i < N ; k += N-i, ++i){
+                Ax[i] += A.segment(k,N-i).dot(x.segment(i,N-i));
+                Ax.segment(i+1,N-i-1) += x[i]*A.segment(k+1,N-i-1);
+            }
+            if(beta==0)
+                y = alpha*Ax;
+            else
+                y = alpha*Ax + beta*y;
+        }
+        static void spr1(std::size_t N, ScalarType const & alpha, VectorType const & x, VectorType & A)
+        {
+            for(std::size_t i = 0, k = 0 ; i < N ; k += N-i, ++i)
+                A.segment(k,N-i) += (alpha*x[i])*x.segment(i,N-i);
+        }
+        static void spr2(std::size_t N, ScalarType const & alpha, VectorType const & x, VectorType const & y, VectorType & A)
+        {
+            for(std::size_t i = 0, k = 0 ; i < N ; k += N-i, ++i)
+                A.segment(k,N-i) += (alpha*x[i])*y.segment(i,N-i) + (alpha*y[i])*x.segment(i,N-i);
+        }
+        //Triangular packed storage, as in cblas_types
+        static void tpmv(std::size_t N, bool transpose, VectorType const & A, VectorType & x)
+        {
+            if(transpose){
+                for(std::size_t i = N, k = N*(N+1)/2 ; i-- > 0 ; ){
+                    k -= N-i;
+                    x.segment(i+1,N-i-1) += x[i]*A.segment(k+1,N-i-1);
+                    x[i] *= A[k];
+                }
+            }
+            else{
+                for(std::size_t i = 0, k = 0 ; i < N ; k += N-i, ++i)
+                    x[i] = A.segment(k,N-i).dot(x.segment(i,N-i));
+            }
+        }
+        static void tpsv(std::size_t N, bool transpose, VectorType const & A, VectorType & x)
+        {
+            if(transpose){
+                for(std::size_t i = 0, k = 0 ; i < N ; k += N-i, ++i){
+                    x[i] /= A[k];
+                    x.segment(i+1,N-i-1) -= x[i]*A.segment(k+1,N-i-1);
+                }
+            }
+            else{
+                for(std::size_t i = N, k = N*(N+1)/2 ; i-- > 0 ; ){
+                    k -= N-i;
+                    x[i] = (x[i] - A.segment(k+1,N-i-1).dot(x.segment(i+1,N-i-1)))/A[k];
+                }
+            }
+        }
+        static void rot(std::size_t N, VectorType & x, std::size_t offx, VectorType & y, std::size_t offy, ScalarType c, ScalarType s)
+        {
+            ScalarType * px = x.data() + offx;
+            ScalarType * py = y.data() + offy;
+            for(std::size_t i = 0 ; i < N ; ++i){
+                ScalarType xi = px[i], yi = py[i];
+                px[i] = c*xi + s*yi;
+                py[i] = c*yi - s*xi;
+            }
+        }
         static void set_to_diagonal(std::size_t N, MatrixType & A, ScalarType lambda)
         { A = lambda*MatrixType::Identity(N, N); }
+        static void set_to_diagonal_packed(std::size_t N, VectorType & A, ScalarType lambda)
+        {
+            A = VectorType::Zero(N*(N+1)/2);
+            for(std::size_t i = 0, k = 0 ; i < N ; k += N-i, ++i)
+                A[k] = lambda;
+        }
         static void set_to_value(VectorType & V, ScalarType val, std::size_t N)
         { V = VectorType::Constant(N,val); }
     };
@@ -19,6 +19,9 @@ namespace umintl{
 
     static const char Upper = 'U';
     static const char Lower = 'L';
+    static const char Trans = 'T';
+    static const char NoTrans = 'N';
+    static const char NonUnit = 'N';
     static const std::ptrdiff_t one_inc = 1;
 
     template<class _ScalarType>
@@ -56,20 +59,43 @@ namespace umintl{
         { return FORTRAN_WRAPPER(snrm2)(&N,(vec_ref)x,(size_t*)&one_inc); }
         static ScalarType dot(size_t N, VectorType const & x, VectorType const & y)
         { return FORTRAN_WRAPPER(sdot)(&N,(vec_ref)x,(size_t*)&one_inc,(vec_ref)y,(size_t*)&one_inc); }
+        static void dots(size_t N, size_t K, VectorType const * const * x, VectorType const * const * y, ScalarType * res)
+        { for(size_t k = 0 ; k < K ; ++k) res[k] = dot(N,*x[k],*y[k]); }
         static void symv(size_t N, ScalarType alpha, MatrixType const& A, VectorType const & x, ScalarType beta, VectorType & y)
         { FORTRAN_WRAPPER(ssymv)((char*)&Lower,&N,&alpha,A,&N,(vec_ref)x,(size_t*)&one_inc,&beta,y,(size_t*)&one_inc);  }
+        static void gemv(size_t M, size_t N, ScalarType alpha, MatrixType const& A, VectorType const & x, ScalarType beta, VectorType & y)
+        { FORTRAN_WRAPPER(sgemv)((char*)&Trans,&N,&M,&alpha,A,&N,(vec_ref)x,(size_t*)&one_inc,&beta,y,(size_t*)&one_inc);  }
         static void syr1(size_t N, ScalarType alpha, VectorType const & x, MatrixType & A)
         { FORTRAN_WRAPPER(ssyr)((char*)&Lower,&N,&alpha,(vec_ref)x,(size_t*)&one_inc,A,&N); }
         static void syr2(size_t N, ScalarType  alpha, VectorType const & x, VectorType const & y, MatrixType & A)
         { FORTRAN_WRAPPER(ssyr2)((char*)&Lower,&N,&alpha,(vec_ref)x,(size_t*)&one_inc,(vec_ref)y,(size_t*)&one_inc,A,&N); }
+        //Packed symmetric storage, as in cblas_types. The upper triangle packed by rows is the lower triangle packed by columns
+        static void spmv(size_t N, ScalarType alpha, VectorType const & A, VectorType const & x, ScalarType beta, VectorType & y)
+        { FORTRAN_WRAPPER(sspmv)((char*)&Lower,&N,&alpha,(vec_ref)A,(vec_ref)x,(size_t*)&one_inc,&beta,y,(size_t*)&one_inc); }
+        static void spr1(size_t N, ScalarType alpha, VectorType const & x, VectorType & A)
+        { FORTRAN_WRAPPER(sspr)((char*)&Lower,&N,&alpha,(vec_ref)x,(size_t*)&one_inc,A); }
+        static void spr2(size_t N, ScalarType alpha, VectorType const & x, VectorType const & y, VectorType & A)
+        { FORTRAN_WRAPPER(sspr2)((char*)&Lower,&N,&alpha,(vec_ref)x,(size_t*)&one_inc,(vec_ref)y,(size_t*)&one_inc,A); }
+        //Triangular packed storage, as in cblas_types. The upper triangle by rows is the transpose of the lower triangle by columns
+        static void tpmv(size_t N, bool transpose, VectorType const & A, VectorType & x)
+        { FORTRAN_WRAPPER(stpmv)((char*)&Lower,(char*)(transpose?&NoTrans:&Trans),(char*)&NonUnit,&N,(vec_ref)A,x,(size_t*)&one_inc); }
+        static void tpsv(size_t N, bool transpose, VectorType const & A, VectorType & x)
+        { FORTRAN_WRAPPER(stpsv)((char*)&Lower,(char*)(transpose?&NoTrans:&Trans),(char*)&NonUnit,&N,(vec_ref)A,x,(size_t*)&one_inc); }
+        static void rot(size_t N, VectorType & x, size_t offx, VectorType & y, size_t offy, ScalarType c, ScalarType s)
+        { VectorType px = x+offx, py = y+offy; FORTRAN_WRAPPER(srot)(&N,px,(size_t*)&one_inc,py,(size_t*)&one_inc,&c,&s); }
         static void set_to_value(VectorType & V, ScalarType val, size_t N)
-        { std::memset(V, val, sizeof(ScalarType)*N); }
+        { for(size_t i = 0 ; i < N ; ++i) V[i] = val; }
         static void set_to_diagonal(size_t N, MatrixType & A, ScalarType lambda) {
             std::memset(A,0,N*N*sizeof(ScalarType));
             for(size_t i = 0 ; i < N ; ++i){
                 A[i*N+i] = lambda;
             }
         }
+        static void set_to_diagonal_packed(size_t N, VectorType & A, ScalarType lambda) {
+            std::memset(A,0,N*(N+1)/2*sizeof(ScalarType));
+            for(size_t i = 0, k = 0 ; i < N ; k += N-i, ++i)
+                A[k] = lambda;
+        }
     };
 
 
@@ -106,20 +132,43 @@ namespace umintl{
         { return FORTRAN_WRAPPER(dnrm2)(&N,(vec_ref)x,(size_t*)&one_inc); }
         static ScalarType dot(size_t N, VectorType const & x, VectorType const & y)
         { return FORTRAN_WRAPPER(ddot)(&N,(vec_ref)x,(size_t*)&one_inc,(vec_ref)y,(size_t*)&one_inc); }
+        static void dots(size_t N, size_t K, VectorType const * const * x, VectorType const * const * y, ScalarType * res)
+        { for(size_t k = 0 ; k < K ; ++k) res[k] = dot(N,*x[k],*y[k]); }
         static void symv(size_t N, ScalarType alpha, MatrixType const& A, VectorType const & x, ScalarType beta, VectorType & y)
         { FORTRAN_WRAPPER(dsymv)((char*)&Lower,&N,&alpha,A,&N,(vec_ref)x,(size_t*)&one_inc,&beta,y,(size_t*)&one_inc);  }
+        static void gemv(size_t M, size_t N, ScalarType alpha, MatrixType const& A, VectorType const & x, ScalarType beta, VectorType & y)
+        { FORTRAN_WRAPPER(dgemv)((char*)&Trans,&N,&M,&alpha,A,&N,(vec_ref)x,(size_t*)&one_inc,&beta,y,(size_t*)&one_inc);  }
         static void syr1(size_t N, ScalarType alpha, VectorType const & x, MatrixType & A)
         { FORTRAN_WRAPPER(dsyr)((char*)&Lower,&N,&alpha,(vec_ref)x,(size_t*)&one_inc,A,&N); }
         static void syr2(size_t N, ScalarType  alpha, VectorType const & x, VectorType const & y, MatrixType & A)
         { FORTRAN_WRAPPER(dsyr2)((char*)&Lower,&N,&alpha,(vec_ref)x,(size_t*)&one_inc,(vec_ref)y,(size_t*)&one_inc,A,&N); }
+        //Packed symmetric storage
+        static void spmv(size_t N, ScalarType alpha, VectorType const & A, VectorType const & x, ScalarType beta, VectorType & y)
+        { FORTRAN_WRAPPER(dspmv)((char*)&Lower,&N,&alpha,(vec_ref)A,(vec_ref)x,(size_t*)&one_inc,&beta,y,(size_t*)&one_inc); }
+        static void spr1(size_t N, ScalarType alpha, VectorType const & x, VectorType & A)
+        { FORTRAN_WRAPPER(dspr)((char*)&Lower,&N,&alpha,(vec_ref)x,(size_t*)&one_inc,A); }
+        static void spr2(size_t N, ScalarType alpha, VectorType const & x, VectorType const & y, VectorType & A)
+        { FORTRAN_WRAPPER(dspr2)((char*)&Lower,&N,&alpha,(vec_ref)x,(size_t*)&one_inc,(vec_ref)y,(size_t*)&one_inc,A); }
+        //Triangular packed storage
+        static void tpmv(size_t N, bool transpose, VectorType const & A, VectorType & x)
+        { FORTRAN_WRAPPER(dtpmv)((char*)&Lower,(char*)(transpose?&NoTrans:&Trans),(char*)&NonUnit,&N,(vec_ref)A,x,(size_t*)&one_inc); }
+        static void tpsv(size_t N, bool transpose, VectorType const & A, VectorType & x)
+        { FORTRAN_WRAPPER(dtpsv)((char*)&Lower,(char*)(transpose?&NoTrans:&Trans),(char*)&NonUnit,&N,(vec_ref)A,x,(size_t*)&one_inc); }
+        static void rot(size_t N, VectorType & x, size_t offx, VectorType & y, size_t offy, ScalarType c, ScalarType s)
+        { VectorType px = x+offx, py = y+offy; FORTRAN_WRAPPER(drot)(&N,px,(size_t*)&one_inc,py,(size_t*)&one_inc,&c,&s); }
         static void set_to_value(VectorType & V, ScalarType val, size_t N)
-        { std::memset(V, val, sizeof(ScalarType)*N); }
+        { for(size_t i = 0 ; i < N ; ++i) V[i] = val; }
         static void set_to_diagonal(size_t N, MatrixType & A, ScalarType lambda) {
             std::memset(A,0,N*N*sizeof(ScalarType));
             for(size_t i = 0 ; i < N ; ++i){
                 A[i*N+i] = lambda;
             }
         }
+        static void set_to_diagonal_packed(size_t N, VectorType & A, ScalarType lambda) {
+            std::memset(A,0,N*(N+1)/2*sizeof(ScalarType));
+            for(size_t i = 0, k = 0 ; i < N ; k += N-i, ++i)
+                A[k] = lambda;
+        }
     };
 
 
@@ -0,0 +1,113 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+#ifndef UMINTL_BACKENDS_MPI_HPP
+#define UMINTL_BACKENDS_MPI_HPP
+
+#include <cmath>
+#include <algorithm>
+
+#include <mpi.h>
+
+#include "umintl/backends/cblas.hpp"
+
+namespace umintl{
+
+  namespace backend{
+
+    template<class ScalarType>
+    struct mpi_datatype;
+
+    template<>
+    struct mpi_datatype<float>{ static MPI_Datatype get() { return MPI_FLOAT; } };
+
+    template<>
+    struct mpi_datatype<double>{ static MPI_Datatype get() { return MPI_DOUBLE; } };
+
+    /** @brief Block-distributed backend
+     *
+     *  Each process of the communicator holds a contiguous block of every vector, and the minimizer is run on all the processes
+     *  with N set to the size of the local block (see block_size and block_offset). copy, axpy and scale are purely local, while
+     *  dot, nrm2 and asum reduce their local results over the communicator, so that every process takes the same decisions.
+     *  The functor receives the local block of X, must fill the local block of the gradient, and must return the same (global)
+     *  value on every process.
+     *
+     *  Only level-1 operations are distributed : the directions which store no matrix (steepest_descent, conjugate_gradient,
+     *  low_memory_quasi_newton, truncated_newton) run unchanged.
+     */
+    template<class _ScalarType>
+    struct mpi_types{
+    private:
+        typedef cblas_types<_ScalarType> local;
+
+        static _ScalarType allreduce(_ScalarType x){
+            _ScalarType res;
+            MPI_Allreduce(&x, &res, 1, mpi_datatype<_ScalarType>::get(), MPI_SUM, communicator());
+            return res;
+        }
+
+    public:
+        typedef _ScalarType ScalarType;
+        typedef ScalarType* VectorType;
+        typedef ScalarType* MatrixType;
+
+        /** @brief Communicator the vectors are distributed over. Defaults to MPI_COMM_WORLD */
+        static MPI_Comm & communicator(){
+            static MPI_Comm comm = MPI_COMM_WORLD;
+            return comm;
+        }
+
+        /** @brief Size of the local block of a vector of global size N */
+        static std::size_t block_size(std::size_t N){
+            return block_boundary(N, 1) - block_boundary(N, 0);
+        }
+
+        /** @brief Global index of the first element of the local block of a vector of global size N */
+        static std::size_t block_offset(std::size_t N){
+            return block_boundary(N, 0);
+        }
+
+        static VectorType create_vector(std::size_t N)
+        { return local::create_vector(N); }
+        static void delete_if_dynamically_allocated(ScalarType* p)
+        { local::delete_if_dynamically_allocated(p); }
+
+        static void copy(std::size_t N, VectorType const & from, VectorType & to)
+        { local::copy(N,from,to); }
+        static void axpy(std::size_t N, ScalarType alpha, VectorType const & x, VectorType & y)
+        { local::axpy(N,alpha,x,y); }
+        static void scale(std::size_t N, ScalarType alpha, VectorType & x)
+        { local::scale(N,alpha,x); }
+        static ScalarType asum(std::size_t N, VectorType const & x)
+        { return allreduce(local::asum(N,x)); }
+        static ScalarType nrm2(std::size_t N, VectorType const & x)
+        { return std::sqrt(allreduce(local::dot(N,x,x))); }
+        static ScalarType dot(std::size_t N, VectorType const & x, VectorType const & y)
+        { return allreduce(local::dot(N,x,y)); }
+        /** @brief res[k] = x[k]'y[k], with a single reduction for the K products */
+        static void dots(std::size_t N, std::size_t K, VectorType const * const * x, VectorType const * const * y, ScalarType * res){
+            local::dots(N,K,x,y,res);
+            MPI_Allreduce(MPI_IN_PLACE, res, K, mpi_datatype<ScalarType>::get(), MPI_SUM, communicator());
+        }
+        static void set_to_value(VectorType & V, ScalarType val, std::size_t N)
+        { std::fill(V, V+N, val); }
+
+    private:
+        /** @brief Start of the block of the process of rank (local rank + k) */
+        static std::size_t block_boundary(std::size_t N, int k){
+            int rank, size;
+            MPI_Comm_rank(communicator(), &rank);
+            MPI_Comm_size(communicator(), &size);
+            return N*(rank+k)/size;
+        }
+    };
+
+  }
+
+}
+
+#endif
@@ -50,6 +50,8 @@ namespace umintl{
         { return viennacl::linalg::norm_2(x); }
         static ScalarType dot(std::size_t /*N*/, VectorType const & x, VectorType const & y)
         { return viennacl::linalg::inner_prod(x,y); }
+        static void dots(std::size_t N, std::size_t K, VectorType const * const * x, VectorType const * const * y, ScalarType * res)
+        { for(std::size_t k = 0 ; k < K ; ++k) res[k] = dot(N,*x[k],*y[k]); }
         static void symv(std::size_t /*N*/, ScalarType alpha, MatrixType const& A, VectorType const & x, ScalarType beta, VectorType & y)
         { y = alpha*A*x + beta*y;  }
         static void syr1(std::size_t /*N*/, ScalarType const & alpha, VectorType const & x, MatrixType & A)
@@ -0,0 +1,301 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+#ifndef UMINTL_DATASET_MAPPED_DATASET_HPP
+#define UMINTL_DATASET_MAPPED_DATASET_HPP
+
+#include <string>
+#include <fstream>
+#include <cstring>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include <stdint.h>
+
+#include "umintl/forwards.h"
+#include "umintl/model_base.hpp"
+#include "umintl/tools/mapped_file.hpp"
+#include "umintl/tools/exception.hpp"
+
+namespace umintl{
+
+/** @brief Binary dataset format
+ *
+ *  The file is written in the byte order of the host, which is expected to be little-endian. It starts with a 64-byte header :
+ *
+ *  offset | type     | field
+ *  -------|----------|------------------------------------------------------------
+ *  0      | char[8]  | magic, "UMINTLDS"
+ *  8      | uint32   | version, 1
+ *  12     | uint32   | layout : 0 for dense, 1 for CSR
+ *  16     | uint32   | scalar size : 4 (float) or 8 (double)
+ *  20     | uint32   | flags : bit 0 set if the file contains one target per row
+ *  24     | uint64   | rows, ie number of samples
+ *  32     | uint64   | cols, ie number of features
+ *  40     | uint64   | nnz, number of stored values (CSR only, 0 for dense)
+ *  48     | -        | reserved, zero
+ *
+ *  The header is followed by the following sections, in this order, each starting at a 64-byte aligned offset :
+ *  - dense : values, rows*cols scalars, row-major
+ *  - CSR : row_ptr, rows+1 uint64 (absolute positions in col_idx and values) ; col_idx, nnz uint32 ; values, nnz scalars
+ *  - targets, rows scalars, if flag 0 is set
+ */
+namespace dataset_format{
+    static const char magic[8] = {'U','M','I','N','T','L','D','S'};
+    static const uint32_t version = 1;
+    static const std::size_t header_size = 64;
+    static const std::size_t alignment = 64;
+    enum layout_type{ DENSE = 0, CSR = 1 };
+    enum flags_type{ HAS_TARGETS = 1 };
+
+    struct header{
+        char magic[8];
+        uint32_t version;
+        uint32_t layout;
+        uint32_t scalar_size;
+        uint32_t flags;
+        uint64_t rows;
+        uint64_t cols;
+        uint64_t nnz;
+        char reserved[16];
+    };
+
+    inline std::size_t align(std::size_t offset){
+        return (offset + alignment - 1)/alignment*alignment;
+    }
+
+    namespace detail{
+        inline void write_section(std::ofstream & stream, void const * data, std::size_t bytes){
+            std::size_t pos = stream.tellp();
+            std::vector<char> padding(align(pos) - pos, 0);
+            if(!padding.empty())
+                stream.write(&padding[0], padding.size());
+            if(bytes)
+                stream.write(static_cast<char const *>(data), bytes);
+        }
+
+        inline std::ofstream & open(std::ofstream & stream, std::string const & path, header const & h){
+            stream.open(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+            if(!stream)
+                throw exceptions::io_error("Cannot open " + path + " for writing");
+            stream.write(reinterpret_cast<char const *>(&h), sizeof(header));
+            return stream;
+        }
+
+        inline void close(std::ofstream & stream, std::string const & path){
+            stream.close();
+            if(!stream)
+                throw exceptions::io_error("Cannot write " + path);
+        }
+
+        template<class ScalarType>
+        header make_header(layout_type layout, std::size_t rows, std::size_t cols, std::size_t nnz, bool has_targets){
+            header h;
+            std::memset(&h, 0, sizeof(header));
+            std::memcpy(h.magic, magic, 8);
+            h.version = version;
+            h.layout = layout;
+            h.scalar_size = sizeof(ScalarType);
+            h.flags = has_targets?HAS_TARGETS:0;
+            h.rows = rows;
+            h.cols = cols;
+            h.nnz = nnz;
+            return h;
+        }
+    }
+
+    /** @brief Writes a dense dataset. targets may be NULL */
+    template<class ScalarType>
+    void write_dense(std::string const & path, std::size_t rows, std::size_t cols, ScalarType const * values, ScalarType const * targets = NULL){
+        std::ofstream stream;
+        detail::open(stream, path, detail::make_header<ScalarType>(DENSE, rows, cols, 0, targets!=NULL));
+        detail::write_section(stream, values, rows*cols*sizeof(ScalarType));
+        if(targets)
+            detail::write_section(stream, targets, rows*sizeof(ScalarType));
+        detail::close(stream, path);
+    }
+
+    /** @brief Writes a CSR dataset. row_ptr has rows+1 elements, starting with 0. targets may be NULL */
+    template<class ScalarType>
+    void write_csr(std::string const & path, std::size_t rows, std::size_t cols, uint64_t const * row_ptr, uint32_t const * col_idx, ScalarType const * values, ScalarType const * targets = NULL){
+        std::size_t nnz = row_ptr[rows];
+        std::ofstream stream;
+        detail::open(stream, path, detail::make_header<ScalarType>(CSR, rows, cols, nnz, targets!=NULL));
+        detail::write_section(stream, row_ptr, (rows+1)*sizeof(uint64_t));
+        detail::write_section(stream, col_idx, nnz*sizeof(uint32_t));
+        detail::write_section(stream, values, nnz*sizeof(ScalarType));
+        if(targets)
+            detail::write_section(stream, targets, rows*sizeof(ScalarType));
+        detail::close(stream, path);
+    }
+}
+
+/** @brief Zero-copy view of the rows [offset, offset + rows) of a mapped_dataset
+ *
+ *  Dense : row i is values + i*cols.
+ *  CSR : the values of row i are values[row_ptr[i] .. row_ptr[i+1]), in columns col_idx[row_ptr[i] .. row_ptr[i+1]).
+ *  The positions in row_ptr are absolute, so that values and col_idx point to the beginning of the whole sections.
+ *  targets is NULL if the dataset has no targets.
+ */
+template<class ScalarType>
+struct dataset_window{
+    std::size_t offset;
+    std::size_t rows;
+    std::size_t cols;
+    ScalarType const * values;
+    uint64_t const * row_ptr;
+    uint32_t const * col_idx;
+    ScalarType const * targets;
+};
+
+/** @brief The mapped_dataset class
+ *
+ *  Dataset stored in the binary format described in umintl::dataset_format, and memory-mapped. Windows matching the
+ *  (offset, sample_size) of an operation tag are returned without any copy : the data is only read from the disk when
+ *  accessed by the functor. The memory used by the pages is managed by the kernel and does not count as anonymous memory.
+ *
+ *  Registered as the window_hint of a stochastic model (see model_base::set_window_hint), the dataset asks the kernel to read
+ *  ahead the window the model will select at its next update, and to drop the pages of the window the model just left.
+ */
+template<class ScalarType>
+class mapped_dataset : public window_hint{
+private:
+    typedef std::pair<std::size_t, std::size_t> window_type;
+
+    static bool overlaps(window_type const & a, window_type const & b){
+        return a.first < b.first + b.second && b.first < a.first + a.second;
+    }
+
+    template<class T>
+    T const * section(std::size_t & offset, std::size_t count) const{
+        offset = dataset_format::align(offset);
+        T const * res = reinterpret_cast<T const *>(file_.data() + offset);
+        offset += count*sizeof(T);
+        return res;
+    }
+
+    /** @brief Byte ranges of the rows [offset, offset + n) in each section */
+    void advise_rows(std::size_t offset, std::size_t n, tools::mapped_file::advice a) const{
+        if(offset >= h_.rows || n == 0)
+            return;
+        n = std::min<std::size_t>(n, h_.rows - offset);
+        if(h_.layout == dataset_format::DENSE)
+            file_.advise(reinterpret_cast<char const *>(values_ + offset*h_.cols) - file_.data(), n*h_.cols*sizeof(ScalarType), a);
+        else{
+            file_.advise(reinterpret_cast<char const *>(row_ptr_ + offset) - file_.data(), (n+1)*sizeof(uint64_t), a);
+            std::size_t begin = row_ptr_[offset], end = row_ptr_[offset+n];
+            file_.advise(reinterpret_cast<char const *>(col_idx_ + begin) - file_.data(), (end - begin)*sizeof(uint32_t), a);
+            file_.advise(reinterpret_cast<char const *>(values_ + begin) - file_.data(), (end - begin)*sizeof(ScalarType), a);
+        }
+        if(targets_)
+            file_.advise(reinterpret_cast<char const *>(targets_ + offset) - file_.data(), n*sizeof(ScalarType), a);
+    }
+
+public:
+    mapped_dataset(std::string const & path) : file_(path), values_(NULL), row_ptr_(NULL), col_idx_(NULL), targets_(NULL), n_hinted_(0){
+        if(file_.size() < dataset_format::header_size)
+            throw exceptions::io_error(path + " is too small to be a dataset");
+        std::memcpy(&h_, file_.data(), sizeof(dataset_format::header));
+        if(std::memcmp(h_.magic, dataset_format::magic, 8) != 0)
+            throw exceptions::io_error(path + " is not a dataset");
+        if(h_.version != dataset_format::version)
+            throw exceptions::io_error(path + " : unsupported dataset version");
+        if(h_.scalar_size != sizeof(ScalarType))
+            throw exceptions::incompatible_parameters(path + " : scalar type mismatch");
+
+        std::size_t offset = dataset_format::header_size;
+        if(h_.layout == dataset_format::DENSE)
+            values_ = section<ScalarType>(offset, h_.rows*h_.cols);
+        else if(h_.layout == dataset_format::CSR){
+            row_ptr_ = section<uint64_t>(offset, h_.rows+1);
+            col_idx_ = section<uint32_t>(offset, h_.nnz);
+            values_ = section<ScalarType>(offset, h_.nnz);
+        }
+        else
+            throw exceptions::io_error(path + " : unknown dataset layout");
+        if(h_.flags & dataset_format::HAS_TARGETS)
+            targets_ = section<ScalarType>(offset, h_.rows);
+        if(offset > file_.size())
+            throw exceptions::io_error(path + " is truncated");
+        if(row_ptr_ && row_ptr_[h_.rows] != h_.nnz)
+            throw exceptions::io_error(path + " : inconsistent row pointers");
+    }
+
+    std::size_t rows() const { return h_.rows; }
+    std::size_t cols() const { return h_.cols; }
+    std::size_t nnz() const { return (h_.layout == dataset_format::DENSE)?h_.rows*h_.cols:h_.nnz; }
+    bool is_sparse() const { return h_.layout == dataset_format::CSR; }
+    bool has_targets() const { return targets_ != NULL; }
+
+    /** @brief View of the rows [offset, offset + sample_size) */
+    dataset_window<ScalarType> window(std::size_t offset, std::size_t sample_size) const{
+        if(offset + sample_size > h_.rows)
+            throw exceptions::incompatible_parameters("Dataset window out of bounds");
+        dataset_window<ScalarType> res;
+        res.offset = offset;
+        res.rows = sample_size;
+        res.cols = h_.cols;
+        res.row_ptr = row_ptr_?row_ptr_ + offset:NULL;
+        res.col_idx = col_idx_;
+        res.values = row_ptr_?values_:values_ + offset*h_.cols;
+        res.targets = targets_?targets_ + offset:NULL;
+        return res;
+    }
+
+    /** @brief View of the samples of an operation tag. Deterministic tags use the whole dataset */
+    dataset_window<ScalarType> window(operation_tag const & tag) const{
+        if(tag.model == DETERMINISTIC)
+            return window(0, h_.rows);
+        return window(tag.offset, tag.sample_size);
+    }
+
+    /** @brief Hints the kernel about the global access pattern, typically tools::mapped_file::ADVICE_SEQUENTIAL */
+    void advise(tools::mapped_file::advice a) const{
+        file_.advise(a);
+    }
+
+    void will_need(std::size_t offset, std::size_t sample_size) const{
+        advise_rows(offset, sample_size, tools::mapped_file::ADVICE_WILLNEED);
+    }
+
+    void dont_need(std::size_t offset, std::size_t sample_size) const{
+        advise_rows(offset, sample_size, tools::mapped_file::ADVICE_DONTNEED);
+    }
+
+    /** @brief Notifies the window the model will select at its next update
+     *
+     *  This window is read ahead. The window hinted two updates ago, which the model just left, is dropped unless it overlaps
+     *  the current window (the previous hint) or the next one.
+     */
+    void next_window(operation_tag const & tag){
+        if(tag.model == DETERMINISTIC)
+            return;
+        window_type next(tag.offset, tag.sample_size);
+        if(n_hinted_ == 2 && !overlaps(hinted_[0], hinted_[1]) && !overlaps(hinted_[0], next))
+            dont_need(hinted_[0].first, hinted_[0].second);
+        will_need(next.first, next.second);
+        hinted_[0] = hinted_[1];
+        hinted_[1] = next;
+        n_hinted_ = std::min(n_hinted_+1, (std::size_t)2);
+    }
+
+private:
+    tools::mapped_file file_;
+    dataset_format::header h_;
+    ScalarType const * values_;
+    uint64_t const * row_ptr_;
+    uint32_t const * col_idx_;
+    ScalarType const * targets_;
+    //The two last hinted windows : the one the model just left, and the current one
+    window_type hinted_[2];
+    std::size_t n_hinted_;
+};
+
+}
+
+#endif
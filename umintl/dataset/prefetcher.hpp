@@ -0,0 +1,264 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+#ifndef UMINTL_DATASET_PREFETCHER_HPP
+#define UMINTL_DATASET_PREFETCHER_HPP
+
+#include <vector>
+#include <deque>
+#include <utility>
+#include <algorithm>
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include "umintl/forwards.h"
+#include "umintl/model_base.hpp"
+#include "umintl/dataset/mapped_dataset.hpp"
+#include "umintl/tools/exception.hpp"
+
+namespace umintl{
+
+/** @brief Base class for the decoding of a window
+ *
+ *  Converts a window of a mapped_dataset into the representation expected by the functor (decompression, conversion
+ *  of a sparse window to a dense one, change of precision, etc.). Called from the prefetching thread.
+ */
+template<class ScalarType>
+struct window_decoder{
+    virtual ~window_decoder(){ }
+    virtual void operator()(dataset_window<ScalarType> const & window, std::vector<ScalarType> & res) const = 0;
+};
+
+/** @brief A window loaded by the window_prefetcher
+ *
+ *  The pages of window are resident. decoded is only filled if the prefetcher has a decoder.
+ */
+template<class ScalarType>
+struct prefetched_window{
+    dataset_window<ScalarType> window;
+    std::vector<ScalarType> decoded;
+};
+
+/** @brief The window_prefetcher class
+ *
+ *  Double-buffered background loading of the windows of a mapped_dataset. Registered as the window_hint of a stochastic model
+ *  (see model_base::set_window_hint), it is notified at each update of the window the model will select at the next update.
+ *  A helper thread then reads its pages, and decodes it if a decoder is given, while the current window is being processed.
+ *  The functor retrieves its window with acquire(tag), which only blocks if the window is still being loaded, and loads it
+ *  synchronously if it was not prefetched.
+ *
+ *  acquire() must always be called from the same thread, and the window it returns is valid until its next call.
+ */
+template<class ScalarType>
+class window_prefetcher : public window_hint{
+private:
+    window_prefetcher(window_prefetcher const &);
+    window_prefetcher & operator=(window_prefetcher const &);
+
+    typedef std::pair<std::size_t, std::size_t> window_type;
+
+    struct buffer{
+        buffer() : offset(0), sample_size(0){ }
+        prefetched_window<ScalarType> content;
+        std::size_t offset;
+        std::size_t sample_size;
+    };
+
+    static bool matches(buffer const & b, operation_tag const & tag){
+        return b.offset == tag.offset && b.sample_size == tag.sample_size;
+    }
+
+    /** @brief Reads one byte per page of [begin, end) */
+    static void touch(void const * begin, std::size_t bytes){
+        static const std::size_t page_size = ::sysconf(_SC_PAGESIZE);
+        char const volatile * p = static_cast<char const *>(begin);
+        char sink = 0;
+        for(std::size_t i = 0 ; i < bytes ; i+=page_size)
+            sink ^= p[i];
+        if(bytes)
+            sink ^= p[bytes-1];
+        (void)sink;
+    }
+
+    void load(buffer & b, std::size_t offset, std::size_t sample_size) const{
+        dataset_window<ScalarType> w = data_.window(offset, sample_size);
+        if(w.row_ptr){
+            std::size_t begin = w.row_ptr[0], end = w.row_ptr[w.rows];
+            touch(w.row_ptr, (w.rows+1)*sizeof(uint64_t));
+            touch(w.col_idx + begin, (end - begin)*sizeof(uint32_t));
+            touch(w.values + begin, (end - begin)*sizeof(ScalarType));
+        }
+        else
+            touch(w.values, w.rows*w.cols*sizeof(ScalarType));
+        if(w.targets)
+            touch(w.targets, w.rows*sizeof(ScalarType));
+        if(decoder_)
+            (*decoder_)(w, b.content.decoded);
+        b.content.window = w;
+        b.offset = offset;
+        b.sample_size = sample_size;
+    }
+
+    static void * run(void * self){
+        static_cast<window_prefetcher *>(self)->worker();
+        return NULL;
+    }
+
+    void worker(){
+        pthread_mutex_lock(&mutex_);
+        while(true){
+            //The back buffer is not overwritten before being consumed
+            while(!stop_ && (requests_.empty() || back_ready_))
+                pthread_cond_wait(&work_cond_, &mutex_);
+            if(stop_)
+                break;
+            std::size_t offset = requests_.front().first, sample_size = requests_.front().second;
+            buffer * target = back_;
+            requests_.pop_front();
+            busy_ = true;
+            busy_offset_ = offset;
+            busy_size_ = sample_size;
+            back_ready_ = false;
+            pthread_mutex_unlock(&mutex_);
+
+            bool success = true;
+            try{
+                load(*target, offset, sample_size);
+            }
+            catch(...){
+                //Invalid window : acquire() will report the error synchronously
+                success = false;
+            }
+
+            pthread_mutex_lock(&mutex_);
+            busy_ = false;
+            back_ready_ = success;
+            pthread_cond_broadcast(&done_cond_);
+        }
+        pthread_mutex_unlock(&mutex_);
+    }
+
+public:
+    /** @brief The constructor
+     *
+     *  @param data the dataset. Not owned.
+     *  @param decoder the decoder of the windows, or NULL. Not owned.
+     */
+    window_prefetcher(mapped_dataset<ScalarType> const & data, window_decoder<ScalarType> const * decoder = NULL) : data_(data), decoder_(decoder)
+      , front_(&buffers_[0]), back_(&buffers_[1]), busy_(false), back_ready_(false), stop_(false), hits_(0), misses_(0){
+        pthread_mutex_init(&mutex_, NULL);
+        pthread_cond_init(&work_cond_, NULL);
+        pthread_cond_init(&done_cond_, NULL);
+        if(pthread_create(&thread_, NULL, &window_prefetcher::run, this) != 0)
+            throw exceptions::incompatible_parameters("Cannot create the prefetching thread");
+    }
+
+    ~window_prefetcher(){
+        pthread_mutex_lock(&mutex_);
+        stop_ = true;
+        pthread_cond_signal(&work_cond_);
+        pthread_mutex_unlock(&mutex_);
+        pthread_join(thread_, NULL);
+        pthread_cond_destroy(&done_cond_);
+        pthread_cond_destroy(&work_cond_);
+        pthread_mutex_destroy(&mutex_);
+    }
+
+    /** @brief Schedules the loading of the window of tag
+     *
+     *  The loading starts once the previously loaded window has been acquired. At most two windows are kept in the queue :
+     *  the oldest one is dropped if needed.
+     */
+    void next_window(operation_tag const & tag){
+        pthread_mutex_lock(&mutex_);
+        if(requests_.size()==2)
+            requests_.pop_front();
+        requests_.push_back(std::make_pair(tag.offset, tag.sample_size));
+        pthread_cond_signal(&work_cond_);
+        pthread_mutex_unlock(&mutex_);
+    }
+
+    /** @brief Returns the window of tag. Deterministic tags use the whole dataset */
+    prefetched_window<ScalarType> const & acquire(operation_tag const & tag){
+        operation_tag t = tag;
+        if(t.model == DETERMINISTIC){
+            t.offset = 0;
+            t.sample_size = data_.rows();
+        }
+        window_type w(t.offset, t.sample_size);
+        bool hit = false;
+        pthread_mutex_lock(&mutex_);
+        while(true){
+            if(back_ready_ && matches(*back_, t)){
+                hit = true;
+                break;
+            }
+            //The windows announced before this one were skipped
+            typename std::deque<window_type>::iterator it = std::find(requests_.begin(), requests_.end(), w);
+            if(it != requests_.end())
+                requests_.erase(requests_.begin(), it);
+            //A newer window was announced : the back buffer will never be used
+            if(back_ready_ && !requests_.empty()){
+                back_ready_ = false;
+                pthread_cond_signal(&work_cond_);
+            }
+            //Waits for the window if it is being loaded, or about to be
+            bool pending = (busy_ && busy_offset_ == t.offset && busy_size_ == t.sample_size) || (!requests_.empty() && requests_.front() == w);
+            if(!pending)
+                break;
+            pthread_cond_wait(&done_cond_, &mutex_);
+        }
+        if(hit){
+            std::swap(front_, back_);
+            back_ready_ = false;
+            pthread_cond_signal(&work_cond_);
+        }
+        pthread_mutex_unlock(&mutex_);
+
+        if(hit)
+            ++hits_;
+        else if(!matches(*front_, t)){
+            ++misses_;
+            load(*front_, t.offset, t.sample_size);
+        }
+        return front_->content;
+    }
+
+    /** @brief Number of windows which were ready (or being loaded) when acquired */
+    std::size_t hits() const { return hits_; }
+
+    /** @brief Number of windows which had to be loaded synchronously */
+    std::size_t misses() const { return misses_; }
+
+private:
+    mapped_dataset<ScalarType> const & data_;
+    window_decoder<ScalarType> const * decoder_;
+
+    buffer buffers_[2];
+    buffer * front_;
+    buffer * back_;
+
+    pthread_t thread_;
+    pthread_mutex_t mutex_;
+    pthread_cond_t work_cond_;
+    pthread_cond_t done_cond_;
+
+    std::deque<window_type> requests_;
+    bool busy_;
+    std::size_t busy_offset_;
+    std::size_t busy_size_;
+    bool back_ready_;
+    bool stop_;
+
+    std::size_t hits_;
+    std::size_t misses_;
+};
+
+}
+
+#endif
@@ -11,6 +11,8 @@
 #include "tools/shared_ptr.hpp"
 #include "umintl/model_base.hpp"
 #include <iostream>
+#include <vector>
+#include <algorithm>
 
 #include <cmath>
 
@@ -47,6 +49,111 @@ typename BackendType::ScalarType check_grad(FUN & fun, typename BackendType::Vec
     return res;
 }
 
+/** @brief Result of check_grad_sampled */
+struct gradient_check_result{
+    /** Maximum relative error over all the sampled checks */
+    double max_error;
+    /** Median relative error over all the sampled checks */
+    double median_error;
+    /** Number of function evaluations performed */
+    std::size_t n_evaluations;
+};
+
+namespace detail{
+
+/** @brief Minimal linear congruential generator. Each check owns its stream, so that the samples do not depend on the number of threads */
+struct check_grad_rng{
+    check_grad_rng(unsigned long seed) : state_(seed*2654435761UL + 1){ }
+    unsigned long operator()(){
+        state_ = state_*6364136223846793005ULL + 1442695040888963407ULL;
+        return (unsigned long)(state_ >> 33);
+    }
+private:
+    unsigned long long state_;
+};
+
+inline double check_grad_relative_error(double numerical, double analytical){
+    double denom = std::max(std::fabs(numerical),std::fabs(analytical));
+    double diff = std::fabs(numerical-analytical);
+    if(denom>1)
+        diff/=denom;
+    return diff;
+}
+
+}
+
+/** @brief Sampled gradient checker
+ *
+ *  Unlike check_grad, which costs 2N evaluations, compares g'v with the central difference (f(x+hv) - f(x-hv))/2h along
+ *  n_directions random (normalized) Rademacher directions v, and the gradient with the central difference along n_coordinates randomly
+ *  sampled coordinates. The checks are independent and evaluated in parallel, so that fun must be safe to call concurrently.
+ *  Costs 1 + 2*(n_directions + n_coordinates) evaluations.
+ *
+ *  @param seed seed of the random directions and coordinates
+ */
+template<class BackendType, class FUN>
+gradient_check_result check_grad_sampled(FUN & fun, typename BackendType::VectorType const & x0, std::size_t N, typename BackendType::ScalarType h
+                                         , std::size_t n_directions, std::size_t n_coordinates = 0, unsigned int seed = 0){
+    typedef typename BackendType::ScalarType ScalarType;
+    typedef typename BackendType::VectorType VectorType;
+    umintl::deterministic<BackendType> model;
+    std::size_t n_checks = n_directions + n_coordinates;
+    std::vector<double> errors(n_checks);
+    //Normalized directions, so that h is the length of the step for both kinds of checks
+    ScalarType scale = 1/std::sqrt((ScalarType)N);
+
+    ScalarType val;
+    VectorType fgrad = BackendType::create_vector(N);
+    fun(x0,val,fgrad,model.get_value_gradient_tag());
+
+    #ifdef _OPENMP
+    #pragma omp parallel
+    #endif
+    {
+        VectorType x = BackendType::create_vector(N);
+        VectorType v = BackendType::create_vector(N);
+        VectorType dummy = BackendType::create_vector(N);
+        #ifdef _OPENMP
+        #pragma omp for schedule(dynamic)
+        #endif
+        for(long k = 0 ; k < (long)n_checks ; ++k){
+            detail::check_grad_rng rng(seed + (unsigned long)k*N);
+            ScalarType vl, vr, analytical;
+            if(k < (long)n_directions){
+                for(std::size_t i = 0 ; i < N ; ++i)
+                    v[i] = (rng() & 1)?scale:-scale;
+                analytical = BackendType::dot(N,fgrad,v);
+                BackendType::copy(N,x0,x);
+                BackendType::axpy(N,-h,v,x); fun(x,vl,dummy,model.get_value_gradient_tag());
+                BackendType::axpy(N,2*h,v,x); fun(x,vr,dummy,model.get_value_gradient_tag());
+            }
+            else{
+                std::size_t i = rng() % N;
+                analytical = fgrad[i];
+                BackendType::copy(N,x0,x);
+                x[i] = x0[i]-h; fun(x,vl,dummy,model.get_value_gradient_tag());
+                x[i] = x0[i]+h; fun(x,vr,dummy,model.get_value_gradient_tag());
+            }
+            errors[k] = detail::check_grad_relative_error((vr-vl)/(2*h),analytical);
+        }
+        BackendType::delete_if_dynamically_allocated(x);
+        BackendType::delete_if_dynamically_allocated(v);
+        BackendType::delete_if_dynamically_allocated(dummy);
+    }
+    BackendType::delete_if_dynamically_allocated(fgrad);
+
+    gradient_check_result res;
+    res.n_evaluations = 1 + 2*n_checks;
+    res.max_error = 0;
+    res.median_error = 0;
+    if(n_checks > 0){
+        res.max_error = *std::max_element(errors.begin(), errors.end());
+        std::nth_element(errors.begin(), errors.begin() + n_checks/2, errors.end());
+        res.median_error = errors[n_checks/2];
+    }
+    return res;
+}
+
 //template<class BackendType, class FUN>
 //typename BackendType::ScalarType check_grad_variance(FUN & fun, typename BackendType::VectorType const & x0, std::size_t N){
 //    typedef typename BackendType::ScalarType ScalarType;
@@ -0,0 +1,98 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+
+#ifndef UMINTL_DIRECTIONS_ADAM_HPP_
+#define UMINTL_DIRECTIONS_ADAM_HPP_
+
+#include <cmath>
+
+#include "umintl/optimization_context.hpp"
+#include "umintl/directions/step_size.hpp"
+
+#include "umintl/tools/shared_ptr.hpp"
+#include "umintl/directions/forwards.h"
+
+
+namespace umintl{
+
+/** @brief The Adam class
+ *
+ *  Kingma & Ba (2014) : "Adam: A Method for Stochastic Optimization". Scales each coordinate of the (bias-corrected)
+ *  first moment of the gradient by the inverse square-root of its second moment. Like stochastic_gradient, this is a
+ *  fixed-step direction.
+ */
+template<class BackendType>
+struct adam : public direction<BackendType>{
+    typedef typename BackendType::VectorType VectorType;
+    typedef typename BackendType::ScalarType ScalarType;
+
+    /** @brief The constructor
+     *
+     *  @param _eta the step-size schedule
+     *  @param _beta1 decay rate of the first moment
+     *  @param _beta2 decay rate of the second moment
+     *  @param _epsilon regularization of the second moment
+     */
+    adam(step_size const & _eta, double _beta1 = 0.9, double _beta2 = 0.999, double _epsilon = 1e-8) : eta(_eta), beta1(_beta1), beta2(_beta2), epsilon(_epsilon){ }
+
+    virtual std::string info() const{
+        return "Adam";
+    }
+
+    virtual bool is_fixed_step() const{
+        return true;
+    }
+
+    virtual void init(optimization_context<BackendType> & c){
+        m_ = BackendType::create_vector(c.N());
+        v_ = BackendType::create_vector(c.N());
+        BackendType::set_to_value(m_,0,c.N());
+        BackendType::set_to_value(v_,0,c.N());
+    }
+
+    virtual void clean(optimization_context<BackendType> &){
+        BackendType::delete_if_dynamically_allocated(m_);
+        BackendType::delete_if_dynamically_allocated(v_);
+    }
+
+    /** @brief The moments. The bias correction only depends on the iteration, which is part of the optimization context */
+    virtual void save_state(optimization_context<BackendType> & c, tools::state_writer & writer) const{
+        writer.write_vector<ScalarType>(m_,c.N());
+        writer.write_vector<ScalarType>(v_,c.N());
+    }
+
+    virtual void load_state(optimization_context<BackendType> & c, tools::state_reader & reader){
+        reader.read_vector<ScalarType>(m_,c.N());
+        reader.read_vector<ScalarType>(v_,c.N());
+    }
+
+    void operator()(optimization_context<BackendType> & c){
+        std::size_t N = c.N();
+        double t = c.iter() + 1;
+        ScalarType eta_k = eta(c.iter())*std::sqrt(1 - std::pow(beta2,t))/(1 - std::pow(beta1,t));
+        for(std::size_t i = 0 ; i < N ; ++i){
+            ScalarType gi = c.g()[i];
+            m_[i] = beta1*m_[i] + (1-beta1)*gi;
+            v_[i] = beta2*v_[i] + (1-beta2)*gi*gi;
+            c.p()[i] = -eta_k*m_[i]/(std::sqrt(v_[i]) + epsilon);
+        }
+    }
+
+    step_size eta;
+    double beta1;
+    double beta2;
+    double epsilon;
+
+private:
+    VectorType m_;
+    VectorType v_;
+};
+
+}
+
+#endif
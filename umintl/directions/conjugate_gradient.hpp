@@ -92,6 +92,10 @@ public:
         return "Nonlinear Conjugate Gradient";
     }
 
+    /** @brief No state besides the optimization context, which holds the previous direction */
+    virtual void save_state(optimization_context<BackendType> &, tools::state_writer &) const { }
+    virtual void load_state(optimization_context<BackendType> &, tools::state_reader &) { }
+
     void operator()(optimization_context<BackendType> & c){
         ScalarType beta;
         if(restart_impl(c))
@@ -0,0 +1,229 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+
+#ifndef UMINTL_DIRECTIONS_FACTORED_QUASI_NEWTON_HPP_
+#define UMINTL_DIRECTIONS_FACTORED_QUASI_NEWTON_HPP_
+
+#include <cmath>
+
+#include "umintl/optimization_context.hpp"
+
+#include "forwards.h"
+
+namespace umintl{
+
+/** @brief The factored quasi-newton class
+ *
+ *  Same direction as quasi_newton, but the hessian approximation is kept in factored form, B = R'R/sigma, with R upper triangular
+ *  and sigma a scalar (Goldfarb's factored BFGS, see Dennis & Schnabel, algorithm A9.4.2). The scaling of the inverse hessian
+ *  approximation H = sigma*inv(R'R) only changes sigma, the BFGS update of R is a rank-one QR update performed with 2N Givens
+ *  rotations, and the direction is obtained with two triangular solves : every step is O(N^2), without the N^2 rescaling pass of
+ *  quasi_newton. Since B is only ever modified through R, it remains positive definite where the rounding errors of the update of H
+ *  would make it indefinite, as on badly scaled problems. The update is skipped when the curvature condition s'y > 0 does not hold.
+ *
+ *  R is stored packed, row by row, in N(N+1)/2 scalars, and handled with the triangular packed operations of the backend (tpmv, tpsv)
+ *  and its Givens rotations (rot). The diagonal and the subdiagonal are accessed element-wise, which requires a host backend.
+ */
+template<class BackendType>
+struct factored_quasi_newton : public direction<BackendType>{
+    typedef typename BackendType::ScalarType ScalarType;
+    typedef typename BackendType::VectorType VectorType;
+
+private:
+    /** @brief Position of the row i of R in the packed storage */
+    std::size_t row(std::size_t i) const { return i*(2*N_-i+1)/2 - i; }
+
+    /** @brief Applies to the rows i and i+1 of the upper Hessenberg matrix (R, sub_) the Givens rotation which zeroes b in (a,b) */
+    void rotate(std::size_t i, ScalarType a, ScalarType b){
+        ScalarType r = std::sqrt(a*a + b*b);
+        if(r==0)
+            return;
+        ScalarType cs = a/r, sn = b/r;
+        std::size_t k = row(i)+i;
+        ScalarType rii = R_[k];
+        R_[k] = cs*rii + sn*sub_[i];
+        sub_[i] = -sn*rii + cs*sub_[i];
+        BackendType::rot(N_-i-1,R_,k+1,R_,row(i+1)+i+1,cs,sn);
+    }
+
+    /** @brief BFGS update of R'R with the pair (s, sigma*y)
+     *
+     *  The new R'R is J*J', with J = R' + (sigma*y - R'v)*v'/(v'v), v = a*R*s and a = sqrt(sigma*s'y/s'R'Rs) (Dennis & Schnabel,
+     *  algorithm A9.4.2). R is therefore replaced by the triangular factor of R + u*w', with u = v/(v'v) and w = sigma*y - R'v, which
+     *  takes 2N Givens rotations (algorithm A3.4.1). The first N rotations reduce u to a multiple of e_0 and only depend on the direction
+     *  of R*s : they are applied from the last row up.
+     */
+    void update(ScalarType ys){
+        //Rs = R*s, w = R'R*s
+        BackendType::copy(N_,s_,Rs_);
+        BackendType::tpmv(N_,false,R_,Rs_);
+        BackendType::copy(N_,Rs_,w_);
+        BackendType::tpmv(N_,true,R_,w_);
+        BackendType::set_to_value(sub_,0,N_);
+        //Norm of the last components of R*s
+        ScalarType tail = Rs_[N_-1];
+        for(std::size_t i = N_-1 ; i-- > 0 ; ){
+            ScalarType Rsi = Rs_[i];
+            rotate(i, Rsi, tail);
+            tail = std::sqrt(Rsi*Rsi + tail*tail);
+        }
+        //R is upper Hessenberg and u = u0*e_0 : the first row of R is the only one to update
+        ScalarType a = std::sqrt(sigma_*ys)/std::fabs(tail);
+        ScalarType u0 = a*tail/(sigma_*ys);
+        BackendType::scale(N_,-a*u0,w_);
+        BackendType::axpy(N_,sigma_*u0,y_,w_);
+        BackendType::axpy(N_,1,w_,R_);
+        for(std::size_t i = 0 ; i + 1 < N_ ; ++i)
+            rotate(i, R_[row(i)+i], sub_[i]);
+    }
+
+    /** @brief p = -sigma*inv(R'R)*g. Keeps inv(R')*g, which is needed at the next iteration */
+    void compute_direction(optimization_context<BackendType> & c){
+        BackendType::copy(N_,c.g(),t_);
+        BackendType::tpsv(N_,true,R_,t_);
+        BackendType::copy(N_,t_,c.p());
+        BackendType::tpsv(N_,false,R_,c.p());
+        BackendType::scale(N_,-sigma_,c.p());
+        has_t_ = true;
+    }
+
+public:
+    virtual std::string info() const{
+        return "Factored Quasi-Newton";
+    }
+
+    virtual void init(optimization_context<BackendType> & c){
+        N_ = c.N();
+        reinitialize_ = true;
+        is_seeded_ = false;
+        has_t_ = false;
+        sigma_ = 1;
+        R_ = BackendType::create_vector(N_*(N_+1)/2);
+        s_ = BackendType::create_vector(N_);
+        y_ = BackendType::create_vector(N_);
+        t_ = BackendType::create_vector(N_);
+        z_ = BackendType::create_vector(N_);
+        w_ = BackendType::create_vector(N_);
+        Rs_ = BackendType::create_vector(N_);
+        sub_ = BackendType::create_vector(N_);
+        BackendType::set_to_diagonal_packed(N_,R_,1);
+    }
+
+    virtual void clean(optimization_context<BackendType> &){
+        BackendType::delete_if_dynamically_allocated(R_);
+        BackendType::delete_if_dynamically_allocated(s_);
+        BackendType::delete_if_dynamically_allocated(y_);
+        BackendType::delete_if_dynamically_allocated(t_);
+        BackendType::delete_if_dynamically_allocated(z_);
+        BackendType::delete_if_dynamically_allocated(w_);
+        BackendType::delete_if_dynamically_allocated(Rs_);
+        BackendType::delete_if_dynamically_allocated(sub_);
+    }
+
+    virtual void save_state(optimization_context<BackendType> &, tools::state_writer & writer) const{
+        writer.write(reinitialize_);
+        writer.write(sigma_);
+        writer.write_vector<ScalarType>(R_, N_*(N_+1)/2);
+    }
+
+    virtual void load_state(optimization_context<BackendType> &, tools::state_reader & reader){
+        reinitialize_ = reader.read<bool>();
+        sigma_ = reader.read<ScalarType>();
+        reader.read_vector<ScalarType>(R_, N_*(N_+1)/2);
+        is_seeded_ = false;
+        has_t_ = false;
+    }
+
+    /** @brief The scaled factor of the hessian approximation */
+    virtual bool export_curvature(optimization_context<BackendType> &, tools::state_writer & writer) const{
+        if(reinitialize_)
+            return false;
+        writer.write(sigma_);
+        writer.write_vector<ScalarType>(R_, N_*(N_+1)/2);
+        return true;
+    }
+
+    virtual void import_curvature(optimization_context<BackendType> &, tools::state_reader & reader){
+        sigma_ = reader.read<ScalarType>();
+        reader.read_vector<ScalarType>(R_, N_*(N_+1)/2);
+        reinitialize_ = false;
+        is_seeded_ = true;
+    }
+
+    void operator()(optimization_context<BackendType> & c){
+        if(is_seeded_){
+            compute_direction(c);
+            is_seeded_ = false;
+            return;
+        }
+
+        //s = x - xm1, y = g - gm1
+        BackendType::copy(N_,c.x(),s_);
+        BackendType::axpy(N_,-1,c.xm1(),s_);
+        BackendType::copy(N_,c.g(),y_);
+        BackendType::axpy(N_,-1,c.gm1(),y_);
+        ScalarType ys = BackendType::dot(N_,s_,y_);
+        ScalarType sg = BackendType::dot(N_,s_,c.gm1());
+
+        if(reinitialize_){
+            BackendType::set_to_diagonal_packed(N_,R_,1);
+            sigma_ = 1;
+            has_t_ = false;
+            reinitialize_ = false;
+        }
+
+        if(ys > 0){
+            //inv(R')*gm1 is known from the previous direction, unless R has been reset or loaded since
+            if(!has_t_){
+                BackendType::copy(N_,c.gm1(),t_);
+                BackendType::tpsv(N_,true,R_,t_);
+            }
+            BackendType::copy(N_,y_,z_);
+            BackendType::tpsv(N_,true,R_,z_);
+            ScalarType yHy = sigma_*BackendType::dot(N_,z_,z_);
+            ScalarType gHy = sigma_*BackendType::dot(N_,t_,z_);
+
+            //Same scaling as quasi_newton, for H = sigma*inv(R'R)
+            ScalarType gamma = 1;
+            if(ys/yHy>1)
+                gamma = ys/yHy;
+            else if(sg/gHy<1)
+                gamma = sg/gHy;
+            sigma_ *= gamma;
+
+            //BFGS update of R'R = sigma*B with the pair (s, sigma*y)
+            update(ys);
+        }
+
+        compute_direction(c);
+    }
+
+private:
+    std::size_t N_;
+
+    VectorType R_;
+    ScalarType sigma_;
+
+    VectorType s_;
+    VectorType y_;
+    //inv(R')*g
+    VectorType t_;
+    VectorType z_;
+    VectorType w_;
+    VectorType Rs_;
+    //Subdiagonal of R during the QR update
+    VectorType sub_;
+
+    bool reinitialize_;
+    bool is_seeded_;
+    bool has_t_;
+};
+
+}
+
+#endif
@@ -9,6 +9,8 @@
 #define UMINTL_DIRECTIONS_FORWARDS_H
 
 #include "umintl/optimization_context.hpp"
+#include "umintl/tools/serialization.hpp"
+#include "umintl/tools/exception.hpp"
 
 namespace umintl{
 
@@ -20,6 +22,40 @@ struct direction{
     virtual std::string info() const = 0;
     virtual void init(optimization_context<BackendType> &){ }
     virtual void clean(optimization_context<BackendType> &){ }
+    /** @brief Whether the direction follows its own step-size rule
+     *
+     *  If true, p already contains the step : the minimizer skips the line-search and sets x += p
+     */
+    virtual bool is_fixed_step() const { return false; }
+    /** @brief Evaluates the value and the gradient at c.x(), on the samples of the model. Called after the initialization and by the
+     *  fixed-step loop after each step.
+     *
+     *  A direction which needs per-sample evaluations at the new iterate can override it, so that the mini-batch value and gradient
+     *  are derived from them instead of being evaluated once more.
+     */
+    virtual void evaluate(optimization_context<BackendType> & c){
+        c.fun().compute_value_gradient(c.x(), c.val(), c.g(), c.model().get_value_gradient_tag());
+    }
+    /** @brief Saves the state kept by the direction from one iteration to the next, besides the optimization context
+     *
+     *  Used for checkpointing. Throws by default, so that a direction with an unsaved state cannot be resumed silently.
+     */
+    virtual void save_state(optimization_context<BackendType> &, tools::state_writer &) const {
+        throw exceptions::incompatible_parameters("Checkpointing is not supported by the direction " + info());
+    }
+    /** @brief Restores the state saved by save_state. Called after init */
+    virtual void load_state(optimization_context<BackendType> &, tools::state_reader &) {
+        throw exceptions::incompatible_parameters("Checkpointing is not supported by the direction " + info());
+    }
+    /** @brief Exports the curvature information gathered by a finished run, to seed the next one (see minimizer::warm_start)
+     *
+     *  @return false if the direction has no curvature information to export
+     */
+    virtual bool export_curvature(optimization_context<BackendType> &, tools::state_writer &) const { return false; }
+    /** @brief Seeds the direction with exported curvature information. Called after init : the first call to operator() then
+     *  uses it as is, since there is no previous iterate to update it with.
+     */
+    virtual void import_curvature(optimization_context<BackendType> &, tools::state_reader &) { }
 };
 
 
@@ -0,0 +1,335 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+
+#ifndef UMINTL_DIRECTIONS_LEVENBERG_MARQUARDT_HPP_
+#define UMINTL_DIRECTIONS_LEVENBERG_MARQUARDT_HPP_
+
+#include <vector>
+#include <cmath>
+
+#include "umintl/linear/conjugate_gradient.hpp"
+#include "umintl/optimization_context.hpp"
+#include "umintl/tools/exception.hpp"
+#include "forwards.h"
+
+namespace umintl{
+
+namespace tag{
+
+namespace levenberg_marquardt{
+
+enum solver{
+    /** Dense solver if N is below the dense threshold, matrix-free solver otherwise */
+    SOLVE_AUTOMATIC,
+    /** QR factorization of the damped jacobian. Requires the umintl::residuals_jacobian overload */
+    SOLVE_DENSE_QR,
+    /** Linear conjugate gradient on J'J. Requires the umintl::gauss_newton_vector_product overload */
+    SOLVE_MATRIX_FREE_CG
+};
+
+}
+
+}
+
+/** @brief The Levenberg-Marquardt direction
+ *
+ *  For least-square objectives f(x) = sum_m r_m(x)^2, whose Hessian is approximated by the Gauss-Newton matrix G = 2J'J.
+ *  The direction solves (G + lambda*I)p = -g. The damping lambda is adapted with Nielsen's rule from the ratio between the
+ *  actual and the predicted reduction of the full step, and the line-search only acts as a safeguard : a full step which the
+ *  line-search has to shorten is treated as a rejected step, and increases the damping geometrically.
+ *
+ *  - The dense solver requires an overload of
+ *    void operator()(VectorType const & X, VectorType & r, MatrixType & J, umintl::residuals_jacobian)
+ *    which fills the M residuals and their MxN jacobian (row-major). It assumes a host backend, where the matrix elements
+ *    are accessed with J[m*N+n].
+ *  - The matrix-free solver requires an overload of
+ *    void operator()(VectorType const & X, VectorType const & v, VectorType & Gv, umintl::gauss_newton_vector_product)
+ *    which computes Gv = 2J'(Jv).
+ */
+template<class BackendType>
+struct levenberg_marquardt : public direction<BackendType>{
+  private:
+    typedef typename BackendType::VectorType VectorType;
+    typedef typename BackendType::MatrixType MatrixType;
+    typedef typename BackendType::ScalarType ScalarType;
+
+    struct compute_Ab: public linear::conjugate_gradient_detail::compute_Ab<BackendType>{
+        compute_Ab(VectorType const & x, ScalarType lambda, model_base<BackendType> const & model, umintl::detail::function_wrapper<BackendType> & fun) : x_(x), lambda_(lambda), model_(model), fun_(fun){ }
+        virtual void operator()(std::size_t N, VectorType const & b, VectorType & res){
+          hessian_vector_product tag = model_.get_hv_product_tag();
+          fun_.compute_gauss_newton_product(x_,b,res,gauss_newton_vector_product(tag.model,tag.sample_size,tag.offset));
+          BackendType::axpy(N,lambda_,b,res);
+        }
+      private:
+        VectorType const & x_;
+        ScalarType lambda_;
+        model_base<BackendType> const & model_;
+        umintl::detail::function_wrapper<BackendType> & fun_;
+    };
+
+    /** @brief Solves min ||r + Jp||^2 + lambda/2*||p||^2, ie (G + lambda*I)p = -g, with a Householder QR factorization of [J ; sqrt(lambda/2)*I]
+     *
+     *  Unlike a Cholesky factorization of G + lambda*I, this does not square the condition number of J.
+     */
+    void solve_dense(optimization_context<BackendType> & c){
+        std::size_t N = c.N();
+        std::size_t K = M+N;
+        value_gradient tag = c.model().get_value_gradient_tag();
+        c.fun().compute_residuals_jacobian(c.x(),r_,J_,residuals_jacobian(tag.model,tag.sample_size,tag.offset));
+
+        //The initial damping is relative to the largest diagonal element of G
+        if(!is_scaled_){
+            ScalarType max_diag = 0;
+            for(std::size_t n = 0 ; n < N ; ++n){
+                ScalarType diag = 0;
+                for(std::size_t m = 0 ; m < M ; ++m)
+                    diag += 2*J_[m*N+n]*J_[m*N+n];
+                max_diag = std::max(max_diag,diag);
+            }
+            lambda = lambda0*max_diag;
+            is_scaled_ = true;
+        }
+
+        while(true){
+            //A = [J ; sqrt(lambda/2)*I], b = -[r ; 0]
+            ScalarType diag = std::sqrt(lambda/2);
+            for(std::size_t m = 0 ; m < M ; ++m){
+                for(std::size_t n = 0 ; n < N ; ++n)
+                    A_[m*N+n] = J_[m*N+n];
+                b_[m] = -r_[m];
+            }
+            for(std::size_t i = 0 ; i < N ; ++i){
+                for(std::size_t n = 0 ; n < N ; ++n)
+                    A_[(M+i)*N+n] = (i==n)?diag:0;
+                b_[M+i] = 0;
+            }
+            if(householder_solve(K,N,c.p()))
+                break;
+            lambda = std::max(10*lambda,(ScalarType)1e-12);
+        }
+
+        //p'Gp = 2||Jp||^2
+        pGp_ = 0;
+        for(std::size_t m = 0 ; m < M ; ++m){
+            ScalarType Jp = 0;
+            for(std::size_t n = 0 ; n < N ; ++n)
+                Jp += J_[m*N+n]*c.p()[n];
+            pGp_ += 2*Jp*Jp;
+        }
+    }
+
+    /** @brief Least-square solution of A_*p = b_ (A_ is KxN). Returns false if A_ is numerically rank-deficient */
+    bool householder_solve(std::size_t K, std::size_t N, VectorType & p){
+        std::vector<ScalarType> v(K);
+        for(std::size_t k = 0 ; k < N ; ++k){
+            ScalarType nrm = 0;
+            for(std::size_t i = k ; i < K ; ++i)
+                nrm += A_[i*N+k]*A_[i*N+k];
+            nrm = std::sqrt(nrm);
+            if(nrm==0)
+                return false;
+            ScalarType alpha = (A_[k*N+k] > 0)?-nrm:nrm;
+            //v = A(k:,k) - alpha*e_k
+            ScalarType vv = 0;
+            for(std::size_t i = k ; i < K ; ++i){
+                v[i] = A_[i*N+k];
+                if(i==k) v[i] -= alpha;
+                vv += v[i]*v[i];
+            }
+            A_[k*N+k] = alpha;
+            for(std::size_t i = k+1 ; i < K ; ++i)
+                A_[i*N+k] = 0;
+            if(vv==0)
+                continue;
+            for(std::size_t j = k+1 ; j < N ; ++j){
+                ScalarType dot = 0;
+                for(std::size_t i = k ; i < K ; ++i)
+                    dot += v[i]*A_[i*N+j];
+                dot = 2*dot/vv;
+                for(std::size_t i = k ; i < K ; ++i)
+                    A_[i*N+j] -= dot*v[i];
+            }
+            ScalarType dot = 0;
+            for(std::size_t i = k ; i < K ; ++i)
+                dot += v[i]*b_[i];
+            dot = 2*dot/vv;
+            for(std::size_t i = k ; i < K ; ++i)
+                b_[i] -= dot*v[i];
+        }
+        ScalarType max_diag = 0;
+        for(std::size_t k = 0 ; k < N ; ++k)
+            max_diag = std::max(max_diag,std::abs(A_[k*N+k]));
+        for(std::size_t k = 0 ; k < N ; ++k)
+            if(std::abs(A_[k*N+k]) <= 1e-14*max_diag)
+                return false;
+        //Back-substitution R*p = Q'b
+        for(std::size_t i = N ; i-- > 0 ;){
+            ScalarType sum = b_[i];
+            for(std::size_t j = i+1 ; j < N ; ++j)
+                sum -= A_[i*N+j]*p[j];
+            p[i] = sum/A_[i*N+i];
+        }
+        return true;
+    }
+
+    /** @brief Solves (G + lambda*I)p = -g with the linear conjugate gradient
+     *
+     *  The relative tolerance of the solve is at most 1e-3 : the rejection of the steps relies on the predicted reduction, which
+     *  is only meaningful for an accurate solution on badly conditioned problems.
+     */
+    void solve_matrix_free(optimization_context<BackendType> & c){
+        std::size_t N = c.N();
+        std::size_t max_cg_iter = max_iter?max_iter:N;
+        ScalarType nrm_g = BackendType::nrm2(N,c.g());
+        hessian_vector_product tag = c.model().get_hv_product_tag();
+
+        VectorType minus_g = BackendType::create_vector(N);
+        VectorType Gp = BackendType::create_vector(N);
+        BackendType::copy(N,c.g(),minus_g);
+        BackendType::scale(N,-1,minus_g);
+
+        //The initial damping is relative to the Rayleigh quotient of G along the gradient
+        if(!is_scaled_ && nrm_g > 0){
+            c.fun().compute_gauss_newton_product(c.x(),c.g(),Gp,gauss_newton_vector_product(tag.model,tag.sample_size,tag.offset));
+            lambda = lambda0*BackendType::dot(N,c.g(),Gp)/(nrm_g*nrm_g);
+            is_scaled_ = true;
+        }
+
+        linear::conjugate_gradient<BackendType> solver(max_cg_iter, new compute_Ab(c.x(),lambda,c.model(),c.fun()));
+        solver.stop = new linear::conjugate_gradient_detail::residual_norm<BackendType>(std::min((ScalarType)1e-3,std::sqrt(nrm_g))*nrm_g);
+        BackendType::set_to_value(Gp,0,N);
+
+        typename linear::conjugate_gradient<BackendType>::optimization_result res = solver(N,Gp,minus_g,c.p());
+        if(res.i==0 && res.ret == linear::conjugate_gradient<BackendType>::FAILURE_NON_POSITIVE_DEFINITE)
+            BackendType::copy(N,minus_g,c.p());
+
+        c.fun().compute_gauss_newton_product(c.x(),c.p(),Gp,gauss_newton_vector_product(tag.model,tag.sample_size,tag.offset));
+        pGp_ = BackendType::dot(N,c.p(),Gp);
+
+        BackendType::delete_if_dynamically_allocated(minus_g);
+        BackendType::delete_if_dynamically_allocated(Gp);
+    }
+
+  public:
+    /** @brief The constructor
+     *
+     *  @param _M number of residuals
+     *  @param _solver solver used for the damped Gauss-Newton system
+     *  @param _lambda0 initial damping, relative to the largest diagonal element of G for the dense solver, and to the Rayleigh
+     *  quotient of G along the gradient for the matrix-free solver
+     *  @param _dense_threshold largest dimension for which the automatic solver selection uses the dense solver
+     *  @param _max_iter maximum number of linear conjugate gradient iterations. Defaults to the dimension of the problem.
+     */
+    levenberg_marquardt(std::size_t _M, tag::levenberg_marquardt::solver _solver = tag::levenberg_marquardt::SOLVE_AUTOMATIC, double _lambda0 = 1e-3
+                        , std::size_t _dense_threshold = 1000, std::size_t _max_iter = 0) : M(_M), solver(_solver), lambda0(_lambda0), dense_threshold(_dense_threshold), max_iter(_max_iter){ }
+
+    virtual std::string info() const{
+        return "Levenberg-Marquardt";
+    }
+
+    virtual void init(optimization_context<BackendType> & c){
+        std::size_t N = c.N();
+        lambda = lambda0;
+        nu_ = 2;
+        is_scaled_ = false;
+        has_prediction_ = false;
+        use_dense_ = solver==tag::levenberg_marquardt::SOLVE_DENSE_QR
+                  || (solver==tag::levenberg_marquardt::SOLVE_AUTOMATIC && N <= dense_threshold);
+        if(use_dense_){
+            r_ = BackendType::create_vector(M);
+            J_ = BackendType::create_matrix(M,N);
+            A_.resize((M+N)*N);
+            b_.resize(M+N);
+        }
+    }
+
+    virtual void clean(optimization_context<BackendType> &){
+        if(use_dense_){
+            BackendType::delete_if_dynamically_allocated(r_);
+            BackendType::delete_if_dynamically_allocated(J_);
+            A_.clear();
+            b_.clear();
+        }
+    }
+
+    /** @brief The damping, and the prediction of the previous step. The dense temporaries are recomputed at each iteration */
+    virtual void save_state(optimization_context<BackendType> &, tools::state_writer & writer) const{
+        writer.write(lambda);
+        writer.write(nu_);
+        writer.write(is_scaled_);
+        writer.write(has_prediction_);
+        writer.write(last_iter_);
+        writer.write(gp_);
+        writer.write(pGp_);
+    }
+
+    virtual void load_state(optimization_context<BackendType> &, tools::state_reader & reader){
+        lambda = reader.read<ScalarType>();
+        nu_ = reader.read<ScalarType>();
+        is_scaled_ = reader.read<bool>();
+        has_prediction_ = reader.read<bool>();
+        last_iter_ = reader.read<unsigned int>();
+        gp_ = reader.read<ScalarType>();
+        pGp_ = reader.read<ScalarType>();
+    }
+
+    void operator()(optimization_context<BackendType> & c){
+        //Nielsen's update of the damping, from the previous step. The line-search starts with the full step
+        if(has_prediction_ && last_iter_+1==c.iter()){
+            ScalarType a = c.alpha();
+            //The full step did not decrease f enough : rejected
+            if(a < 1){
+                lambda *= nu_;
+                nu_ *= 2;
+            }
+            else{
+                ScalarType predicted = -(gp_ + 0.5*pGp_);
+                ScalarType rho = (c.valm1() - c.val())/predicted;
+                //The line-search had to extrapolate : the step was too short
+                if(a > 1)
+                    rho = 1;
+                ScalarType t = 2*rho - 1;
+                lambda *= std::max((ScalarType)1/3, 1 - t*t*t);
+                nu_ = 2;
+            }
+        }
+
+        if(use_dense_)
+            solve_dense(c);
+        else
+            solve_matrix_free(c);
+
+        gp_ = BackendType::dot(c.N(),c.g(),c.p());
+        has_prediction_ = true;
+        last_iter_ = c.iter();
+    }
+
+    std::size_t M;
+    tag::levenberg_marquardt::solver solver;
+    double lambda0;
+    std::size_t dense_threshold;
+    std::size_t max_iter;
+    ScalarType lambda;
+
+  private:
+    bool use_dense_;
+    VectorType r_;
+    MatrixType J_;
+    std::vector<ScalarType> A_;
+    std::vector<ScalarType> b_;
+    ScalarType gp_;
+    ScalarType pGp_;
+    ScalarType nu_;
+    bool is_scaled_;
+    bool has_prediction_;
+    unsigned int last_iter_;
+};
+
+}
+
+#endif
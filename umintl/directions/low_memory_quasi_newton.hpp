@@ -22,7 +22,7 @@ namespace umintl{
 
 template<class BackendType>
 struct low_memory_quasi_newton : public direction<BackendType>{
-    low_memory_quasi_newton(unsigned int _m = 4) : m(_m) { }
+    low_memory_quasi_newton(unsigned int _m = 4) : m(_m), N_(0), q_(), r_(), n_valid_pairs_(0), is_seeded_(false) { }
     unsigned int m;
 
     typedef typename BackendType::ScalarType ScalarType;
@@ -51,6 +51,7 @@ public:
             vecs_[i].y = BackendType::create_vector(N_);
         }
         n_valid_pairs_ = 0;
+        is_seeded_ = false;
     }
 
     virtual void clean(optimization_context<BackendType> &){
@@ -67,27 +68,74 @@ public:
         return "Low memory quasi-newton";
     }
 
+    virtual void save_state(optimization_context<BackendType> &, tools::state_writer & writer) const{
+        writer.write(m);
+        writer.write(n_valid_pairs_);
+        for(unsigned int i = 0 ; i < n_valid_pairs_ ; ++i){
+            writer.write_vector<ScalarType>(vecs_[i].s,N_);
+            writer.write_vector<ScalarType>(vecs_[i].y,N_);
+        }
+    }
+
+    virtual void load_state(optimization_context<BackendType> &, tools::state_reader & reader){
+        if(reader.read<unsigned int>() != m)
+            throw exceptions::io_error("Incompatible state : different memory size");
+        n_valid_pairs_ = reader.read<unsigned int>();
+        for(unsigned int i = 0 ; i < n_valid_pairs_ ; ++i){
+            reader.read_vector<ScalarType>(s(i),N_);
+            reader.read_vector<ScalarType>(y(i),N_);
+        }
+        is_seeded_ = false;
+    }
+
+    /** @brief The (s,y) history. The initial scaling is recomputed from the most recent pair */
+    virtual bool export_curvature(optimization_context<BackendType> &, tools::state_writer & writer) const{
+        if(n_valid_pairs_==0)
+            return false;
+        writer.write(n_valid_pairs_);
+        for(unsigned int i = 0 ; i < n_valid_pairs_ ; ++i){
+            writer.write_vector<ScalarType>(vecs_[i].s,N_);
+            writer.write_vector<ScalarType>(vecs_[i].y,N_);
+        }
+        return true;
+    }
+
+    /** @brief Keeps the m most recent pairs if the history was exported with a larger memory */
+    virtual void import_curvature(optimization_context<BackendType> &, tools::state_reader & reader){
+        unsigned int n = reader.read<unsigned int>();
+        n_valid_pairs_ = std::min(n,m);
+        for(unsigned int i = 0 ; i < n_valid_pairs_ ; ++i){
+            reader.read_vector<ScalarType>(s(i),N_);
+            reader.read_vector<ScalarType>(y(i),N_);
+        }
+        is_seeded_ = n_valid_pairs_ > 0;
+    }
+
     void operator()(optimization_context<BackendType> & c){
         std::vector<ScalarType> rhos(m);
         std::vector<ScalarType> alphas(m);
 
         //Algorithm
-        n_valid_pairs_ = std::min(n_valid_pairs_+1,m);
-
-        //Updates storage
-        for(unsigned int i = n_valid_pairs_-1 ; i > 0  ; --i){
-            BackendType::copy(N_,s(i-1), s(i));
-            BackendType::copy(N_,y(i-1), y(i));
+        if(is_seeded_)
+            is_seeded_ = false;
+        else{
+            n_valid_pairs_ = std::min(n_valid_pairs_+1,m);
+
+            //Updates storage
+            for(unsigned int i = n_valid_pairs_-1 ; i > 0  ; --i){
+                BackendType::copy(N_,s(i-1), s(i));
+                BackendType::copy(N_,y(i-1), y(i));
+            }
+
+            //s(0) = x - xm1;
+            BackendType::copy(N_,c.x(),s(0));
+            BackendType::axpy(N_,-1,c.xm1(),s(0));
+
+            //y(0) = g - gm1;
+            BackendType::copy(N_,c.g(),y(0));
+            BackendType::axpy(N_,-1,c.gm1(),y(0));
         }
 
-        //s(0) = x - xm1;
-        BackendType::copy(N_,c.x(),s(0));
-        BackendType::axpy(N_,-1,c.xm1(),s(0));
-
-        //y(0) = g - gm1;
-        BackendType::copy(N_,c.g(),y(0));
-        BackendType::axpy(N_,-1,c.gm1(),y(0));
-
 
         BackendType::copy(N_,c.g(),q_);
         int i = 0;
@@ -122,6 +170,7 @@ private:
     VectorType r_;
     std::vector<storage_pair> vecs_;
     unsigned int n_valid_pairs_;
+    bool is_seeded_;
 };
 
 }
@@ -0,0 +1,286 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+
+#ifndef UMINTL_DIRECTIONS_OUT_OF_CORE_QUASI_NEWTON_HPP_
+#define UMINTL_DIRECTIONS_OUT_OF_CORE_QUASI_NEWTON_HPP_
+
+#include <string>
+#include <cmath>
+#include <algorithm>
+
+#include "umintl/optimization_context.hpp"
+#include "umintl/tools/mapped_file.hpp"
+#include "umintl/tools/shared_ptr.hpp"
+#include "umintl/tools/serialization.hpp"
+#include "umintl/tools/exception.hpp"
+
+#include "forwards.h"
+
+namespace umintl{
+
+/** @brief The out-of-core quasi-newton class
+ *
+ *  Same direction as quasi_newton, for problems whose NxN inverse hessian approximation does not fit in memory. H is kept in a
+ *  memory-mapped scratch file, as the lower triangle of a grid of TxT tiles stored contiguously, and is streamed once per
+ *  iteration :
+ *  the update of the previous iteration (scaling and rank-2 update) is applied lazily, tile by tile, during the pass which computes
+ *  H*y and H*g. The new direction is then obtained from these products without touching H again, since
+ *  (gamma*H + alpha*(s*hy' + hy*s') + beta*s*s')*g only involves H*g. The next tiles are prefetched, and the updated ones are
+ *  written back asynchronously, so that the throughput is bounded by the sequential bandwidth of the disk.
+ *
+ *  Requires a host backend. The file takes ceil(N/T)*(ceil(N/T)+1)/2*T*T scalars, about half of the dense matrix. The checkpoints
+ *  and the exported curvature contain the whole file, along with the pending update.
+ */
+template<class BackendType>
+struct out_of_core_quasi_newton : public direction<BackendType>{
+    typedef typename BackendType::ScalarType ScalarType;
+    typedef typename BackendType::VectorType VectorType;
+
+    /** @brief The constructor
+     *
+     *  @param _path path of the scratch file. Created by init, and removed by clean.
+     *  @param _tile_size size of the tiles. The default tile of 256x256 doubles (512KB) fits in a typical L2 cache.
+     *  @param _readahead number of tiles prefetched ahead of the current one
+     */
+    out_of_core_quasi_newton(std::string const & _path, std::size_t _tile_size = 256, std::size_t _readahead = 16) : path(_path), tile_size(std::max(_tile_size,(std::size_t)1)), readahead(std::max(_readahead,(std::size_t)1))
+      , N_(0), n_tiles_(0), H_(NULL), s_(), y_(), Hy_(), Hg_(), pending_s_(), pending_hy_(), pending_gamma_(1), pending_alpha_(0), pending_beta_(0)
+      , has_pending_(false), is_identity_(true), is_seeded_(false){ }
+
+    virtual std::string info() const{
+        return "Out-of-core Quasi-Newton";
+    }
+
+    virtual void init(optimization_context<BackendType> & c){
+        N_ = c.N();
+        n_tiles_ = (N_ + tile_size - 1)/tile_size;
+        file_.reset(new tools::scratch_mapped_file(path, n_tiles_*(n_tiles_+1)/2*tile_bytes()));
+        file_->advise(0, file_->size(), tools::mapped_file::ADVICE_SEQUENTIAL);
+        H_ = reinterpret_cast<ScalarType *>(file_->data());
+
+        s_ = BackendType::create_vector(N_);
+        y_ = BackendType::create_vector(N_);
+        Hy_ = BackendType::create_vector(N_);
+        Hg_ = BackendType::create_vector(N_);
+        pending_s_ = BackendType::create_vector(N_);
+        pending_hy_ = BackendType::create_vector(N_);
+        has_pending_ = false;
+        is_identity_ = true;
+        is_seeded_ = false;
+    }
+
+    virtual void clean(optimization_context<BackendType> &){
+        BackendType::delete_if_dynamically_allocated(s_);
+        BackendType::delete_if_dynamically_allocated(y_);
+        BackendType::delete_if_dynamically_allocated(Hy_);
+        BackendType::delete_if_dynamically_allocated(Hg_);
+        BackendType::delete_if_dynamically_allocated(pending_s_);
+        BackendType::delete_if_dynamically_allocated(pending_hy_);
+        file_.reset();
+    }
+
+    virtual void save_state(optimization_context<BackendType> &, tools::state_writer & writer) const{
+        write_curvature(writer);
+    }
+
+    virtual void load_state(optimization_context<BackendType> &, tools::state_reader & reader){
+        read_curvature(reader);
+        is_seeded_ = false;
+    }
+
+    /** @brief The tiles of H and its pending update */
+    virtual bool export_curvature(optimization_context<BackendType> &, tools::state_writer & writer) const{
+        if(!has_pending_)
+            return false;
+        write_curvature(writer);
+        return true;
+    }
+
+    virtual void import_curvature(optimization_context<BackendType> & c, tools::state_reader & reader){
+        load_state(c, reader);
+        is_seeded_ = true;
+    }
+
+    void operator()(optimization_context<BackendType> & c){
+        if(is_seeded_){
+            //No previous iterate : the pending update is applied on its own, and p = -H*g
+            BackendType::set_to_value(y_,0,N_);
+            stream(c.g());
+            //The next pass only computes the products with the tiles
+            pending_gamma_ = 1;
+            pending_alpha_ = 0;
+            pending_beta_ = 0;
+            BackendType::copy(N_,Hg_,c.p());
+            BackendType::scale(N_,-1,c.p());
+            is_seeded_ = false;
+            return;
+        }
+
+        //s = x - xm1, y = g - gm1
+        BackendType::copy(N_,c.x(),s_);
+        BackendType::axpy(N_,-1,c.xm1(),s_);
+        BackendType::copy(N_,c.g(),y_);
+        BackendType::axpy(N_,-1,c.gm1(),y_);
+
+        //Hy = H*y, Hg = H*g, with the update of the previous iteration applied to H
+        if(has_pending_)
+            stream(c.g());
+        else{
+            BackendType::copy(N_,y_,Hy_);
+            BackendType::copy(N_,c.g(),Hg_);
+        }
+
+        ScalarType ys = BackendType::dot(N_,s_,y_);
+        ScalarType gamma = 1;
+        {
+            ScalarType yHy = BackendType::dot(N_,y_,Hy_);
+            ScalarType sg = BackendType::dot(N_,s_,c.gm1());
+            ScalarType gHy = BackendType::dot(N_,c.gm1(),Hy_);
+            if(ys/yHy>1)
+              gamma = ys/yHy;
+            else if(sg/gHy<1)
+               gamma = sg/gHy;
+            else
+                gamma = 1;
+        }
+
+        //The update H <- gamma*H + alpha*(s*hy' + hy*s') + beta*s*s', with hy = gamma*H*y, is deferred to the next pass
+        BackendType::copy(N_,Hy_,pending_hy_);
+        BackendType::scale(N_,gamma,pending_hy_);
+        BackendType::copy(N_,s_,pending_s_);
+        ScalarType yHy = BackendType::dot(N_,y_,pending_hy_);
+        pending_gamma_ = gamma;
+        pending_alpha_ = -1/ys;
+        pending_beta_ = 1/ys + yHy/std::pow(ys,2);
+        has_pending_ = true;
+
+        //p = -(gamma*H*g + alpha*(s*(hy'g) + hy*(s'g)) + beta*s*(s'g))
+        ScalarType hyg = BackendType::dot(N_,pending_hy_,c.g());
+        ScalarType sg = BackendType::dot(N_,pending_s_,c.g());
+        BackendType::copy(N_,Hg_,c.p());
+        BackendType::scale(N_,-gamma,c.p());
+        BackendType::axpy(N_,-(pending_alpha_*hyg + pending_beta_*sg),pending_s_,c.p());
+        BackendType::axpy(N_,-pending_alpha_*sg,pending_hy_,c.p());
+    }
+
+    std::string path;
+    std::size_t tile_size;
+    std::size_t readahead;
+
+private:
+    std::size_t tile_bytes() const { return tile_size*tile_size*sizeof(ScalarType); }
+    std::size_t n_stored() const { return n_tiles_*(n_tiles_+1)/2; }
+
+    void write_curvature(tools::state_writer & writer) const{
+        writer.write<unsigned long long>(tile_size);
+        writer.write(is_identity_);
+        writer.write(has_pending_);
+        if(!is_identity_)
+            writer.write_vector<ScalarType>(H_,n_stored()*tile_size*tile_size);
+        if(has_pending_){
+            writer.write_vector<ScalarType>(pending_s_,N_);
+            writer.write_vector<ScalarType>(pending_hy_,N_);
+            writer.write(pending_gamma_);
+            writer.write(pending_alpha_);
+            writer.write(pending_beta_);
+        }
+    }
+
+    void read_curvature(tools::state_reader & reader){
+        if(reader.read<unsigned long long>() != tile_size)
+            throw exceptions::incompatible_parameters("The curvature was saved with another tile size");
+        is_identity_ = reader.read<bool>();
+        has_pending_ = reader.read<bool>();
+        if(!is_identity_)
+            reader.read_vector<ScalarType>(H_,n_stored()*tile_size*tile_size);
+        if(has_pending_){
+            reader.read_vector<ScalarType>(pending_s_,N_);
+            reader.read_vector<ScalarType>(pending_hy_,N_);
+            pending_gamma_ = reader.read<ScalarType>();
+            pending_alpha_ = reader.read<ScalarType>();
+            pending_beta_ = reader.read<ScalarType>();
+        }
+    }
+
+    /** @brief Applies the pending update to H, tile by tile, and accumulates Hy_ = H*y_ and Hg_ = H*g with the updated tiles */
+    void stream(VectorType const & g){
+        BackendType::set_to_value(Hy_,0,N_);
+        BackendType::set_to_value(Hg_,0,N_);
+        std::size_t T = tile_size;
+        std::size_t k = 0;
+        prefetch(0);
+        for(std::size_t I = 0 ; I < n_tiles_ ; ++I){
+            for(std::size_t J = 0 ; J <= I ; ++J, ++k){
+                //Prefetches the next window of tiles, and starts writing back the previous one
+                if(k % readahead == 0){
+                    prefetch(k + readahead);
+                    if(k >= readahead)
+                        file_->sync_async((k-readahead)*tile_bytes(), readahead*tile_bytes());
+                }
+                update_tile(I, J, H_ + k*T*T, g);
+            }
+        }
+        is_identity_ = false;
+    }
+
+    /** @brief Prefetches the window of tiles starting at the first-th one. Not needed while H is the implicit identity */
+    void prefetch(std::size_t first){
+        if(is_identity_ || first >= n_stored())
+            return;
+        file_->advise(first*tile_bytes(), std::min(readahead, n_stored()-first)*tile_bytes(), tools::mapped_file::ADVICE_WILLNEED);
+    }
+
+    void update_tile(std::size_t I, std::size_t J, ScalarType * tile, VectorType const & g){
+        std::size_t T = tile_size;
+        std::size_t row_begin = I*T, row_end = std::min(row_begin+T, N_);
+        std::size_t col_begin = J*T, col_end = std::min(col_begin+T, N_);
+        ScalarType gamma = pending_gamma_, alpha = pending_alpha_, beta = pending_beta_;
+        for(std::size_t i = row_begin ; i < row_end ; ++i){
+            ScalarType * row = tile + (i-row_begin)*T;
+            ScalarType si = pending_s_[i], hyi = pending_hy_[i];
+            ScalarType yi = y_[i], gi = g[i];
+            ScalarType Hyi = 0, Hgi = 0;
+            for(std::size_t j = col_begin ; j < col_end ; ++j){
+                ScalarType h = is_identity_?(ScalarType)(i==j):row[j-col_begin];
+                h = gamma*h + alpha*(si*pending_hy_[j] + hyi*pending_s_[j]) + beta*si*pending_s_[j];
+                row[j-col_begin] = h;
+                Hyi += h*y_[j];
+                Hgi += h*g[j];
+                //The upper triangle is the transpose of the off-diagonal tiles
+                if(I!=J){
+                    Hy_[j] += h*yi;
+                    Hg_[j] += h*gi;
+                }
+            }
+            Hy_[i] += Hyi;
+            Hg_[i] += Hgi;
+        }
+    }
+
+    std::size_t N_;
+    std::size_t n_tiles_;
+    tools::shared_ptr<tools::scratch_mapped_file> file_;
+    ScalarType * H_;
+
+    VectorType s_;
+    VectorType y_;
+    VectorType Hy_;
+    VectorType Hg_;
+
+    VectorType pending_s_;
+    VectorType pending_hy_;
+    ScalarType pending_gamma_;
+    ScalarType pending_alpha_;
+    ScalarType pending_beta_;
+    bool has_pending_;
+    bool is_identity_;
+    bool is_seeded_;
+};
+
+}
+
+#endif
@@ -0,0 +1,251 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+
+#ifndef UMINTL_DIRECTIONS_PARTITIONED_QUASI_NEWTON_HPP_
+#define UMINTL_DIRECTIONS_PARTITIONED_QUASI_NEWTON_HPP_
+
+#include <vector>
+#include <cmath>
+
+#include "umintl/linear/conjugate_gradient.hpp"
+#include "umintl/partially_separable.hpp"
+#include "umintl/optimization_context.hpp"
+
+#include "forwards.h"
+
+namespace umintl{
+
+/** @brief The partitioned quasi-newton class
+ *
+ *  Griewank & Toint's partitioned BFGS for partially separable objectives. A small dense approximation B_i of the hessian of
+ *  each element function is kept, and updated with the element curvature pair (U_i s, grad f_i(x) - grad f_i(xm1)).
+ *  The memory requirement is O(sum_i n_i^2) instead of O(N^2). Element functions need not be convex : the update of
+ *  a block is skipped when its curvature pair is not positive, which keeps each B_i positive definite. The direction solves
+ *  (sum_i U_i' B_i U_i) p = -g with the linear conjugate gradient.
+ */
+template<class BackendType>
+struct partitioned_quasi_newton : public direction<BackendType>{
+    typedef typename BackendType::ScalarType ScalarType;
+    typedef typename BackendType::VectorType VectorType;
+
+private:
+    /** @brief Product with the partitioned matrix, evaluated color by color so that the scattering is conflict-free */
+    struct compute_Ab : public linear::conjugate_gradient_detail::compute_Ab<BackendType>{
+        compute_Ab(partitioned_quasi_newton const & parent) : parent_(parent){ }
+        void operator()(std::size_t N, VectorType const & b, VectorType & res){
+            partially_separable_function<BackendType> const & f = parent_.fun_;
+            for(std::size_t i = 0 ; i < N ; ++i)
+                res[i] = 0;
+            for(std::size_t c = 0 ; c < f.n_colors() ; ++c){
+                std::vector<std::size_t> const & elements = f.elements_of_color(c);
+                long n_elements = elements.size();
+                #ifdef _OPENMP
+                #pragma omp parallel for
+                #endif
+                for(long k = 0 ; k < n_elements ; ++k){
+                    std::size_t e = elements[k];
+                    std::vector<std::size_t> const & idx = f.indices(e);
+                    ScalarType const * B = &parent_.B_[parent_.block_offsets_[e]];
+                    for(std::size_t i = 0 ; i < idx.size() ; ++i){
+                        ScalarType sum = 0;
+                        for(std::size_t j = 0 ; j < idx.size() ; ++j)
+                            sum += B[i*idx.size()+j]*b[idx[j]];
+                        res[idx[i]] += sum;
+                    }
+                }
+            }
+        }
+    private:
+        partitioned_quasi_newton const & parent_;
+    };
+
+    /** @brief BFGS update of the block B (of size n) with the pair (s,y) */
+    static void update_block(std::size_t n, ScalarType * B, ScalarType const * s, ScalarType const * y, bool first){
+        std::vector<ScalarType> Bs(n);
+        ScalarType ss = 0, sy = 0, yy = 0;
+        for(std::size_t i = 0 ; i < n ; ++i){
+            ss += s[i]*s[i];
+            sy += s[i]*y[i];
+            yy += y[i]*y[i];
+        }
+        //This element is not affected by the step
+        if(ss==0)
+            return;
+        if(first && sy > 0){
+            for(std::size_t i = 0 ; i < n*n ; ++i)
+                B[i] *= yy/sy;
+        }
+        ScalarType sBs = 0;
+        for(std::size_t i = 0 ; i < n ; ++i){
+            Bs[i] = 0;
+            for(std::size_t j = 0 ; j < n ; ++j)
+                Bs[i] += B[i*n+j]*s[j];
+            sBs += s[i]*Bs[i];
+        }
+        //Negative curvature of a non-convex element : the update is skipped to keep the block positive definite
+        if(sy <= 1e-8*std::sqrt(ss*yy))
+            return;
+        //B += y*y'/(s'y) - Bs*Bs'/(s'Bs)
+        for(std::size_t i = 0 ; i < n ; ++i)
+            for(std::size_t j = 0 ; j < n ; ++j)
+                B[i*n+j] += y[i]*y[j]/sy - Bs[i]*Bs[j]/sBs;
+    }
+
+    /** @brief Element gradients at x, kept by the last evaluation of the function if it was at x
+     *
+     *  Otherwise, the function is evaluated at x through the function wrapper, so that the evaluation is accounted for.
+     */
+    void element_gradients_at(optimization_context<BackendType> & c, VectorType const & x, std::vector<ScalarType> & res){
+        if(fun_.last_element_gradients(x, res))
+            return;
+        ScalarType value;
+        VectorType g = BackendType::create_vector(N_);
+        c.fun().compute_value_gradient(x, value, g, c.model().get_value_gradient_tag());
+        BackendType::delete_if_dynamically_allocated(g);
+        if(!fun_.last_element_gradients(x, res))
+            throw exceptions::incompatible_parameters("The partitioned quasi-newton direction must minimize the partially separable function it was constructed with");
+    }
+
+public:
+    /** @brief The constructor
+     *
+     *  @param fun the partially separable objective being minimized
+     *  @param _max_iter maximum number of linear conjugate gradient iterations. Defaults to the dimension of the problem.
+     */
+    partitioned_quasi_newton(partially_separable_function<BackendType> const & fun, std::size_t _max_iter = 0) : max_iter(_max_iter), fun_(fun){ }
+
+    virtual std::string info() const{
+        return "Partitioned Quasi-Newton";
+    }
+
+    virtual void init(optimization_context<BackendType> & c){
+        N_ = c.N();
+        block_offsets_.resize(fun_.n_elements()+1);
+        block_offsets_[0] = 0;
+        for(std::size_t e = 0 ; e < fun_.n_elements() ; ++e)
+            block_offsets_[e+1] = block_offsets_[e] + fun_.indices(e).size()*fun_.indices(e).size();
+        B_.assign(block_offsets_.back(), 0);
+        for(std::size_t e = 0 ; e < fun_.n_elements() ; ++e){
+            std::size_t n = fun_.indices(e).size();
+            for(std::size_t i = 0 ; i < n ; ++i)
+                B_[block_offsets_[e]+i*n+i] = 1;
+        }
+        is_first_update_ = true;
+        last_iter_ = 0;
+        has_restored_ge_ = false;
+        ge_.clear();
+        gem1_.clear();
+    }
+
+    virtual void clean(optimization_context<BackendType> &){
+        B_.clear();
+        ge_.clear();
+        gem1_.clear();
+    }
+
+    /** @brief The element matrices, and the element gradients at xm1 and x when they are known
+     *
+     *  The element gradients at x are kept by the function rather than by the direction : they are saved as well, so that a
+     *  resumed minimization does not evaluate the function again at x.
+     */
+    virtual void save_state(optimization_context<BackendType> & c, tools::state_writer & writer) const{
+        writer.write_vector<ScalarType>(B_,B_.size());
+        writer.write(is_first_update_);
+        writer.write(last_iter_);
+        writer.write(!gem1_.empty());
+        if(!gem1_.empty())
+            writer.write_vector<ScalarType>(gem1_,gem1_.size());
+        std::vector<ScalarType> ge;
+        bool has_ge = fun_.last_element_gradients(c.x(), ge);
+        writer.write(has_ge);
+        if(has_ge)
+            writer.write_vector<ScalarType>(ge,ge.size());
+    }
+
+    virtual void load_state(optimization_context<BackendType> & c, tools::state_reader & reader){
+        reader.read_vector<ScalarType>(B_,B_.size());
+        is_first_update_ = reader.read<bool>();
+        last_iter_ = reader.read<unsigned int>();
+        gem1_.clear();
+        if(reader.read<bool>()){
+            gem1_.resize(fun_.elements_size());
+            reader.read_vector<ScalarType>(gem1_,gem1_.size());
+        }
+        has_restored_ge_ = reader.read<bool>();
+        if(has_restored_ge_){
+            ge_.resize(fun_.elements_size());
+            reader.read_vector<ScalarType>(ge_,ge_.size());
+        }
+        restored_iter_ = c.iter();
+    }
+
+    void operator()(optimization_context<BackendType> & c){
+        //x is the last point evaluated by the line-search. The element gradients at xm1 are only known if this direction
+        //was used at the previous iteration
+        if(!has_restored_ge_ || restored_iter_ != c.iter())
+            element_gradients_at(c, c.x(), ge_);
+        has_restored_ge_ = false;
+        if(gem1_.empty() || last_iter_+1 != c.iter())
+            element_gradients_at(c, c.xm1(), gem1_);
+        last_iter_ = c.iter();
+
+        long n_elements = fun_.n_elements();
+        #ifdef _OPENMP
+        #pragma omp parallel for
+        #endif
+        for(long e = 0 ; e < n_elements ; ++e){
+            std::vector<std::size_t> const & idx = fun_.indices(e);
+            std::size_t offset = fun_.offset(e);
+            std::vector<ScalarType> s(idx.size());
+            std::vector<ScalarType> y(idx.size());
+            for(std::size_t j = 0 ; j < idx.size() ; ++j){
+                s[j] = c.x()[idx[j]] - c.xm1()[idx[j]];
+                y[j] = ge_[offset+j] - gem1_[offset+j];
+            }
+            update_block(idx.size(), &B_[block_offsets_[e]], &s[0], &y[0], is_first_update_);
+        }
+        is_first_update_ = false;
+        ge_.swap(gem1_);
+
+        std::size_t max_cg_iter = max_iter?max_iter:N_;
+        linear::conjugate_gradient<BackendType> solver(max_cg_iter, new compute_Ab(*this));
+        ScalarType nrm_g = BackendType::nrm2(N_,c.g());
+        solver.stop = new linear::conjugate_gradient_detail::residual_norm<BackendType>(std::min((ScalarType)0.5,std::sqrt(nrm_g))*nrm_g);
+
+        VectorType minus_g = BackendType::create_vector(N_);
+        VectorType zero = BackendType::create_vector(N_);
+        BackendType::copy(N_,c.g(),minus_g);
+        BackendType::scale(N_,-1,minus_g);
+        BackendType::set_to_value(zero,0,N_);
+
+        typename linear::conjugate_gradient<BackendType>::optimization_result res = solver(N_,zero,minus_g,c.p());
+        if(res.i==0 && res.ret == linear::conjugate_gradient<BackendType>::FAILURE_NON_POSITIVE_DEFINITE)
+            BackendType::copy(N_,minus_g,c.p());
+
+        BackendType::delete_if_dynamically_allocated(minus_g);
+        BackendType::delete_if_dynamically_allocated(zero);
+    }
+
+    std::size_t max_iter;
+
+private:
+    partially_separable_function<BackendType> const & fun_;
+    std::size_t N_;
+    std::vector<std::size_t> block_offsets_;
+    std::vector<ScalarType> B_;
+    std::vector<ScalarType> ge_;
+    std::vector<ScalarType> gem1_;
+    bool is_first_update_;
+    bool has_restored_ge_;
+    unsigned int restored_iter_;
+    unsigned int last_iter_;
+};
+
+}
+
+#endif
@@ -26,7 +26,6 @@ template<class BackendType>
 struct quasi_newton : public direction<BackendType>{
     typedef typename BackendType::ScalarType ScalarType;
     typedef typename BackendType::VectorType VectorType;
-    typedef typename BackendType::MatrixType MatrixType;
 
     virtual std::string info() const{
         return "Quasi-Newton";
@@ -35,12 +34,13 @@ struct quasi_newton : public direction<BackendType>{
     virtual void init(optimization_context<BackendType> & c)
     {
         reinitialize_ = true;
+        is_seeded_ = false;
 
         N_ = c.N();
         Hy_ = BackendType::create_vector(N_);
         s_ = BackendType::create_vector(N_);
         y_ = BackendType::create_vector(N_);
-        H_ = BackendType::create_matrix(N_, N_);
+        H_ = BackendType::create_vector(N_*(N_+1)/2);
 
         BackendType::set_to_value(Hy_,0,N_);
         BackendType::set_to_value(s_,0,N_);
@@ -56,7 +56,38 @@ struct quasi_newton : public direction<BackendType>{
         BackendType::delete_if_dynamically_allocated(H_);
     }
 
+    virtual void save_state(optimization_context<BackendType> &, tools::state_writer & writer) const{
+        writer.write(reinitialize_);
+        writer.write_vector<ScalarType>(H_,N_*(N_+1)/2);
+    }
+
+    virtual void load_state(optimization_context<BackendType> &, tools::state_reader & reader){
+        reinitialize_ = reader.read<bool>();
+        reader.read_vector<ScalarType>(H_,N_*(N_+1)/2);
+        is_seeded_ = false;
+    }
+
+    /** @brief The inverse hessian approximation */
+    virtual bool export_curvature(optimization_context<BackendType> &, tools::state_writer & writer) const{
+        if(reinitialize_)
+            return false;
+        writer.write_vector<ScalarType>(H_,N_*(N_+1)/2);
+        return true;
+    }
+
+    virtual void import_curvature(optimization_context<BackendType> &, tools::state_reader & reader){
+        reader.read_vector<ScalarType>(H_,N_*(N_+1)/2);
+        reinitialize_ = false;
+        is_seeded_ = true;
+    }
+
     void operator()(optimization_context<BackendType> & c){
+      if(is_seeded_){
+        BackendType::spmv(N_,-1,H_,c.g(),0,c.p());
+        is_seeded_ = false;
+        return;
+      }
+
       //s = x - xm1;
       BackendType::copy(N_,c.x(),s_);
       BackendType::axpy(N_,-1,c.xm1(),s_);
@@ -68,13 +99,13 @@ struct quasi_newton : public direction<BackendType>{
       ScalarType ys = BackendType::dot(N_,s_,y_);
 
       if(reinitialize_)
-        BackendType::set_to_diagonal(N_,H_,1);
+        BackendType::set_to_diagonal_packed(N_,H_,1);
 
       ScalarType gamma = 1;
+      BackendType::spmv(N_,1,H_,y_,0,Hy_);
+      ScalarType yHy = BackendType::dot(N_,y_,Hy_);
 
       {
-          BackendType::symv(N_,1,H_,y_,0,Hy_);
-          ScalarType yHy = BackendType::dot(N_,y_,Hy_);
           ScalarType sg = BackendType::dot(N_,s_,c.gm1());
           ScalarType gHy = BackendType::dot(N_,c.gm1(),Hy_);
           if(ys/yHy>1)
@@ -85,19 +116,20 @@ struct quasi_newton : public direction<BackendType>{
               gamma = 1;
       }
 
-      BackendType::scale(N_,N_,gamma,H_);
-      BackendType::symv(N_,1,H_,y_,0,Hy_);
-      ScalarType yHy = BackendType::dot(N_,y_,Hy_);
+      //H*y is scaled along with H, instead of being computed again
+      BackendType::scale(N_*(N_+1)/2,gamma,H_);
+      BackendType::scale(N_,gamma,Hy_);
+      yHy *= gamma;
 
       //quasi_newton UPDATE
       //H_ += alpha*(s_*Hy' + Hy*s_') + beta*s_*s_';
       ScalarType alpha = -1/ys;
       ScalarType beta = 1/ys + yHy/pow(ys,2);
-      BackendType::syr2(N_,alpha,s_,Hy_,H_);
-      BackendType::syr1(N_,beta,s_,H_);
+      BackendType::spr2(N_,alpha,s_,Hy_,H_);
+      BackendType::spr1(N_,beta,s_,H_);
 
       //p = -H_*g
-      BackendType::symv(N_,-1,H_,c.g(),0,c.p());
+      BackendType::spmv(N_,-1,H_,c.g(),0,c.p());
 
       if(reinitialize_)
           reinitialize_=false;
@@ -111,9 +143,11 @@ private:
     VectorType s_;
     VectorType y_;
 
-    MatrixType H_;
+    //Inverse hessian approximation, in packed symmetric storage
+    VectorType H_;
 
     bool reinitialize_;
+    bool is_seeded_;
 
 };
 
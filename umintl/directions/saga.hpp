@@ -0,0 +1,195 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+
+#ifndef UMINTL_DIRECTIONS_SAGA_HPP_
+#define UMINTL_DIRECTIONS_SAGA_HPP_
+
+#include <vector>
+
+#include "umintl/optimization_context.hpp"
+#include "umintl/directions/step_size.hpp"
+#include "umintl/tools/exception.hpp"
+
+#include "umintl/tools/shared_ptr.hpp"
+#include "umintl/directions/forwards.h"
+
+
+namespace umintl{
+
+namespace tag{
+
+namespace saga{
+
+enum storage{
+    /** One gradient per sample. Requires O(dataset_size*N) memory and one evaluation per sample of the mini-batch. */
+    STORE_GRADIENTS,
+    /** Linear models f(x) = 1/D sum_i phi_i(a_i'x) : one scalar phi_i'(a_i'x) per sample. Requires the umintl::sample_derivatives
+     *  and umintl::sample_combination overloads */
+    STORE_LINEAR_DERIVATIVES
+};
+
+}
+
+}
+
+/** @brief The SAGA class
+ *
+ *  Defazio et al. (2014) : "SAGA: A Fast Incremental Gradient Method With Support for Non-Strongly Convex Composite Objectives".
+ *  The last gradient computed for each sample is kept in a table, along with its average. The direction uses the mini-batch
+ *  given by the value_gradient tag of the model :
+ *  p = -eta*(1/S sum_{i in batch} (g_i(x) - table_i) + average(table)), after which table_i = g_i(x) for i in the batch.
+ *
+ *  The table is updated by the evaluation at each new iterate (see direction::evaluate), from which the mini-batch value and
+ *  gradient are derived : each iteration evaluates the samples of the batch once.
+ *
+ *  For linear models, the compact storage only keeps phi_i'(a_i'x), which requires an overload of
+ *  void operator()(VectorType const & X, ScalarType & value, VectorType & derivatives, umintl::sample_derivatives)
+ *  filling derivatives[k] = phi_{offset+k}'(a_{offset+k}'X) for k < sample_size and value = 1/sample_size sum_k phi_{offset+k}(a_{offset+k}'X),
+ *  and an overload of
+ *  void operator()(VectorType const & weights, VectorType & res, umintl::sample_combination)
+ *  computing res = sum_k weights[k]*a_{offset+k}.
+ */
+template<class BackendType>
+struct saga : public direction<BackendType>{
+    typedef typename BackendType::VectorType VectorType;
+    typedef typename BackendType::ScalarType ScalarType;
+
+private:
+    void check_tag(value_gradient const & tag) const{
+        if(tag.model!=STOCHASTIC || tag.offset + tag.sample_size > dataset_size)
+            throw exceptions::incompatible_parameters("SAGA requires a stochastic model whose samples lie in the dataset");
+    }
+
+    /** @brief Evaluates the samples of the batch one by one. Their mean is the value and the gradient, and the average correction
+     *  1/S sum_{i in batch} (g_i(x) - table_i) is kept in correction_ */
+    void evaluate_gradients(optimization_context<BackendType> & c, std::size_t S, std::size_t offset){
+        std::size_t N = c.N();
+        ScalarType value;
+        c.val() = 0;
+        BackendType::set_to_value(c.g(),0,N);
+        BackendType::set_to_value(correction_,0,N);
+        for(std::size_t k = 0 ; k < S ; ++k){
+            ScalarType * table_i = &table_[(offset+k)*N];
+            c.fun().compute_value_gradient(c.x(),value,tmp_,value_gradient(STOCHASTIC,1,offset+k));
+            c.val() += value/S;
+            for(std::size_t n = 0 ; n < N ; ++n){
+                c.g()[n] += tmp_[n]/S;
+                correction_[n] += (tmp_[n] - table_i[n])/S;
+                table_i[n] = tmp_[n];
+            }
+        }
+    }
+
+    /** @brief The gradient and the correction are both combinations of the samples, weighted by phi_i'/S and (phi_i' - table_i)/S */
+    void evaluate_linear_derivatives(optimization_context<BackendType> & c, std::size_t S, std::size_t offset){
+        VectorType weights = BackendType::create_vector(S);
+        c.fun().compute_sample_derivatives(c.x(),c.val(),weights,sample_derivatives(STOCHASTIC,S,offset));
+        for(std::size_t k = 0 ; k < S ; ++k){
+            ScalarType d = weights[k];
+            weights[k] = (d - table_[offset+k])/S;
+            table_[offset+k] = d;
+        }
+        c.fun().compute_sample_combination(weights,correction_,sample_combination(STOCHASTIC,S,offset));
+        for(std::size_t k = 0 ; k < S ; ++k)
+            weights[k] = table_[offset+k]/S;
+        c.fun().compute_sample_combination(weights,c.g(),sample_combination(STOCHASTIC,S,offset));
+        BackendType::delete_if_dynamically_allocated(weights);
+    }
+
+public:
+    /** @brief The constructor
+     *
+     *  @param _eta the step-size schedule
+     *  @param _dataset_size number of samples in the dataset
+     *  @param _storage representation of the table
+     */
+    saga(step_size const & _eta, std::size_t _dataset_size, tag::saga::storage _storage = tag::saga::STORE_GRADIENTS) : eta(_eta), dataset_size(_dataset_size), storage(_storage){ }
+
+    virtual std::string info() const{
+        return "SAGA";
+    }
+
+    virtual bool is_fixed_step() const{
+        return true;
+    }
+
+    virtual void init(optimization_context<BackendType> & c){
+        std::size_t N = c.N();
+        average_ = BackendType::create_vector(N);
+        correction_ = BackendType::create_vector(N);
+        tmp_ = BackendType::create_vector(N);
+        BackendType::set_to_value(average_,0,N);
+        if(storage==tag::saga::STORE_GRADIENTS)
+            table_.assign(dataset_size*N,0);
+        else
+            table_.assign(dataset_size,0);
+    }
+
+    virtual void clean(optimization_context<BackendType> &){
+        BackendType::delete_if_dynamically_allocated(average_);
+        BackendType::delete_if_dynamically_allocated(correction_);
+        BackendType::delete_if_dynamically_allocated(tmp_);
+        table_.clear();
+    }
+
+    /** @brief The table, its average, and the correction of the batch evaluated at the current iterate. tmp_ is a temporary */
+    virtual void save_state(optimization_context<BackendType> & c, tools::state_writer & writer) const{
+        writer.write<int>(storage);
+        writer.write<unsigned long long>(dataset_size);
+        writer.write_vector<ScalarType>(table_,table_.size());
+        writer.write_vector<ScalarType>(average_,c.N());
+        writer.write_vector<ScalarType>(correction_,c.N());
+    }
+
+    virtual void load_state(optimization_context<BackendType> & c, tools::state_reader & reader){
+        if(reader.read<int>() != storage)
+            throw exceptions::io_error("Incompatible state : different SAGA storage");
+        if(reader.read<unsigned long long>() != dataset_size)
+            throw exceptions::io_error("Incompatible state : different dataset size");
+        reader.read_vector<ScalarType>(table_,table_.size());
+        reader.read_vector<ScalarType>(average_,c.N());
+        reader.read_vector<ScalarType>(correction_,c.N());
+    }
+
+    /** @brief The per-sample evaluations at the new iterate update the table, and give the mini-batch value and gradient */
+    virtual void evaluate(optimization_context<BackendType> & c){
+        value_gradient tag = c.model().get_value_gradient_tag();
+        check_tag(tag);
+        switch(storage){
+            case tag::saga::STORE_GRADIENTS: evaluate_gradients(c,tag.sample_size,tag.offset); break;
+            case tag::saga::STORE_LINEAR_DERIVATIVES: evaluate_linear_derivatives(c,tag.sample_size,tag.offset); break;
+            default: throw exceptions::incompatible_parameters("Unsupported SAGA storage");
+        }
+    }
+
+    void operator()(optimization_context<BackendType> & c){
+        std::size_t N = c.N();
+        value_gradient tag = c.model().get_value_gradient_tag();
+        check_tag(tag);
+
+        //p = -eta*(correction + old average) ; average += S/D*correction
+        BackendType::copy(N,correction_,c.p());
+        BackendType::axpy(N,1,average_,c.p());
+        BackendType::axpy(N,(ScalarType)tag.sample_size/dataset_size,correction_,average_);
+        BackendType::scale(N,-eta(c.iter()),c.p());
+    }
+
+    step_size eta;
+    std::size_t dataset_size;
+    tag::saga::storage storage;
+
+private:
+    VectorType average_;
+    VectorType correction_;
+    VectorType tmp_;
+    std::vector<ScalarType> table_;
+};
+
+}
+
+#endif
@@ -24,6 +24,10 @@ struct steepest_descent : public direction<BackendType>{
         return "Steepest Descent";
     }
 
+    /** @brief No state besides the optimization context */
+    virtual void save_state(optimization_context<BackendType> &, tools::state_writer &) const { }
+    virtual void load_state(optimization_context<BackendType> &, tools::state_reader &) { }
+
     void operator()(optimization_context<BackendType> & c){
         std::size_t N = c.N();
         BackendType::copy(N,c.g(),c.p());
@@ -0,0 +1,61 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+
+#ifndef UMINTL_DIRECTIONS_STEP_SIZE_HPP_
+#define UMINTL_DIRECTIONS_STEP_SIZE_HPP_
+
+#include <cmath>
+
+#include "umintl/tools/exception.hpp"
+
+namespace umintl{
+
+namespace tag{
+
+namespace step_size{
+
+enum schedule{
+    /** eta_k = eta0 */
+    SCHEDULE_CONSTANT,
+    /** eta_k = eta0/(1 + decay*k) */
+    SCHEDULE_INVERSE,
+    /** eta_k = eta0/sqrt(1 + decay*k) */
+    SCHEDULE_INVERSE_SQRT,
+    /** eta_k = eta0*decay^k */
+    SCHEDULE_EXPONENTIAL
+};
+
+}
+
+}
+
+/** @brief Step-size schedule of the fixed-step directions
+ *
+ *  Fixed-step directions do not rely on a line-search : the step taken at iteration k is given by this schedule.
+ */
+struct step_size{
+    step_size(double _eta0, tag::step_size::schedule _schedule = tag::step_size::SCHEDULE_CONSTANT, double _decay = 0) : eta0(_eta0), schedule(_schedule), decay(_decay){ }
+
+    double operator()(unsigned int k) const{
+        switch(schedule){
+            case tag::step_size::SCHEDULE_CONSTANT: return eta0;
+            case tag::step_size::SCHEDULE_INVERSE: return eta0/(1 + decay*k);
+            case tag::step_size::SCHEDULE_INVERSE_SQRT: return eta0/std::sqrt(1 + decay*k);
+            case tag::step_size::SCHEDULE_EXPONENTIAL: return eta0*std::pow(decay,(double)k);
+            default: throw exceptions::incompatible_parameters("Unsupported step size schedule");
+        }
+    }
+
+    double eta0;
+    tag::step_size::schedule schedule;
+    double decay;
+};
+
+}
+
+#endif
@@ -0,0 +1,103 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+
+#ifndef UMINTL_DIRECTIONS_STOCHASTIC_GRADIENT_HPP_
+#define UMINTL_DIRECTIONS_STOCHASTIC_GRADIENT_HPP_
+
+#include "umintl/optimization_context.hpp"
+#include "umintl/directions/step_size.hpp"
+
+#include "umintl/tools/shared_ptr.hpp"
+#include "umintl/directions/forwards.h"
+
+
+namespace umintl{
+
+namespace tag{
+
+namespace stochastic_gradient{
+
+enum momentum{
+    /** v = mu*v - eta*g ; p = v */
+    MOMENTUM_CLASSICAL,
+    /** v = mu*v - eta*g ; p = mu*v - eta*g. Nesterov's look-ahead, expressed with the gradient at the current iterate only */
+    MOMENTUM_NESTEROV
+};
+
+}
+
+}
+
+/** @brief The stochastic gradient class
+ *
+ *  Gradient descent with (classical or Nesterov) momentum. This is a fixed-step direction : p already contains the step,
+ *  so that the minimizer does not perform any line-search, and each iteration costs exactly one gradient evaluation.
+ */
+template<class BackendType>
+struct stochastic_gradient : public direction<BackendType>{
+    typedef typename BackendType::VectorType VectorType;
+    typedef typename BackendType::ScalarType ScalarType;
+
+    /** @brief The constructor
+     *
+     *  @param _eta the step-size schedule
+     *  @param _mu the momentum. No momentum is used if 0.
+     *  @param _momentum the momentum update
+     */
+    stochastic_gradient(step_size const & _eta, double _mu = 0.9, tag::stochastic_gradient::momentum _momentum = tag::stochastic_gradient::MOMENTUM_CLASSICAL) : eta(_eta), mu(_mu), momentum(_momentum){ }
+
+    virtual std::string info() const{
+        if(momentum==tag::stochastic_gradient::MOMENTUM_NESTEROV)
+            return "Stochastic Gradient [Nesterov]";
+        return "Stochastic Gradient [Momentum]";
+    }
+
+    virtual bool is_fixed_step() const{
+        return true;
+    }
+
+    virtual void init(optimization_context<BackendType> & c){
+        v_ = BackendType::create_vector(c.N());
+        BackendType::set_to_value(v_,0,c.N());
+    }
+
+    virtual void clean(optimization_context<BackendType> &){
+        BackendType::delete_if_dynamically_allocated(v_);
+    }
+
+    virtual void save_state(optimization_context<BackendType> & c, tools::state_writer & writer) const{
+        writer.write_vector<ScalarType>(v_,c.N());
+    }
+
+    virtual void load_state(optimization_context<BackendType> & c, tools::state_reader & reader){
+        reader.read_vector<ScalarType>(v_,c.N());
+    }
+
+    void operator()(optimization_context<BackendType> & c){
+        std::size_t N = c.N();
+        ScalarType eta_k = eta(c.iter());
+        BackendType::scale(N,mu,v_);
+        BackendType::axpy(N,-eta_k,c.g(),v_);
+        BackendType::copy(N,v_,c.p());
+        if(momentum==tag::stochastic_gradient::MOMENTUM_NESTEROV){
+            BackendType::scale(N,mu,c.p());
+            BackendType::axpy(N,-eta_k,c.g(),c.p());
+        }
+    }
+
+    step_size eta;
+    double mu;
+    tag::stochastic_gradient::momentum momentum;
+
+private:
+    VectorType v_;
+};
+
+}
+
+#endif
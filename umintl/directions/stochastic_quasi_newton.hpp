@@ -0,0 +1,222 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+
+#ifndef UMINTL_DIRECTIONS_STOCHASTIC_QUASI_NEWTON_HPP_
+#define UMINTL_DIRECTIONS_STOCHASTIC_QUASI_NEWTON_HPP_
+
+#include <vector>
+#include <cmath>
+
+#include "umintl/tools/shared_ptr.hpp"
+#include "umintl/optimization_context.hpp"
+#include "umintl/directions/step_size.hpp"
+
+#include "forwards.h"
+
+namespace umintl{
+
+/** @brief The stochastic quasi-newton class
+ *
+ *  Byrd et al. (2016) : "A Stochastic Quasi-Newton Method for Large-Scale Optimization".
+ *  The iterates are averaged over windows of L iterations. At the end of each window, a curvature pair is built from the
+ *  two last averages : s = xbar_t - xbar_{t-1}, and y = H(xbar_t)s is computed with compute_hv_product on the sub-sample given by the
+ *  hessian-vector product tag of the model. Unlike g - gm1, y is therefore not polluted by the noise of the mini-batch gradients.
+ *  The direction is then -eta*Hg, where H is the L-BFGS approximation built from the m last pairs. This is a fixed-step direction.
+ *
+ *  The hessian-vector products are preferably PROVIDED or computed by CENTERED_DIFFERENCE : with FORWARD_DIFFERENCE, the gradient at xbar_t
+ *  on the samples of the product has to be evaluated as well, since no gradient is otherwise available at xbar_t.
+ */
+template<class BackendType>
+struct stochastic_quasi_newton : public direction<BackendType>{
+    typedef typename BackendType::ScalarType ScalarType;
+    typedef typename BackendType::VectorType VectorType;
+
+    /** @brief The constructor
+     *
+     *  @param _eta the step-size schedule
+     *  @param _L number of iterations between two curvature pairs
+     *  @param _m number of curvature pairs kept in memory
+     */
+    stochastic_quasi_newton(step_size const & _eta, unsigned int _L = 10, unsigned int _m = 10) : eta(_eta), warmup_eta(_eta), L(_L), m(_m){ }
+
+    /** @brief The constructor
+     *
+     *  @param _eta the step-size schedule
+     *  @param _warmup_eta the step-size schedule of the stochastic gradient steps taken until the first curvature pair is available.
+     *                     A quasi-newton step is much better scaled than a gradient step, which often requires a much smaller step size.
+     *  @param _L number of iterations between two curvature pairs
+     *  @param _m number of curvature pairs kept in memory
+     */
+    stochastic_quasi_newton(step_size const & _eta, step_size const & _warmup_eta, unsigned int _L = 10, unsigned int _m = 10) : eta(_eta), warmup_eta(_warmup_eta), L(_L), m(_m){ }
+
+private:
+    struct storage_pair{
+        VectorType s;
+        VectorType y;
+    };
+
+    VectorType & s(std::size_t i) { return vecs_[i].s; }
+    VectorType & y(std::size_t i) { return vecs_[i].y; }
+
+    /** @brief Adds the curvature pair of the window which just ended, if its curvature is positive */
+    void update_pairs(optimization_context<BackendType> & c){
+        BackendType::scale(N_,(ScalarType)1/L,xbar_);
+        if(has_xbarm1_){
+            BackendType::copy(N_,xbar_,candidate_.s);
+            BackendType::axpy(N_,-1,xbarm1_,candidate_.s);
+            //y = ||s||*H(s/||s||) : the averages get close to each other, and the finite differences are more accurate along a unit direction
+            ScalarType nrm_s = BackendType::nrm2(N_,candidate_.s);
+            if(nrm_s > 0){
+                BackendType::scale(N_,1/nrm_s,candidate_.s);
+                hessian_vector_product tag = c.model().get_hv_product_tag();
+                if(c.fun().hessian_vector_product_computation()==FORWARD_DIFFERENCE){
+                    ScalarType dummy;
+                    c.fun().compute_value_gradient(xbar_,dummy,gbar_,value_gradient(tag.model,tag.sample_size,tag.offset));
+                }
+                c.fun().compute_hv_product(xbar_,gbar_,candidate_.s,candidate_.y,tag);
+                BackendType::scale(N_,nrm_s,candidate_.s);
+                BackendType::scale(N_,nrm_s,candidate_.y);
+            }
+
+            ScalarType sy = BackendType::dot(N_,candidate_.s,candidate_.y);
+            ScalarType ss = BackendType::dot(N_,candidate_.s,candidate_.s);
+            if(nrm_s > 0 && sy > 1e-8*ss){
+                //The oldest pair is recycled as the next candidate
+                storage_pair oldest = vecs_.back();
+                for(std::size_t i = m-1 ; i > 0 ; --i)
+                    vecs_[i] = vecs_[i-1];
+                vecs_[0] = candidate_;
+                candidate_ = oldest;
+                n_valid_pairs_ = std::min(n_valid_pairs_+1,m);
+            }
+        }
+        BackendType::copy(N_,xbar_,xbarm1_);
+        BackendType::set_to_value(xbar_,0,N_);
+        has_xbarm1_ = true;
+    }
+
+public:
+    virtual std::string info() const{
+        return "Stochastic quasi-newton";
+    }
+
+    virtual bool is_fixed_step() const{
+        return true;
+    }
+
+    virtual void init(optimization_context<BackendType> & c){
+        N_ = c.N();
+        vecs_.resize(m);
+        for(unsigned int i = 0 ; i < m ; ++i){
+            vecs_[i].s = BackendType::create_vector(N_);
+            vecs_[i].y = BackendType::create_vector(N_);
+        }
+        candidate_.s = BackendType::create_vector(N_);
+        candidate_.y = BackendType::create_vector(N_);
+        q_ = BackendType::create_vector(N_);
+        xbar_ = BackendType::create_vector(N_);
+        xbarm1_ = BackendType::create_vector(N_);
+        gbar_ = BackendType::create_vector(N_);
+        BackendType::set_to_value(xbar_,0,N_);
+        has_xbarm1_ = false;
+        n_valid_pairs_ = 0;
+    }
+
+    virtual void clean(optimization_context<BackendType> &){
+        for(unsigned int i = 0 ; i < m ; ++i){
+            BackendType::delete_if_dynamically_allocated(s(i));
+            BackendType::delete_if_dynamically_allocated(y(i));
+        }
+        vecs_.clear();
+        BackendType::delete_if_dynamically_allocated(candidate_.s);
+        BackendType::delete_if_dynamically_allocated(candidate_.y);
+        BackendType::delete_if_dynamically_allocated(q_);
+        BackendType::delete_if_dynamically_allocated(xbar_);
+        BackendType::delete_if_dynamically_allocated(xbarm1_);
+        BackendType::delete_if_dynamically_allocated(gbar_);
+    }
+
+    /** @brief The curvature pairs, and the averages of the current and the previous windows. The candidate pair, q_ and gbar_ are temporaries */
+    virtual void save_state(optimization_context<BackendType> &, tools::state_writer & writer) const{
+        writer.write(L);
+        writer.write(m);
+        writer.write(n_valid_pairs_);
+        for(unsigned int i = 0 ; i < n_valid_pairs_ ; ++i){
+            writer.write_vector<ScalarType>(vecs_[i].s,N_);
+            writer.write_vector<ScalarType>(vecs_[i].y,N_);
+        }
+        writer.write_vector<ScalarType>(xbar_,N_);
+        writer.write(has_xbarm1_);
+        if(has_xbarm1_)
+            writer.write_vector<ScalarType>(xbarm1_,N_);
+    }
+
+    virtual void load_state(optimization_context<BackendType> &, tools::state_reader & reader){
+        if(reader.read<unsigned int>() != L)
+            throw exceptions::io_error("Incompatible state : different window length");
+        if(reader.read<unsigned int>() != m)
+            throw exceptions::io_error("Incompatible state : different memory size");
+        n_valid_pairs_ = reader.read<unsigned int>();
+        for(unsigned int i = 0 ; i < n_valid_pairs_ ; ++i){
+            reader.read_vector<ScalarType>(s(i),N_);
+            reader.read_vector<ScalarType>(y(i),N_);
+        }
+        reader.read_vector<ScalarType>(xbar_,N_);
+        has_xbarm1_ = reader.read<bool>();
+        if(has_xbarm1_)
+            reader.read_vector<ScalarType>(xbarm1_,N_);
+    }
+
+    void operator()(optimization_context<BackendType> & c){
+        BackendType::axpy(N_,1,c.x(),xbar_);
+        if((c.iter()+1) % L == 0)
+            update_pairs(c);
+
+        //Two-loop recursion
+        std::vector<ScalarType> rhos(m);
+        std::vector<ScalarType> alphas(m);
+        BackendType::copy(N_,c.g(),q_);
+        int i = 0;
+        for(; i < (int)n_valid_pairs_ ; ++i){
+            rhos[i] = static_cast<ScalarType>(1)/BackendType::dot(N_,y(i),s(i));
+            alphas[i] = rhos[i]*BackendType::dot(N_,s(i),q_);
+            BackendType::axpy(N_,-alphas[i],y(i),q_);
+        }
+        if(n_valid_pairs_ > 0)
+            BackendType::scale(N_,BackendType::dot(N_,s(0),y(0))/BackendType::dot(N_,y(0),y(0)),q_);
+        --i;
+        for(; i >=0 ; --i){
+            ScalarType beta = rhos[i]*BackendType::dot(N_,y(i),q_);
+            BackendType::axpy(N_,alphas[i]-beta,s(i),q_);
+        }
+
+        //p = -eta*Hg
+        BackendType::copy(N_,q_,c.p());
+        BackendType::scale(N_,-(n_valid_pairs_?eta(c.iter()):warmup_eta(c.iter())),c.p());
+    }
+
+    step_size eta;
+    step_size warmup_eta;
+    unsigned int L;
+    unsigned int m;
+
+private:
+    std::size_t N_;
+    std::vector<storage_pair> vecs_;
+    storage_pair candidate_;
+    VectorType q_;
+    VectorType xbar_;
+    VectorType xbarm1_;
+    VectorType gbar_;
+    bool has_xbarm1_;
+    unsigned int n_valid_pairs_;
+};
+
+}
+
+#endif
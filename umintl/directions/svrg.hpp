@@ -0,0 +1,107 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+
+#ifndef UMINTL_DIRECTIONS_SVRG_HPP_
+#define UMINTL_DIRECTIONS_SVRG_HPP_
+
+#include "umintl/optimization_context.hpp"
+#include "umintl/directions/step_size.hpp"
+#include "umintl/tools/exception.hpp"
+
+#include "umintl/tools/shared_ptr.hpp"
+#include "umintl/directions/forwards.h"
+
+
+namespace umintl{
+
+/** @brief The stochastic variance reduced gradient class
+ *
+ *  Johnson & Zhang (2013) : "Accelerating Stochastic Gradient Descent using Predictive Variance Reduction".
+ *  Every update_frequency iterations, a snapshot x~ of the iterate is taken along with its full gradient mu. The mini-batch
+ *  gradient g_B(x) is then corrected into g_B(x) - g_B(x~) + mu, where g_B(x~) is evaluated on the same mini-batch as g_B(x),
+ *  ie with the value_gradient tag of the model. This is a fixed-step direction, meant to be used with a mini_batch model
+ *  which subsamples the gradient.
+ */
+template<class BackendType>
+struct svrg : public direction<BackendType>{
+    typedef typename BackendType::VectorType VectorType;
+    typedef typename BackendType::ScalarType ScalarType;
+
+    /** @brief The constructor
+     *
+     *  @param _eta the step-size schedule
+     *  @param _dataset_size number of samples in the dataset, used for the full gradient at the snapshot
+     *  @param _update_frequency number of iterations between two snapshots. Must be positive
+     */
+    svrg(step_size const & _eta, std::size_t _dataset_size, unsigned int _update_frequency) : eta(_eta), dataset_size(_dataset_size), update_frequency(_update_frequency){
+        if(update_frequency==0)
+            throw exceptions::incompatible_parameters("SVRG requires a positive update frequency");
+    }
+
+    virtual std::string info() const{
+        return "SVRG";
+    }
+
+    virtual bool is_fixed_step() const{
+        return true;
+    }
+
+    virtual void init(optimization_context<BackendType> & c){
+        x_snapshot_ = BackendType::create_vector(c.N());
+        mu_ = BackendType::create_vector(c.N());
+        g_snapshot_ = BackendType::create_vector(c.N());
+    }
+
+    virtual void clean(optimization_context<BackendType> &){
+        BackendType::delete_if_dynamically_allocated(x_snapshot_);
+        BackendType::delete_if_dynamically_allocated(mu_);
+        BackendType::delete_if_dynamically_allocated(g_snapshot_);
+    }
+
+    /** @brief The snapshot and its full gradient. g_snapshot_ is a temporary */
+    virtual void save_state(optimization_context<BackendType> & c, tools::state_writer & writer) const{
+        writer.write_vector<ScalarType>(x_snapshot_,c.N());
+        writer.write_vector<ScalarType>(mu_,c.N());
+    }
+
+    virtual void load_state(optimization_context<BackendType> & c, tools::state_reader & reader){
+        reader.read_vector<ScalarType>(x_snapshot_,c.N());
+        reader.read_vector<ScalarType>(mu_,c.N());
+    }
+
+    void operator()(optimization_context<BackendType> & c){
+        std::size_t N = c.N();
+        ScalarType dummy;
+        //At the snapshot, g_B(x) - g_B(x~) vanishes
+        if(c.iter() % update_frequency == 0){
+            BackendType::copy(N,c.x(),x_snapshot_);
+            c.fun().compute_value_gradient(x_snapshot_,dummy,mu_,value_gradient(STOCHASTIC,dataset_size,0));
+            BackendType::copy(N,mu_,c.p());
+        }
+        else{
+            c.fun().compute_value_gradient(x_snapshot_,dummy,g_snapshot_,c.model().get_value_gradient_tag());
+            BackendType::copy(N,c.g(),c.p());
+            BackendType::axpy(N,-1,g_snapshot_,c.p());
+            BackendType::axpy(N,1,mu_,c.p());
+        }
+        BackendType::scale(N,-eta(c.iter()),c.p());
+    }
+
+    step_size eta;
+    std::size_t dataset_size;
+    unsigned int update_frequency;
+
+private:
+    VectorType x_snapshot_;
+    VectorType mu_;
+    VectorType g_snapshot_;
+};
+
+}
+
+#endif
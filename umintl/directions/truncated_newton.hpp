@@ -95,6 +95,10 @@ struct truncated_newton : public direction<BackendType>{
         return "Truncated Newton";
     }
 
+    /** @brief No state besides the optimization context, which holds the previous direction used as starting point */
+    virtual void save_state(optimization_context<BackendType> &, tools::state_writer &) const { }
+    virtual void load_state(optimization_context<BackendType> &, tools::state_reader &) { }
+
     void operator()(optimization_context<BackendType> & c){
       if(max_iter==0) max_iter = c.N();
 
@@ -0,0 +1,249 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+
+#ifndef UMINTL_DIRECTIONS_VECTOR_FREE_LOW_MEMORY_QUASI_NEWTON_HPP_
+#define UMINTL_DIRECTIONS_VECTOR_FREE_LOW_MEMORY_QUASI_NEWTON_HPP_
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "umintl/optimization_context.hpp"
+
+#include "forwards.h"
+
+namespace umintl{
+
+/** @brief The vector-free low memory quasi-newton class
+ *
+ *  Same direction as low_memory_quasi_newton, computed as in VL-BFGS (Chen et al., 2014 : "Large-scale L-BFGS using MapReduce").
+ *  The two-loop recursion only involves dot products between the 2m+1 vectors {s_i, y_i, g}, so it is run on their Gram matrix,
+ *  and the direction is formed as a linear combination of these vectors. At each iteration, only the products involving the new
+ *  s, y and g are computed, in a single batched call of BackendType::dots : a distributed backend then synchronizes once per
+ *  iteration, instead of 2m+2 times for the two-loop recursion.
+ */
+template<class BackendType>
+struct vector_free_low_memory_quasi_newton : public direction<BackendType>{
+    vector_free_low_memory_quasi_newton(unsigned int _m = 4) : m(_m) { }
+    unsigned int m;
+
+    typedef typename BackendType::ScalarType ScalarType;
+    typedef typename BackendType::VectorType VectorType;
+
+private:
+    /** @brief Index in the Gram matrix of s_j, y_j, and g */
+    std::size_t is(std::size_t j) const { return j; }
+    std::size_t iy(std::size_t j) const { return m + j; }
+    std::size_t ig() const { return 2*m; }
+
+    ScalarType & gram(std::size_t i, std::size_t j) { return gram_[i*(2*m+1)+j]; }
+
+    /** @brief Slot of the k-th most recent pair */
+    std::size_t slot(std::size_t k) const { return (newest_ + m - k)%m; }
+
+public:
+    virtual void init(optimization_context<BackendType> & context){
+        N_ = context.N();
+        s_.resize(m);
+        y_.resize(m);
+        for(unsigned int i = 0 ; i < m ; ++i){
+            s_[i] = BackendType::create_vector(N_);
+            y_[i] = BackendType::create_vector(N_);
+        }
+        gram_.assign((2*m+1)*(2*m+1), 0);
+        n_valid_pairs_ = 0;
+        newest_ = m-1;
+        is_seeded_ = false;
+    }
+
+    virtual void clean(optimization_context<BackendType> &){
+        for(unsigned int i = 0 ; i < m ; ++i){
+            BackendType::delete_if_dynamically_allocated(s_[i]);
+            BackendType::delete_if_dynamically_allocated(y_[i]);
+        }
+        s_.clear();
+        y_.clear();
+    }
+
+    virtual std::string info() const{
+        return "Vector-free low memory quasi-newton";
+    }
+
+    virtual void save_state(optimization_context<BackendType> &, tools::state_writer & writer) const{
+        writer.write(m);
+        writer.write(n_valid_pairs_);
+        writer.write<unsigned long long>(newest_);
+        for(unsigned int i = 0 ; i < m ; ++i){
+            writer.write_vector<ScalarType>(s_[i],N_);
+            writer.write_vector<ScalarType>(y_[i],N_);
+        }
+        writer.write_vector<ScalarType>(gram_,gram_.size());
+    }
+
+    virtual void load_state(optimization_context<BackendType> &, tools::state_reader & reader){
+        if(reader.read<unsigned int>() != m)
+            throw exceptions::io_error("Incompatible state : different memory size");
+        n_valid_pairs_ = reader.read<unsigned int>();
+        newest_ = reader.read<unsigned long long>();
+        for(unsigned int i = 0 ; i < m ; ++i){
+            reader.read_vector<ScalarType>(s_[i],N_);
+            reader.read_vector<ScalarType>(y_[i],N_);
+        }
+        reader.read_vector<ScalarType>(gram_,gram_.size());
+        is_seeded_ = false;
+    }
+
+    /** @brief The (s,y) history, from the most recent pair */
+    virtual bool export_curvature(optimization_context<BackendType> &, tools::state_writer & writer) const{
+        if(n_valid_pairs_==0)
+            return false;
+        writer.write(n_valid_pairs_);
+        for(std::size_t k = 0 ; k < n_valid_pairs_ ; ++k){
+            writer.write_vector<ScalarType>(s_[slot(k)],N_);
+            writer.write_vector<ScalarType>(y_[slot(k)],N_);
+        }
+        return true;
+    }
+
+    /** @brief Keeps the m most recent pairs, and computes their Gram matrix in a single batched call */
+    virtual void import_curvature(optimization_context<BackendType> &, tools::state_reader & reader){
+        unsigned int n = reader.read<unsigned int>();
+        n_valid_pairs_ = std::min(n,m);
+        newest_ = (n_valid_pairs_ + m - 1)%m;
+        std::vector<VectorType const *> basis;
+        std::vector<std::size_t> indices;
+        for(std::size_t k = 0 ; k < n_valid_pairs_ ; ++k){
+            std::size_t j = slot(k);
+            reader.read_vector<ScalarType>(s_[j],N_);
+            reader.read_vector<ScalarType>(y_[j],N_);
+            basis.push_back(&s_[j]);
+            basis.push_back(&y_[j]);
+            indices.push_back(is(j));
+            indices.push_back(iy(j));
+        }
+        std::vector<VectorType const *> lhs, rhs;
+        std::vector<std::pair<std::size_t, std::size_t> > entries;
+        for(std::size_t a = 0 ; a < basis.size() ; ++a){
+            for(std::size_t b = a ; b < basis.size() ; ++b){
+                lhs.push_back(basis[a]);
+                rhs.push_back(basis[b]);
+                entries.push_back(std::make_pair(indices[a], indices[b]));
+            }
+        }
+        std::vector<ScalarType> products(entries.size());
+        if(entries.size())
+            BackendType::dots(N_, entries.size(), &lhs[0], &rhs[0], &products[0]);
+        for(std::size_t e = 0 ; e < entries.size() ; ++e){
+            gram(entries[e].first, entries[e].second) = products[e];
+            gram(entries[e].second, entries[e].first) = products[e];
+        }
+        is_seeded_ = n_valid_pairs_ > 0;
+    }
+
+    void operator()(optimization_context<BackendType> & c){
+        //A seeded history is used as is at the first iteration
+        bool update = !is_seeded_;
+        is_seeded_ = false;
+        if(update){
+            newest_ = (newest_+1)%m;
+            n_valid_pairs_ = std::min(n_valid_pairs_+1,m);
+        }
+        std::size_t t = newest_;
+
+        //s = x - xm1, y = g - gm1
+        if(update){
+            BackendType::copy(N_,c.x(),s_[t]);
+            BackendType::axpy(N_,-1,c.xm1(),s_[t]);
+            BackendType::copy(N_,c.g(),y_[t]);
+            BackendType::axpy(N_,-1,c.gm1(),y_[t]);
+        }
+
+        //Basis of the valid vectors
+        std::vector<VectorType const *> basis(2*m+1, (VectorType const *)NULL);
+        std::vector<std::size_t> indices;
+        for(std::size_t k = 0 ; k < n_valid_pairs_ ; ++k){
+            std::size_t j = slot(k);
+            basis[is(j)] = &s_[j];
+            basis[iy(j)] = &y_[j];
+            indices.push_back(is(j));
+            indices.push_back(iy(j));
+        }
+        basis[ig()] = &c.g();
+        indices.push_back(ig());
+
+        //New products : (s_t, y_t, g) with every vector of the basis, in a single batched call
+        std::vector<std::size_t> changed;
+        if(update){
+            changed.push_back(is(t));
+            changed.push_back(iy(t));
+        }
+        changed.push_back(ig());
+        std::vector<VectorType const *> lhs, rhs;
+        std::vector<std::pair<std::size_t, std::size_t> > entries;
+        for(std::size_t a = 0 ; a < changed.size() ; ++a){
+            for(std::size_t l = 0 ; l < indices.size() ; ++l){
+                std::size_t b = indices[l];
+                //Products between two changed vectors are only computed once
+                if(std::find(changed.begin(), changed.begin() + a, b) != changed.begin() + a)
+                    continue;
+                lhs.push_back(basis[changed[a]]);
+                rhs.push_back(basis[b]);
+                entries.push_back(std::make_pair(changed[a], b));
+            }
+        }
+        std::vector<ScalarType> products(entries.size());
+        BackendType::dots(N_, entries.size(), &lhs[0], &rhs[0], &products[0]);
+        for(std::size_t e = 0 ; e < entries.size() ; ++e){
+            gram(entries[e].first, entries[e].second) = products[e];
+            gram(entries[e].second, entries[e].first) = products[e];
+        }
+
+        //Two-loop recursion on the coefficients delta of p = sum_l delta_l b_l, starting from p = -g
+        std::vector<ScalarType> delta(2*m+1, 0);
+        std::vector<ScalarType> alphas(n_valid_pairs_);
+        delta[ig()] = -1;
+        for(std::size_t k = 0 ; k < n_valid_pairs_ ; ++k){
+            std::size_t j = slot(k);
+            ScalarType sq = 0;
+            for(std::size_t l = 0 ; l < indices.size() ; ++l)
+                sq += delta[indices[l]]*gram(indices[l], is(j));
+            alphas[k] = sq/gram(is(j), iy(j));
+            delta[iy(j)] -= alphas[k];
+        }
+        ScalarType scale = gram(is(t), iy(t))/gram(iy(t), iy(t));
+        for(std::size_t l = 0 ; l < indices.size() ; ++l)
+            delta[indices[l]] *= scale;
+        for(std::size_t k = n_valid_pairs_ ; k-- > 0 ;){
+            std::size_t j = slot(k);
+            ScalarType yr = 0;
+            for(std::size_t l = 0 ; l < indices.size() ; ++l)
+                yr += delta[indices[l]]*gram(indices[l], iy(j));
+            ScalarType beta = yr/gram(is(j), iy(j));
+            delta[is(j)] += alphas[k] - beta;
+        }
+
+        //p = sum_l delta_l b_l
+        BackendType::copy(N_,c.g(),c.p());
+        BackendType::scale(N_,delta[ig()],c.p());
+        for(std::size_t l = 0 ; l + 1 < indices.size() ; ++l)
+            BackendType::axpy(N_,delta[indices[l]],*basis[indices[l]],c.p());
+    }
+
+private:
+    std::size_t N_;
+    std::vector<VectorType> s_;
+    std::vector<VectorType> y_;
+    std::vector<ScalarType> gram_;
+    unsigned int n_valid_pairs_;
+    std::size_t newest_;
+    bool is_seeded_;
+};
+
+}
+
+#endif
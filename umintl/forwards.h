@@ -32,9 +32,27 @@ struct hessian_vector_product : public operation_tag {
 struct gradient_variance : public operation_tag {
     gradient_variance(model_type_tag const & _model, std::size_t _sample_size, std::size_t _offset) : operation_tag(_model,_sample_size,_offset){ }
 };
+struct value_gradient_variance : public operation_tag {
+    value_gradient_variance(model_type_tag const & _model, std::size_t _sample_size, std::size_t _offset) : operation_tag(_model,_sample_size,_offset){ }
+};
+struct sparse_gradient : public operation_tag {
+    sparse_gradient(model_type_tag const & _model, std::size_t _sample_size, std::size_t _offset) : operation_tag(_model,_sample_size,_offset){ }
+};
 struct hv_product_variance : public operation_tag {
     hv_product_variance(model_type_tag const & _model, std::size_t _sample_size, std::size_t _offset) : operation_tag(_model,_sample_size,_offset){ }
 };
+struct residuals_jacobian : public operation_tag {
+    residuals_jacobian(model_type_tag const & _model, std::size_t _sample_size, std::size_t _offset) : operation_tag(_model,_sample_size,_offset){ }
+};
+struct gauss_newton_vector_product : public operation_tag {
+    gauss_newton_vector_product(model_type_tag const & _model, std::size_t _sample_size, std::size_t _offset) : operation_tag(_model,_sample_size,_offset){ }
+};
+struct sample_derivatives : public operation_tag {
+    sample_derivatives(model_type_tag const & _model, std::size_t _sample_size, std::size_t _offset) : operation_tag(_model,_sample_size,_offset){ }
+};
+struct sample_combination : public operation_tag {
+    sample_combination(model_type_tag const & _model, std::size_t _sample_size, std::size_t _offset) : operation_tag(_model,_sample_size,_offset){ }
+};
 
 }
 #endif
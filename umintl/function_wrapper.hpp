@@ -11,11 +11,14 @@
 #include "tools/shared_ptr.hpp"
 #include "tools/is_call_possible.hpp"
 #include "tools/exception.hpp"
+#include "tools/serialization.hpp"
 
 #include "umintl/forwards.h"
 
 
 #include <iostream>
+#include <vector>
+#include <algorithm>
 
 
 
@@ -30,16 +33,30 @@ namespace umintl{
         class function_wrapper{
             typedef typename BackendType::ScalarType ScalarType;
             typedef typename BackendType::VectorType VectorType;
+            typedef typename BackendType::MatrixType MatrixType;
         public:
             function_wrapper(){ }
             virtual unsigned int n_value_computations() const = 0;
             virtual unsigned int n_gradient_computations() const  = 0;
             virtual unsigned int n_hessian_vector_product_computations() const  = 0;
             virtual unsigned int n_datapoints_accessed() const = 0;
+            /** @brief How the hessian-vector products are computed. FORWARD_DIFFERENCE requires the gradient at x on the samples of the product */
+            virtual computation_type hessian_vector_product_computation() const = 0;
             virtual void compute_value_gradient(VectorType const & x, ScalarType & value, VectorType & gradient, value_gradient const & tag) = 0;
+            /** @brief Extends the value and the gradient at x on the samples of evaluated to the samples of tag, which contain them */
+            virtual void extend_value_gradient(VectorType const & x, ScalarType & value, VectorType & gradient, value_gradient const & evaluated, value_gradient const & tag) = 0;
             virtual void compute_hv_product(VectorType const & x, VectorType const & g, VectorType const & v, VectorType & Hv, hessian_vector_product const & tag) = 0;
             virtual void compute_gradient_variance(VectorType const & x, VectorType & variance, gradient_variance const & tag) = 0;
+            virtual void compute_value_gradient_variance(VectorType const & x, ScalarType & value, VectorType & gradient, VectorType & variance, value_gradient_variance const & tag) = 0;
+            virtual void track_gradient_variance(bool track) = 0;
             virtual void compute_hv_product_variance(VectorType const & x, VectorType const & v, VectorType & variance, hv_product_variance const & tag) = 0;
+            virtual void compute_residuals_jacobian(VectorType const & x, VectorType & r, MatrixType & J, residuals_jacobian const & tag) = 0;
+            virtual void compute_gauss_newton_product(VectorType const & x, VectorType const & v, VectorType & Gv, gauss_newton_vector_product const & tag) = 0;
+            virtual void compute_sample_derivatives(VectorType const & x, ScalarType & value, VectorType & derivatives, sample_derivatives const & tag) = 0;
+            virtual void compute_sample_combination(VectorType const & weights, VectorType & res, sample_combination const & tag) = 0;
+            /** @brief Saves the evaluation counters and the cached evaluation, for checkpointing */
+            virtual void save_state(tools::state_writer & writer) const = 0;
+            virtual void load_state(tools::state_reader & reader) = 0;
             virtual ~function_wrapper(){ }
         };
 
@@ -48,6 +65,7 @@ namespace umintl{
         class function_wrapper_impl : public function_wrapper<BackendType>{
         private:
             typedef typename BackendType::VectorType VectorType;
+            typedef typename BackendType::MatrixType MatrixType;
             typedef typename BackendType::ScalarType ScalarType;
         private:
             //Compute gradient variance
@@ -62,6 +80,15 @@ namespace umintl{
                 fun_(x,variance,tag);
             }
 
+            //Compute the value, the gradient and the gradient variance in a single pass. Falls back to two passes
+            void operator()(VectorType const & x, ScalarType & value, VectorType & gradient, VectorType & variance, value_gradient_variance const & tag, int2type<false>){
+                (*this)(x,value,gradient,value_gradient(tag.model,tag.sample_size,tag.offset),int2type<is_call_possible<Fun,void(VectorType const &, ScalarType&, VectorType&, value_gradient)>::value>());
+                (*this)(x,variance,gradient_variance(tag.model,tag.sample_size,tag.offset),int2type<is_call_possible<Fun,void(VectorType const &, VectorType &,gradient_variance)>::value>());
+            }
+            void operator()(VectorType const & x, ScalarType & value, VectorType & gradient, VectorType & variance, value_gradient_variance const & tag, int2type<true>){
+                fun_(x,value,gradient,variance,tag);
+            }
+
             //Compute hessian_vector_product variance
             void operator()(VectorType const &, VectorType const & , VectorType &, hv_product_variance const &, int2type<false>){
                 throw exceptions::incompatible_parameters(
@@ -105,28 +132,338 @@ namespace umintl{
                 fun_(x,v,Hv,tag);
             }
 
+            //Compute the residuals and their jacobian
+            void operator()(VectorType const &, VectorType &, MatrixType &, residuals_jacobian const &, int2type<false>){
+                throw exceptions::incompatible_parameters(
+                            "\n"
+                            "No function supplied to compute the residuals and their jacobian!"
+                            "Please provide an overload of :\n"
+                            "void operator()(VectorType const & X, VectorType & r, MatrixType & J, umintl::residuals_jacobian)\n."
+                            );
+            }
+            void operator()(VectorType const & x, VectorType & r, MatrixType & J, residuals_jacobian const & tag, int2type<true>){
+                fun_(x,r,J,tag);
+            }
+
+            //Compute gauss-newton matrix - vector product
+            void operator()(VectorType const &, VectorType const &, VectorType&, gauss_newton_vector_product const &, int2type<false>){
+                throw exceptions::incompatible_parameters(
+                            "\n"
+                            "No function supplied to compute the gauss-newton matrix-vector product!"
+                            "Please provide an overload of :\n"
+                            "void operator()(VectorType const & X, VectorType const & v, VectorType & Gv, umintl::gauss_newton_vector_product)\n."
+                            );
+            }
+            void operator()(VectorType const & x, VectorType const & v, VectorType& Gv, gauss_newton_vector_product const & tag, int2type<true>){
+                fun_(x,v,Gv,tag);
+            }
+
+            //Compute the derivatives of the loss of a linear model with respect to its output, for each sample
+            void operator()(VectorType const &, ScalarType &, VectorType &, sample_derivatives const &, int2type<false>){
+                throw exceptions::incompatible_parameters(
+                            "\n"
+                            "No function supplied to compute the per-sample derivatives!"
+                            "Please provide an overload of :\n"
+                            "void operator()(VectorType const & X, ScalarType & value, VectorType & derivatives, umintl::sample_derivatives)\n."
+                            );
+            }
+            void operator()(VectorType const & x, ScalarType & value, VectorType & derivatives, sample_derivatives const & tag, int2type<true>){
+                fun_(x,value,derivatives,tag);
+            }
+
+            //Compute a linear combination of the samples
+            void operator()(VectorType const &, VectorType &, sample_combination const &, int2type<false>){
+                throw exceptions::incompatible_parameters(
+                            "\n"
+                            "No function supplied to combine the samples!"
+                            "Please provide an overload of :\n"
+                            "void operator()(VectorType const & weights, VectorType & res, umintl::sample_combination)\n."
+                            );
+            }
+            void operator()(VectorType const & weights, VectorType & res, sample_combination const & tag, int2type<true>){
+                fun_(weights,res,tag);
+            }
+
+            /** @brief Shard k of the range of tag, of about tag.sample_size/n_shards samples */
+            template<class TagType>
+            TagType shard(TagType const & tag, std::size_t k) const{
+              std::size_t begin = tag.sample_size*k/n_shards_;
+              std::size_t end = tag.sample_size*(k+1)/n_shards_;
+              TagType res(tag);
+              res.offset = tag.offset + begin;
+              res.sample_size = end - begin;
+              return res;
+            }
+
+            /** @brief Whether the range of tag is split. The samples of a deterministic tag are not known */
+            bool is_sharded(operation_tag const & tag) const{
+              return n_shards_ > 1 && tag.model==STOCHASTIC && tag.sample_size >= n_shards_;
+            }
+
+            /** @brief Merges the averages over two disjoint sets of samples, of respective sizes na and nb, into the first one
+             *
+             *  The functor returns averages over its samples : a and b are combined into (na*a + nb*b)/(na + nb).
+             *  The (unbiased) variances, if any, are combined with the pairwise update of Chan et al.
+             */
+            void combine(std::size_t & na, ScalarType * value_a, VectorType & a, VectorType * variance_a
+                         , std::size_t nb, ScalarType value_b, VectorType const & b, VectorType const * variance_b){
+              std::size_t w = na + nb;
+              if(nb==0)
+                return;
+              ScalarType wa = (ScalarType)na/w, wb = (ScalarType)nb/w;
+              if(value_a)
+                *value_a = wa*(*value_a) + wb*value_b;
+              if(variance_a){
+                VectorType & va = *variance_a;
+                VectorType const & vb = *variance_b;
+                for(std::size_t i = 0 ; i < N_ ; ++i){
+                  ScalarType delta = b[i] - a[i];
+                  va[i] = (va[i]*((ScalarType)na-1) + vb[i]*((ScalarType)nb-1) + delta*delta*na*nb/w)/(w-1);
+                }
+              }
+              BackendType::scale(N_,wa,a);
+              BackendType::axpy(N_,wb,b,a);
+              na = w;
+            }
+
+            /** @brief Fixed-order pairwise reduction of the shard results, weighted by the shard sizes
+             *
+             *  The order of the operations only depends on n_shards, so that the result is reproducible regardless of the number of threads.
+             */
+            void reduce(std::vector<ScalarType> & values, std::vector<VectorType> & vectors, std::vector<std::size_t> & weights, bool has_values, std::vector<VectorType> * variances = NULL){
+              for(std::size_t stride = 1 ; stride < n_shards_ ; stride*=2){
+                for(std::size_t a = 0 ; a + stride < n_shards_ ; a+=2*stride){
+                  std::size_t b = a + stride;
+                  combine(weights[a], has_values?&values[a]:NULL, vectors[a], variances?&(*variances)[a]:NULL
+                          , weights[b], has_values?values[b]:0, vectors[b], variances?&(*variances)[b]:NULL);
+                }
+              }
+            }
+
+            void sharded_value_gradient(VectorType const & x, ScalarType & value, VectorType & gradient, value_gradient const & tag){
+              if(!is_sharded(tag)){
+                (*this)(x,value,gradient,tag,int2type<is_call_possible<Fun,void(VectorType const &, ScalarType&, VectorType&, value_gradient)>::value>());
+                return;
+              }
+              std::vector<ScalarType> values(n_shards_);
+              std::vector<VectorType> gradients(n_shards_);
+              std::vector<std::size_t> weights(n_shards_);
+              for(std::size_t k = 0 ; k < n_shards_ ; ++k)
+                gradients[k] = BackendType::create_vector(N_);
+              long n_shards = n_shards_;
+              #ifdef _OPENMP
+              #pragma omp parallel for
+              #endif
+              for(long k = 0 ; k < n_shards ; ++k){
+                value_gradient shard_tag = shard(tag,k);
+                weights[k] = shard_tag.sample_size;
+                (*this)(x,values[k],gradients[k],shard_tag,int2type<is_call_possible<Fun,void(VectorType const &, ScalarType&, VectorType&, value_gradient)>::value>());
+              }
+              reduce(values,gradients,weights,true);
+              value = values[0];
+              BackendType::copy(N_,gradients[0],gradient);
+              for(std::size_t k = 0 ; k < n_shards_ ; ++k)
+                BackendType::delete_if_dynamically_allocated(gradients[k]);
+            }
+
+            void sharded_value_gradient_variance(VectorType const & x, ScalarType & value, VectorType & gradient, VectorType & variance, value_gradient_variance const & tag){
+              if(!is_sharded(tag)){
+                (*this)(x,value,gradient,variance,tag,int2type<is_call_possible<Fun,void(VectorType const &, ScalarType&, VectorType&, VectorType&, value_gradient_variance)>::value>());
+                return;
+              }
+              std::vector<ScalarType> values(n_shards_);
+              std::vector<VectorType> gradients(n_shards_);
+              std::vector<VectorType> variances(n_shards_);
+              std::vector<std::size_t> weights(n_shards_);
+              for(std::size_t k = 0 ; k < n_shards_ ; ++k){
+                gradients[k] = BackendType::create_vector(N_);
+                variances[k] = BackendType::create_vector(N_);
+              }
+              long n_shards = n_shards_;
+              #ifdef _OPENMP
+              #pragma omp parallel for
+              #endif
+              for(long k = 0 ; k < n_shards ; ++k){
+                value_gradient_variance shard_tag = shard(tag,k);
+                weights[k] = shard_tag.sample_size;
+                (*this)(x,values[k],gradients[k],variances[k],shard_tag,int2type<is_call_possible<Fun,void(VectorType const &, ScalarType&, VectorType&, VectorType&, value_gradient_variance)>::value>());
+              }
+              reduce(values,gradients,weights,true,&variances);
+              value = values[0];
+              BackendType::copy(N_,gradients[0],gradient);
+              BackendType::copy(N_,variances[0],variance);
+              for(std::size_t k = 0 ; k < n_shards_ ; ++k){
+                BackendType::delete_if_dynamically_allocated(gradients[k]);
+                BackendType::delete_if_dynamically_allocated(variances[k]);
+              }
+            }
+
+            void allocate_cache(){
+              if(cache_allocated_)
+                return;
+              cached_x_ = BackendType::create_vector(N_);
+              cached_variance_ = BackendType::create_vector(N_);
+              cached_diff_ = BackendType::create_vector(N_);
+              cache_allocated_ = true;
+            }
+
+            /** @brief Exact comparison with the cached point. Relies on the backend, so that distributed backends take the same decision on every process */
+            bool is_cached_point(VectorType const & x){
+              BackendType::copy(N_,x,cached_diff_);
+              BackendType::axpy(N_,-1,cached_x_,cached_diff_);
+              return BackendType::asum(N_,cached_diff_)==0;
+            }
+
+            void sharded_hv_product(VectorType const & x, VectorType const & v, VectorType & Hv, hessian_vector_product const & tag){
+              if(!is_sharded(tag)){
+                (*this)(x,v,Hv,tag,int2type<is_call_possible<Fun,void(VectorType const &, VectorType&, VectorType&, hessian_vector_product)>::value>());
+                return;
+              }
+              std::vector<ScalarType> values;
+              std::vector<VectorType> products(n_shards_);
+              std::vector<std::size_t> weights(n_shards_);
+              for(std::size_t k = 0 ; k < n_shards_ ; ++k)
+                products[k] = BackendType::create_vector(N_);
+              long n_shards = n_shards_;
+              #ifdef _OPENMP
+              #pragma omp parallel for
+              #endif
+              for(long k = 0 ; k < n_shards ; ++k){
+                hessian_vector_product shard_tag = shard(tag,k);
+                weights[k] = shard_tag.sample_size;
+                (*this)(x,v,products[k],shard_tag,int2type<is_call_possible<Fun,void(VectorType const &, VectorType&, VectorType&, hessian_vector_product)>::value>());
+              }
+              reduce(values,products,weights,false);
+              BackendType::copy(N_,products[0],Hv);
+              for(std::size_t k = 0 ; k < n_shards_ ; ++k)
+                BackendType::delete_if_dynamically_allocated(products[k]);
+            }
+
         public:
-            function_wrapper_impl(Fun & fun, std::size_t N, computation_type hessian_vector_product_computation) : fun_(fun), N_(N), hessian_vector_product_computation_(hessian_vector_product_computation){
+            /** @brief The constructor
+             *
+             *  @param n_shards number of shards the samples of stochastic value-gradient and hessian-vector product evaluations are split into.
+             *  The functor is then called concurrently on each shard, and must be thread-safe. Without OpenMP, the shards are evaluated sequentially.
+             */
+            function_wrapper_impl(Fun & fun, std::size_t N, computation_type hessian_vector_product_computation, std::size_t n_shards = 1) : fun_(fun), N_(N), hessian_vector_product_computation_(hessian_vector_product_computation), n_shards_(std::max(n_shards,(std::size_t)1)), cached_tag_(DETERMINISTIC,0,0){
               n_value_computations_ = 0;
               n_gradient_computations_ = 0;
               n_hessian_vector_product_computations_ = 0;
               n_datapoints_accessed_ = 0;
+              track_variance_ = false;
+              has_cache_ = false;
+              cache_allocated_ = false;
+              piece_allocated_ = false;
+            }
+
+            ~function_wrapper_impl(){
+              if(cache_allocated_){
+                BackendType::delete_if_dynamically_allocated(cached_x_);
+                BackendType::delete_if_dynamically_allocated(cached_variance_);
+                BackendType::delete_if_dynamically_allocated(cached_diff_);
+              }
+              if(piece_allocated_)
+                BackendType::delete_if_dynamically_allocated(piece_gradient_);
             }
 
             unsigned int n_datapoints_accessed() const{ return n_datapoints_accessed_; }
             unsigned int n_value_computations() const{ return n_value_computations_; }
             unsigned int n_gradient_computations() const { return n_gradient_computations_; }
             unsigned int n_hessian_vector_product_computations() const { return n_hessian_vector_product_computations_; }
+            computation_type hessian_vector_product_computation() const { return hessian_vector_product_computation_; }
+
+            /** @brief The variance kept from the last evaluation is not saved : an evaluation always precedes its reuse within an iteration */
+            void save_state(tools::state_writer & writer) const{
+              writer.write(n_value_computations_);
+              writer.write(n_gradient_computations_);
+              writer.write(n_hessian_vector_product_computations_);
+              writer.write(n_datapoints_accessed_);
+              writer.write(track_variance_);
+            }
+
+            void load_state(tools::state_reader & reader){
+              n_value_computations_ = reader.read<unsigned int>();
+              n_gradient_computations_ = reader.read<unsigned int>();
+              n_hessian_vector_product_computations_ = reader.read<unsigned int>();
+              n_datapoints_accessed_ = reader.read<unsigned int>();
+              track_variance_ = reader.read<bool>();
+              has_cache_ = false;
+            }
 
+            /** @brief Computes the value and the gradient
+             *
+             *  If the gradient variance is tracked (see track_gradient_variance) and the functor provides the fused overload, the variance
+             *  is computed in the same pass and kept until the next evaluation, so that a subsequent compute_gradient_variance at the same
+             *  point and on the same samples does not access the data again. Nothing is kept otherwise.
+             */
             void compute_value_gradient(VectorType const & x,  ScalarType & value, VectorType & gradient, value_gradient const & tag){
-              (*this)(x,value,gradient,tag,int2type<is_call_possible<Fun,void(VectorType const &, ScalarType&, VectorType&, value_gradient)>::value>());
               n_value_computations_++;
               n_gradient_computations_++;
               n_datapoints_accessed_+=tag.sample_size;
+              if(tag.model==STOCHASTIC && track_variance_ && has_fused_variance){
+                allocate_cache();
+                sharded_value_gradient_variance(x,value,gradient,cached_variance_,value_gradient_variance(tag.model,tag.sample_size,tag.offset));
+                BackendType::copy(N_,x,cached_x_);
+                cached_tag_ = tag;
+                has_cache_ = true;
+              }
+              else{
+                sharded_value_gradient(x,value,gradient,tag);
+                has_cache_ = false;
+              }
+            }
+
+            /** @brief Completes the value and the gradient at x on the samples of evaluated into the value and the gradient on the samples of tag
+             *
+             *  Only the samples of tag outside of evaluated are accessed, and merged by sample count : the functor must return averages over
+             *  its samples. Falls back to a complete evaluation if evaluated is not contained in tag.
+             */
+            void extend_value_gradient(VectorType const & x, ScalarType & value, VectorType & gradient, value_gradient const & evaluated, value_gradient const & tag){
+              std::size_t evaluated_end = evaluated.offset + evaluated.sample_size;
+              if(tag.model!=STOCHASTIC || evaluated.model!=STOCHASTIC || evaluated.offset < tag.offset || evaluated_end > tag.offset + tag.sample_size){
+                compute_value_gradient(x,value,gradient,tag);
+                return;
+              }
+              if(!piece_allocated_){
+                piece_gradient_ = BackendType::create_vector(N_);
+                piece_allocated_ = true;
+              }
+              std::size_t n = evaluated.sample_size;
+              value_gradient pieces[2] = { value_gradient(STOCHASTIC,evaluated.offset-tag.offset,tag.offset)
+                                         , value_gradient(STOCHASTIC,tag.offset+tag.sample_size-evaluated_end,evaluated_end) };
+              for(unsigned int k = 0 ; k < 2 ; ++k){
+                if(pieces[k].sample_size==0)
+                  continue;
+                ScalarType piece_value;
+                sharded_value_gradient(x,piece_value,piece_gradient_,pieces[k]);
+                combine(n,&value,gradient,NULL,pieces[k].sample_size,piece_value,piece_gradient_,NULL);
+                n_value_computations_++;
+                n_gradient_computations_++;
+                n_datapoints_accessed_+=pieces[k].sample_size;
+              }
+              has_cache_ = false;
             }
 
             void compute_gradient_variance(VectorType const & x, VectorType & variance, gradient_variance const & tag){
+              if(has_cache_ && cached_tag_.sample_size==tag.sample_size && cached_tag_.offset==tag.offset
+                 && tag.model==STOCHASTIC && is_cached_point(x)){
+                BackendType::copy(N_,cached_variance_,variance);
+                return;
+              }
               (*this)(x,variance,tag,int2type<is_call_possible<Fun,void(VectorType const &, VectorType &,gradient_variance)>::value>());
+              n_datapoints_accessed_+=tag.sample_size;
+            }
+
+            void compute_value_gradient_variance(VectorType const & x, ScalarType & value, VectorType & gradient, VectorType & variance, value_gradient_variance const & tag){
+              sharded_value_gradient_variance(x,value,gradient,variance,tag);
+              n_value_computations_++;
+              n_gradient_computations_++;
+              n_datapoints_accessed_+=tag.sample_size;
+            }
+
+            /** @brief Enables the computation of the gradient variance along with each evaluation of the value and gradient */
+            void track_gradient_variance(bool track){
+              track_variance_ = track;
             }
 
             void compute_hv_product(VectorType const & x, VectorType const & g, VectorType const & v, VectorType & Hv, hessian_vector_product const & tag){
@@ -142,12 +479,12 @@ namespace umintl{
                   //Hv = Grad(x+hb)
                   BackendType::copy(N_,x,tmp); //tmp = x + hb
                   BackendType::axpy(N_,h,v,tmp);
-                   (*this)(tmp,dummy,Hv,vgtag,int2type<is_call_possible<Fun,void(VectorType const &, ScalarType&, VectorType&, value_gradient)>::value>());
+                  sharded_value_gradient(tmp,dummy,Hv,vgtag);
 
                   //Hvleft = Grad(x-hb)
                   BackendType::copy(N_,x,tmp); //tmp = x - hb
                   BackendType::axpy(N_,-h,v,tmp);
-                  (*this)(tmp,dummy,Hvleft,vgtag,int2type<is_call_possible<Fun,void(VectorType const &, ScalarType&, VectorType&, value_gradient)>::value>());
+                  sharded_value_gradient(tmp,dummy,Hvleft,vgtag);
 
                   //Hv-=Hvleft
                   //Hv/=2h
@@ -166,7 +503,7 @@ namespace umintl{
 
                   BackendType::copy(N_,x,tmp); //tmp = x + hb
                   BackendType::axpy(N_,h,v,tmp);
-                  (*this)(tmp,dummy,Hv,vgtag,int2type<is_call_possible<Fun,void(VectorType const &, ScalarType&, VectorType&, value_gradient)>::value>());
+                  sharded_value_gradient(tmp,dummy,Hv,vgtag);
                   BackendType::axpy(N_,-1,g,Hv);
                   BackendType::scale(N_,1/h,Hv);
 
@@ -175,7 +512,7 @@ namespace umintl{
                 }
                 case umintl::PROVIDED:
                 {
-                  (*this)(x,v,Hv,tag,int2type<is_call_possible<Fun,void(VectorType const &, VectorType&, VectorType&, hessian_vector_product)>::value>());
+                  sharded_hv_product(x,v,Hv,tag);
                   break;
                 }
                 default:
@@ -189,11 +526,50 @@ namespace umintl{
               (*this)(x,v,variance,tag,int2type<is_call_possible<Fun,void(VectorType const &, VectorType const &, VectorType &,hv_product_variance)>::value>());
             }
 
+            void compute_residuals_jacobian(VectorType const & x, VectorType & r, MatrixType & J, residuals_jacobian const & tag){
+              (*this)(x,r,J,tag,int2type<is_call_possible<Fun,void(VectorType const &, VectorType &, MatrixType &, residuals_jacobian)>::value>());
+              n_value_computations_++;
+              n_gradient_computations_++;
+              n_datapoints_accessed_+=tag.sample_size;
+            }
+
+            void compute_gauss_newton_product(VectorType const & x, VectorType const & v, VectorType & Gv, gauss_newton_vector_product const & tag){
+              (*this)(x,v,Gv,tag,int2type<is_call_possible<Fun,void(VectorType const &, VectorType const &, VectorType &, gauss_newton_vector_product)>::value>());
+              n_hessian_vector_product_computations_++;
+              n_datapoints_accessed_+=tag.sample_size;
+            }
+
+            void compute_sample_derivatives(VectorType const & x, ScalarType & value, VectorType & derivatives, sample_derivatives const & tag){
+              (*this)(x,value,derivatives,tag,int2type<is_call_possible<Fun,void(VectorType const &, ScalarType &, VectorType &, sample_derivatives)>::value>());
+              n_value_computations_++;
+              n_gradient_computations_++;
+              n_datapoints_accessed_+=tag.sample_size;
+            }
+
+            void compute_sample_combination(VectorType const & weights, VectorType & res, sample_combination const & tag){
+              (*this)(weights,res,tag,int2type<is_call_possible<Fun,void(VectorType const &, VectorType &, sample_combination)>::value>());
+              n_datapoints_accessed_+=tag.sample_size;
+            }
+
           private:
             Fun & fun_;
             std::size_t N_;
 
             computation_type hessian_vector_product_computation_;
+            std::size_t n_shards_;
+
+            static const bool has_fused_variance = is_call_possible<Fun,void(VectorType const &, ScalarType&, VectorType&, VectorType&, value_gradient_variance)>::value;
+            bool track_variance_;
+            //Point, samples and gradient variance of the last evaluation, when the variance is tracked
+            bool has_cache_;
+            bool cache_allocated_;
+            VectorType cached_x_;
+            VectorType cached_variance_;
+            VectorType cached_diff_;
+            value_gradient cached_tag_;
+            //Gradient on the new samples in extend_value_gradient
+            bool piece_allocated_;
+            VectorType piece_gradient_;
 
             unsigned int n_value_computations_;
             unsigned int n_gradient_computations_;
@@ -18,17 +18,38 @@
 
 #include "umintl/directions/conjugate_gradient.hpp"
 #include "umintl/directions/quasi_newton.hpp"
+#include "umintl/directions/factored_quasi_newton.hpp"
+#include "umintl/directions/out_of_core_quasi_newton.hpp"
 #include "umintl/directions/low_memory_quasi_newton.hpp"
+#include "umintl/directions/vector_free_low_memory_quasi_newton.hpp"
 #include "umintl/directions/steepest_descent.hpp"
 #include "umintl/directions/truncated_newton.hpp"
+#include "umintl/directions/partitioned_quasi_newton.hpp"
+#include "umintl/directions/levenberg_marquardt.hpp"
+#include "umintl/directions/stochastic_gradient.hpp"
+#include "umintl/directions/adam.hpp"
+#include "umintl/directions/svrg.hpp"
+#include "umintl/directions/saga.hpp"
+#include "umintl/directions/stochastic_quasi_newton.hpp"
 
 #include "umintl/line_search/strong_wolfe_powell.hpp"
 
 #include "umintl/stopping_criterion/value_treshold.hpp"
 #include "umintl/stopping_criterion/gradient_treshold.hpp"
 
+#include "umintl/observers/printer.hpp"
+#include "umintl/observers/trace_recorder.hpp"
+
+#include "umintl/phase_profiler.hpp"
+
+#include "umintl/tools/serialization.hpp"
+#include "umintl/tools/async_file_writer.hpp"
+#include "umintl/tools/timer.hpp"
+
 #include <iomanip>
 #include <sstream>
+#include <string>
+#include <vector>
 
 namespace umintl{
 
@@ -55,6 +76,9 @@ namespace umintl{
           , stopping_criterion(_stopping_criterion)
           , model(new deterministic<BackendType>())
           , hessian_vector_product_computation(CENTERED_DIFFERENCE)
+          , n_shards(1)
+          , checkpoint_frequency(0)
+          , warm_start(false)
           , verbosity_level(_verbosity_level), max_iter(_max_iter){
 
         }
@@ -65,6 +89,53 @@ namespace umintl{
         tools::shared_ptr< model_base<BackendType> > model;
         computation_type hessian_vector_product_computation;
 
+        /** @brief Observers of the iterations, called at the beginning of each iteration. Any of them can stop the optimization */
+        std::vector<tools::shared_ptr<umintl::observer<BackendType> > > observers;
+
+        /** @brief Adds an observer. Owned by the minimizer */
+        void add_observer(umintl::observer<BackendType> * o){
+            observers.push_back(tools::shared_ptr<umintl::observer<BackendType> >(o));
+        }
+
+        /** @brief Number of shards the samples of the stochastic evaluations are split into
+         *
+         *  If greater than 1, the functor is called concurrently on each shard, and the results are combined with a
+         *  deterministic tree reduction. The functor must then be thread-safe, and return averages over its samples.
+         *  The shards are only evaluated concurrently when compiled with OpenMP; otherwise they are evaluated one after the other,
+         *  which gives the same results without any speed-up.
+         */
+        std::size_t n_shards;
+
+        /** @brief File the state of the minimizer is saved to, every checkpoint_frequency iterations
+         *
+         *  The state is serialized at the beginning of the iteration, and written by a background thread, so that the
+         *  iterations never wait for the disk. An interrupted run can then be continued with resume(). The direction and the
+         *  model must support checkpointing (see direction::save_state), and the backend must be a host backend.
+         */
+        std::string checkpoint_file;
+        unsigned int checkpoint_frequency;
+
+        /** @brief Whether each run seeds the direction with the curvature information of the previous run
+         *
+         *  Useful for sequences of related problems, such as refits on rolling windows : the inverse hessian approximation of
+         *  quasi_newton, or the (s,y) history of the low-memory quasi-newton directions, is exported at the end of each run, and
+         *  used from the first iteration of the next one instead of the steepest descent. The curvature is only carried over
+         *  between runs of the same direction on problems of the same dimension. See also clear_curvature.
+         */
+        bool warm_start;
+
+        /** @brief Optional profiler of the phases of the iterations
+         *
+         *  When set, the wall-clock time and the hardware counters spent in the evaluations of the functor, the direction,
+         *  the line-search, the stopping test and the model update are accumulated in it, over all the runs of the minimizer.
+         */
+        tools::shared_ptr<phase_profiler> profiler;
+
+        /** @brief Discards the curvature information exported by the last run */
+        void clear_curvature(){
+            curvature_.clear();
+        }
+
         double tolerance;
 
         unsigned int verbosity_level;
@@ -95,13 +166,115 @@ namespace umintl{
             result.iteration = context.iter();
             result.n_functions_eval = context.fun().n_value_computations();
             result.n_gradient_eval = context.fun().n_gradient_computations();
+            result.n_hessian_vector_product_computations = context.fun().n_hessian_vector_product_computations();
+            result.n_datapoints_accessed = context.fun().n_datapoints_accessed();
             result.termination_cause = termination_cause;
 
+            //The final state, unless the observers requested the termination as soon as they saw it. The stopping criterion and the
+            //line-search end the iteration they are tested in
+            if(termination_cause != optimization_result::OBSERVER_REQUEST){
+                bool in_iteration = termination_cause==optimization_result::STOPPING_CRITERION || termination_cause==optimization_result::LINE_SEARCH_FAILED;
+                notify(context, context.iter() + in_iteration);
+            }
+            for(std::size_t i = 0 ; i < active_observers_.size() ; ++i)
+                active_observers_[i]->finish(result);
+            active_observers_.clear();
+
+            if(warm_start){
+                curvature_.clear();
+                tools::state_writer writer(curvature_);
+                if(direction->export_curvature(context,writer)){
+                    curvature_dimension_ = N;
+                    curvature_direction_ = direction->info();
+                }
+                else
+                    curvature_.clear();
+            }
+
             clean_all(context);
 
+            //Waits for the last checkpoint to be on disk
+            if(checkpoint_writer_.get()){
+                tools::shared_ptr<tools::async_file_writer> writer = checkpoint_writer_;
+                checkpoint_writer_.reset();
+                writer->flush();
+            }
+
             return result;
         }
 
+        /** @brief Serializes the state of the minimizer at the beginning of an iteration
+         *
+         *  Versioned format : magic string, version, size of the scalars, dimension and direction, followed by the optimization
+         *  context, the state of the direction, of the model, and of the function wrapper (evaluation counters).
+         */
+        void save_state(optimization_context<BackendType> & c, std::vector<char> & buffer) const{
+            typedef typename BackendType::ScalarType ScalarType;
+            std::size_t N = c.N();
+            buffer.clear();
+            tools::state_writer writer(buffer);
+            writer.write_string(checkpoint_magic());
+            writer.write(checkpoint_version());
+            writer.write<unsigned int>(sizeof(ScalarType));
+            writer.write<unsigned long long>(N);
+            writer.write_string(direction->info());
+
+            writer.write(c.iter());
+            writer.write_vector<ScalarType>(c.x(),N);
+            writer.write_vector<ScalarType>(c.g(),N);
+            writer.write_vector<ScalarType>(c.p(),N);
+            writer.write_vector<ScalarType>(c.xm1(),N);
+            writer.write_vector<ScalarType>(c.gm1(),N);
+            writer.write(c.val());
+            writer.write(c.valm1());
+            writer.write(c.dphi_0());
+            writer.write(c.alpha());
+
+            direction->save_state(c,writer);
+            model->save_state(writer);
+            c.fun().save_state(writer);
+        }
+
+        /** @brief Restores the state written by save_state. The components must be initialized */
+        void load_state(optimization_context<BackendType> & c, tools::state_reader & reader){
+            typedef typename BackendType::ScalarType ScalarType;
+            std::size_t N = c.N();
+            reader.expect(checkpoint_magic());
+            if(reader.read<unsigned int>() != checkpoint_version())
+                throw exceptions::io_error("Unsupported checkpoint version");
+            if(reader.read<unsigned int>() != sizeof(ScalarType))
+                throw exceptions::io_error("Incompatible checkpoint : different scalar type");
+            if(reader.read<unsigned long long>() != N)
+                throw exceptions::io_error("Incompatible checkpoint : different dimension");
+            reader.expect(direction->info());
+
+            c.iter() = reader.read<unsigned int>();
+            reader.read_vector<ScalarType>(c.x(),N);
+            reader.read_vector<ScalarType>(c.g(),N);
+            reader.read_vector<ScalarType>(c.p(),N);
+            reader.read_vector<ScalarType>(c.xm1(),N);
+            reader.read_vector<ScalarType>(c.gm1(),N);
+            c.val() = reader.read<ScalarType>();
+            c.valm1() = reader.read<ScalarType>();
+            c.dphi_0() = reader.read<ScalarType>();
+            c.alpha() = reader.read<ScalarType>();
+
+            direction->load_state(c,reader);
+            model->load_state(reader);
+            c.fun().load_state(reader);
+        }
+
+        static std::string checkpoint_magic(){ return "UMINTLCK"; }
+        static unsigned int checkpoint_version(){ return 1; }
+
+        /** @brief Hands a snapshot to the writer thread, every checkpoint_frequency iterations. The state just resumed from is not rewritten */
+        void checkpoint(optimization_context<BackendType> & c){
+            if(checkpoint_writer_.get() && c.iter() > first_iter_ && c.iter() % checkpoint_frequency == 0){
+                save_state(c,snapshot_);
+                checkpoint_writer_->submit(snapshot_);
+            }
+        }
+
         /** @brief Init the components of the procedure (ie allocate memory for the temporaries, typically)
          */
         void init_all(optimization_context<BackendType> & c){
@@ -118,40 +291,131 @@ namespace umintl{
             stopping_criterion->clean(c);
         }
 
-    public:
-        template<class Fun>
-        optimization_result operator()(typename BackendType::VectorType & res, Fun & fun, typename BackendType::VectorType const & x0, std::size_t N){
-            tools::shared_ptr<umintl::direction<BackendType> > steepest_descent(new umintl::steepest_descent<BackendType>());
-            line_search_result<BackendType> search_res(N);
-            optimization_context<BackendType> c(x0, N, *model, new detail::function_wrapper_impl<BackendType, Fun>(fun,N,hessian_vector_product_computation));
+        /** @brief Sets up the observers of a run. Progress is printed by a printer for verbosity levels of 2 and above */
+        void init_observers(){
+            active_observers_ = observers;
+            if(verbosity_level >= 2)
+                active_observers_.push_back(tools::shared_ptr<umintl::observer<BackendType> >(new printer<BackendType>()));
+            for(std::size_t i = 0 ; i < active_observers_.size() ; ++i)
+                active_observers_[i]->init();
+            timer_.start();
+            last_time_ = 0;
+            phases_ = phase_statistics();
+        }
 
-            init_all(c);
+        /** @brief Calls the observers with the state reached after iter iterations. Returns true if one of them requests the termination */
+        bool notify(optimization_context<BackendType> & c, unsigned int iter){
+            if(active_observers_.empty())
+                return false;
+            double elapsed = timer_.get();
+            iteration_info<BackendType> info(c, BackendType::nrm2(c.N(),c.g()), phases_, elapsed - last_time_, elapsed);
+            info.iter = iter;
+            last_time_ = elapsed;
+            phases_ = phase_statistics();
+            bool stop = false;
+            for(std::size_t i = 0 ; i < active_observers_.size() ; ++i)
+                stop = (*active_observers_[i])(info) || stop;
+            return stop;
+        }
 
-            if(verbosity_level >= 1)
-                std::cout << info() << std::endl;
+        /** @brief Phase timings are only measured when observers are attached, or by the profiler */
+        void begin_phase(tag::phase::type phase){
+            if(profiler.get())
+                profiler->begin(phase);
+            if(!active_observers_.empty())
+                phase_start_ = timer_.get();
+        }
+
+        void end_phase(double & time){
+            if(!active_observers_.empty())
+                time = timer_.get() - phase_start_;
+            if(profiler.get())
+                profiler->end();
+        }
+
+        bool stopping_test(optimization_context<BackendType> & c){
+            if(profiler.get())
+                profiler->begin(tag::phase::STOPPING_TEST);
+            bool stop = (*stopping_criterion)(c);
+            if(profiler.get())
+                profiler->end();
+            return stop;
+        }
+
+        /** @brief Wraps the functor, so that its evaluations are profiled */
+        detail::function_wrapper<BackendType> * wrap(detail::function_wrapper<BackendType> * fun){
+            if(profiler.get())
+                return new detail::profiled_function_wrapper<BackendType>(fun, profiler);
+            return fun;
+        }
+
+        /** @brief Main loop for the fixed-step directions
+         *
+         *  No line-search is performed : the direction already contains the step, and each iteration costs exactly one
+         *  evaluation of the value and gradient, on the sample provided by the model (see direction::evaluate).
+         */
+        optimization_result fixed_step_loop(typename BackendType::VectorType & res, std::size_t N, optimization_context<BackendType> & c){
+            for( ; c.iter() < max_iter ; ++c.iter()){
+                checkpoint(c);
+                if(notify(c, c.iter()))
+                    return terminate(optimization_result::OBSERVER_REQUEST, res, N, c);
+
+                begin_phase(tag::phase::DIRECTION);
+                (*direction)(c);
+                end_phase(phases_.direction_time);
+                c.alpha() = 1;
+                c.dphi_0() = BackendType::dot(N,c.p(),c.g());
+
+                BackendType::copy(N,c.x(),c.xm1());
+                BackendType::axpy(N,1,c.p(),c.x());
+                BackendType::copy(N,c.g(),c.gm1());
+                c.valm1() = c.val();
+
+                begin_phase(tag::phase::MODEL_UPDATE);
+                model->update(c);
+                c.fun().track_gradient_variance(model->needs_gradient_variance());
+                direction->evaluate(c);
+                end_phase(phases_.model_time);
 
+                if(stopping_test(c)){
+                    return terminate(optimization_result::STOPPING_CRITERION, res, N, c);
+                }
+            }
+            return terminate(optimization_result::MAX_ITERATION_REACHED, res, N, c);
+        }
+
+    private:
+        /** @brief Main loop
+         *
+         *  @param has_curvature whether the direction already has curvature information (resumed or warm-started run). Otherwise,
+         *  the steepest descent is used at the first iteration.
+         */
+        optimization_result run(typename BackendType::VectorType & res, std::size_t N, optimization_context<BackendType> & c, bool has_curvature){
+            if(!checkpoint_file.empty() && checkpoint_frequency > 0)
+                checkpoint_writer_.reset(new tools::async_file_writer(checkpoint_file));
+            first_iter_ = c.iter();
+            init_observers();
+
+            if(direction->is_fixed_step())
+                return fixed_step_loop(res, N, c);
+
+            tools::shared_ptr<umintl::direction<BackendType> > steepest_descent(new umintl::steepest_descent<BackendType>());
+            line_search_result<BackendType> search_res(N);
 
             tools::shared_ptr<umintl::direction<BackendType> > current_direction;
-            if(dynamic_cast<truncated_newton<BackendType> * >(direction.get()))
+            if(has_curvature)
+              current_direction = direction;
+            else if(dynamic_cast<truncated_newton<BackendType> * >(direction.get()))
               current_direction = steepest_descent;
             else
               current_direction = steepest_descent;
 
-            //Main loop
-            c.fun().compute_value_gradient(c.x(), c.val(), c.g(), c.model().get_value_gradient_tag());
             for( ; c.iter() < max_iter ; ++c.iter()){
-                if(verbosity_level >= 2 ){
-                    std::cout << "Ieration  " << c.iter()
-                              << "| cost : " << c.val()
-                              << "| NVal : " << c.fun().n_value_computations()
-                              << "| NGrad : " << c.fun().n_gradient_computations();
-                    if(unsigned int NHv = c.fun().n_hessian_vector_product_computations())
-                     std::cout<< "| NHv : " << NHv ;
-                    if(unsigned int ND = c.fun().n_datapoints_accessed())
-                     std::cout << "| NAccesses " << (float)ND;
-                    std::cout << std::endl;
-                }
+                checkpoint(c);
+                if(notify(c, c.iter()))
+                    return terminate(optimization_result::OBSERVER_REQUEST, res, N, c);
 
+                begin_phase(tag::phase::DIRECTION);
                 (*current_direction)(c);
 
                 c.dphi_0() = BackendType::dot(N,c.p(),c.g());
@@ -162,8 +426,13 @@ namespace umintl{
                     (*current_direction)(c);
                     c.dphi_0() = BackendType::dot(N,c.p(),c.g());
                 }
+                end_phase(phases_.direction_time);
 
+                unsigned int n_evaluations = c.fun().n_value_computations();
+                begin_phase(tag::phase::LINE_SEARCH);
                 (*line_search)(search_res, current_direction.get(), c);
+                end_phase(phases_.line_search_time);
+                phases_.n_line_search_evaluations = c.fun().n_value_computations() - n_evaluations;
 
                 if(search_res.has_failed){
                     return terminate(optimization_result::LINE_SEARCH_FAILED, res, N, c);
@@ -183,17 +452,96 @@ namespace umintl{
                 c.valm1() = c.val();
                 c.val() = search_res.best_phi;
 
-                if((*stopping_criterion)(c)){
+                if(stopping_test(c)){
                     return terminate(optimization_result::STOPPING_CRITERION, res, N, c);
                 }
                 current_direction = direction;
 
-                if(model->update(c))
-                  c.fun().compute_value_gradient(c.x(), c.val(), c.g(), c.model().get_value_gradient_tag());
+                begin_phase(tag::phase::MODEL_UPDATE);
+                //The line-search has evaluated c.val() and c.g() at c.x(), on the samples preceding the update
+                value_gradient evaluated = c.model().get_value_gradient_tag();
+                if(model->update(c)){
+                  c.fun().track_gradient_variance(model->needs_gradient_variance());
+                  if(model->has_extended_sample())
+                    c.fun().extend_value_gradient(c.x(), c.val(), c.g(), evaluated, c.model().get_value_gradient_tag());
+                  else
+                    c.fun().compute_value_gradient(c.x(), c.val(), c.g(), c.model().get_value_gradient_tag());
+                }
+                end_phase(phases_.model_time);
             }
 
             return terminate(optimization_result::MAX_ITERATION_REACHED, res, N, c);
         }
+
+    public:
+        template<class Fun>
+        optimization_result operator()(typename BackendType::VectorType & res, Fun & fun, typename BackendType::VectorType const & x0, std::size_t N){
+            optimization_context<BackendType> c(x0, N, *model, wrap(new detail::function_wrapper_impl<BackendType, Fun>(fun,N,hessian_vector_product_computation,n_shards)));
+
+            init_all(c);
+
+            if(verbosity_level >= 1)
+                std::cout << info() << std::endl;
+
+            c.fun().track_gradient_variance(model->needs_gradient_variance());
+            direction->evaluate(c);
+
+            bool seeded = false;
+            if(warm_start && curvature_.size() && curvature_dimension_==N && curvature_direction_==direction->info()){
+                tools::state_reader reader(curvature_);
+                direction->import_curvature(c, reader);
+                seeded = true;
+            }
+            return run(res, N, c, seeded);
+        }
+
+        /** @brief Continues an optimization from a checkpoint
+         *
+         *  The minimizer must be configured as in the interrupted run (direction, model, line-search, n_shards...). The run then
+         *  continues bit-identically, as if it had not been interrupted.
+         *
+         *  @param res the result. Its content is ignored
+         *  @param fun the functor
+         *  @param filename the checkpoint file
+         *  @param N the dimension of the problem
+         */
+        template<class Fun>
+        optimization_result resume(typename BackendType::VectorType & res, Fun & fun, std::string const & filename, std::size_t N){
+            tools::state_reader reader;
+            reader.load(filename);
+
+            //The starting point is overwritten by the checkpoint
+            optimization_context<BackendType> c(res, N, *model, wrap(new detail::function_wrapper_impl<BackendType, Fun>(fun,N,hessian_vector_product_computation,n_shards)));
+
+            init_all(c);
+            try{
+                load_state(c, reader);
+            }
+            catch(...){
+                clean_all(c);
+                throw;
+            }
+
+            if(verbosity_level >= 1)
+                std::cout << info() << std::endl;
+
+            return run(res, N, c, true);
+        }
+
+    private:
+        tools::shared_ptr<tools::async_file_writer> checkpoint_writer_;
+        std::vector<char> snapshot_;
+        unsigned int first_iter_;
+
+        std::vector<tools::shared_ptr<umintl::observer<BackendType> > > active_observers_;
+        tools::timer timer_;
+        double last_time_;
+        phase_statistics phases_;
+        double phase_start_;
+
+        std::vector<char> curvature_;
+        std::size_t curvature_dimension_;
+        std::string curvature_direction_;
     };
 
 
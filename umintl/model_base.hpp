@@ -4,10 +4,22 @@
 #include <cstddef>
 #include "umintl/forwards.h"
 #include "umintl/optimization_context.hpp"
+#include "umintl/tools/serialization.hpp"
+#include "umintl/tools/exception.hpp"
 #include <cmath>
 
 namespace umintl{
 
+/** @brief The window_hint class
+ *
+ *  Receives, at each update of a stochastic model, the window of samples that the model will select at its next update.
+ *  Typically used to load this window in the background while the current one is processed.
+ */
+struct window_hint{
+    virtual ~window_hint(){ }
+    virtual void next_window(operation_tag const & tag) = 0;
+};
+
 /** @brief The model_base class
  *
  *  The optimization model can be either deterministic or stochastic.  The latter usually corresponds to expected losses
@@ -15,10 +27,40 @@ namespace umintl{
  */
 template<class BackendType>
 struct model_base{
+    model_base() : hint_(NULL){ }
     virtual ~model_base(){ }
     virtual bool update(optimization_context<BackendType> & context) = 0;
     virtual value_gradient get_value_gradient_tag() const = 0;
     virtual hessian_vector_product get_hv_product_tag() const = 0;
+
+    /** @brief Whether update needs the variance of the gradient at the current point. It is then computed along with the gradient when possible */
+    virtual bool needs_gradient_variance() const { return false; }
+
+    /** @brief Whether the last update only added samples to the value-gradient evaluations, the previous samples being part of the new ones
+     *
+     *  The evaluation at the current point is then completed on the new samples, instead of being performed again on all of them. This
+     *  requires the functor to return averages over its samples.
+     */
+    virtual bool has_extended_sample() const { return false; }
+
+    /** @brief Saves the position of the model in the dataset, for checkpointing. Throws by default */
+    virtual void save_state(tools::state_writer &) const {
+      throw exceptions::incompatible_parameters("Checkpointing is not supported by the model");
+    }
+    /** @brief Restores the state saved by save_state */
+    virtual void load_state(tools::state_reader &) {
+      throw exceptions::incompatible_parameters("Checkpointing is not supported by the model");
+    }
+
+    /** @brief Sets the receiver of the next windows. Not owned : must outlive the optimization */
+    void set_window_hint(window_hint * hint){ hint_ = hint; }
+protected:
+    void notify_next_window(std::size_t sample_size, std::size_t offset){
+      if(hint_)
+        hint_->next_window(operation_tag(STOCHASTIC,sample_size,offset));
+    }
+private:
+    window_hint * hint_;
 };
 
 /** @brief The deterministic class
@@ -31,22 +73,43 @@ struct deterministic : public model_base<BackendType> {
     bool update(optimization_context<BackendType> &){ return false; }
     value_gradient get_value_gradient_tag() const { return value_gradient(DETERMINISTIC,0,0); }
     hessian_vector_product get_hv_product_tag() const { return hessian_vector_product(DETERMINISTIC,0,0); }
+    void save_state(tools::state_writer &) const { }
+    void load_state(tools::state_reader &) { }
 };
 
+/** @brief The mini_batch class
+ *
+ *  Hessian-vector products are evaluated on a mini-batch of sample_size data-points, which moves accross the dataset at each
+ *  iteration. The gradient is also evaluated on the mini-batch if subsample_gradient is true (typically for the fixed-step
+ *  directions, such as stochastic_gradient or adam), and on the whole dataset otherwise.
+ */
 template<class BackendType>
 struct mini_batch : public model_base<BackendType> {
   public:
-    mini_batch(std::size_t sample_size, std::size_t dataset_size) : sample_size_(std::min(sample_size,dataset_size)), offset_(0), dataset_size_(dataset_size){ }
+    mini_batch(std::size_t sample_size, std::size_t dataset_size, bool subsample_gradient = false) : sample_size_(std::min(sample_size,dataset_size)), offset_(0), dataset_size_(dataset_size), subsample_gradient_(subsample_gradient){ }
     bool update(optimization_context<BackendType> &){
       offset_=(offset_+sample_size_)%dataset_size_;
-      return false;
+      std::size_t next_offset = (offset_+sample_size_)%dataset_size_;
+      this->notify_next_window(std::min(sample_size_,dataset_size_-next_offset),next_offset);
+      return subsample_gradient_;
+    }
+    value_gradient get_value_gradient_tag() const {
+      if(subsample_gradient_)
+        return value_gradient(STOCHASTIC,std::min(sample_size_,dataset_size_-offset_),offset_);
+      return value_gradient(STOCHASTIC,dataset_size_,0);
     }
-    value_gradient get_value_gradient_tag() const { return value_gradient(STOCHASTIC,dataset_size_,0); }
     hessian_vector_product get_hv_product_tag() const { return hessian_vector_product(STOCHASTIC,sample_size_,offset_); }
+    void save_state(tools::state_writer & writer) const {
+      writer.write<unsigned long long>(offset_);
+    }
+    void load_state(tools::state_reader & reader) {
+      offset_ = reader.read<unsigned long long>();
+    }
 private:
     std::size_t sample_size_;
     std::size_t offset_;
     std::size_t dataset_size_;
+    bool subsample_gradient_;
 };
 
 /** @brief the dynamically_sampled class
@@ -55,8 +118,13 @@ private:
  * "Sample Size Selection in Optimization Methods for Machine Learning"
  * Requires that the functor overloads :
  * void operator()(VectorType const & X, VectorType & variance, umintl::gradient_variance_tag tag)
+ * or, preferably :
+ * void operator()(VectorType const & X, ScalarType & value, VectorType & gradient, VectorType & variance, umintl::value_gradient_variance tag)
+ * in which case the variance is accumulated in the same pass over the samples as the gradient (see tools::welford).
  *
- * The parameter tag contains the information on the current offset and sample size
+ * The parameter tag contains the information on the current offset and sample size. The value and the gradient must be averages over
+ * the samples of the tag : when the sample size grows, the evaluation at the current point is completed on the new samples only, and
+ * merged with the previous one by sample count (see model_base::has_extended_sample).
  */
 template<class BackendType>
 struct dynamically_sampled : public model_base<BackendType> {
@@ -65,7 +133,7 @@ struct dynamically_sampled : public model_base<BackendType> {
     typedef typename BackendType::VectorType VectorType;
 
   public:
-    dynamically_sampled(double r, std::size_t S0, std::size_t dataset_size, double theta = 0.5) : r_(r), S(std::min(S0,dataset_size)), offset_(0), H_offset_(0), N(dataset_size), theta_(theta){ }
+    dynamically_sampled(double r, std::size_t S0, std::size_t dataset_size, double theta = 0.5) : theta_(theta), r_(r), S(std::min(S0,dataset_size)), offset_(0), H_offset_(0), N(dataset_size), extended_(false){ }
 
     bool update(optimization_context<BackendType> & c){
 //      {
@@ -99,6 +167,7 @@ struct dynamically_sampled : public model_base<BackendType> {
 //      }
 
 
+      extended_ = false;
       if(S==N){
         H_offset_=(H_offset_+(int)(r_*S))%(S - (int)(r_*S) + 1);
         return false;
@@ -122,7 +191,14 @@ struct dynamically_sampled : public model_base<BackendType> {
             S=N;
           std::cout << "Augmenting sample size from " << old_S << " to " << S << std::endl;
         }
-        offset_=(offset_+S)%(N-S+1);
+        if(is_descent_direction)
+          offset_=(offset_+S)%(N-S+1);
+        else{
+          //The grown window contains the current one, so that only the new samples have to be evaluated at this point
+          offset_=std::min(offset_,N-S);
+          extended_ = true;
+        }
+        this->notify_next_window(S,(offset_+S)%(N-S+1));
 
         if(is_descent_direction==false)
           H_offset_ = 0;
@@ -138,9 +214,29 @@ struct dynamically_sampled : public model_base<BackendType> {
       return value_gradient(STOCHASTIC,S,offset_);
     }
 
+    bool needs_gradient_variance() const {
+      return S < N;
+    }
+
+    bool has_extended_sample() const {
+      return extended_;
+    }
+
     hessian_vector_product get_hv_product_tag() const {
       return hessian_vector_product(STOCHASTIC,r_*S,H_offset_+offset_);
     }
+
+    void save_state(tools::state_writer & writer) const {
+      writer.write<unsigned long long>(S);
+      writer.write<unsigned long long>(offset_);
+      writer.write<unsigned long long>(H_offset_);
+    }
+
+    void load_state(tools::state_reader & reader) {
+      S = reader.read<unsigned long long>();
+      offset_ = reader.read<unsigned long long>();
+      H_offset_ = reader.read<unsigned long long>();
+    }
 private:
     double theta_;
     double r_;
@@ -148,6 +244,7 @@ private:
     std::size_t offset_;
     std::size_t H_offset_;
     std::size_t N;
+    bool extended_;
 };
 
 
@@ -0,0 +1,86 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+
+#ifndef UMINTL_OBSERVERS_FORWARDS_H
+#define UMINTL_OBSERVERS_FORWARDS_H
+
+#include "umintl/optimization_context.hpp"
+#include "umintl/optimization_result.hpp"
+
+namespace umintl{
+
+/** @brief Wall-clock time, in seconds, spent in the phases of an iteration */
+struct phase_statistics{
+    phase_statistics() : direction_time(0), line_search_time(0), model_time(0), n_line_search_evaluations(0){ }
+    /** @brief computation of the direction */
+    double direction_time;
+    /** @brief line-search */
+    double line_search_time;
+    /** @brief update of the model, and re-evaluation of the gradient on the new sample */
+    double model_time;
+    /** @brief number of function evaluations of the line-search */
+    unsigned int n_line_search_evaluations;
+};
+
+/** @brief Read-only view of the state of the minimizer at the beginning of an iteration, or at the termination */
+template<class BackendType>
+struct iteration_info{
+    typedef typename BackendType::ScalarType ScalarType;
+    typedef typename BackendType::VectorType VectorType;
+
+    iteration_info(optimization_context<BackendType> & c, ScalarType _gradient_norm, phase_statistics const & _phases, double _iteration_time, double _elapsed_time)
+        : iter(c.iter()), N(c.N()), x(c.x()), g(c.g()), value(c.val()), gradient_norm(_gradient_norm), alpha(c.alpha()), dphi_0(c.dphi_0())
+        , sample_size(c.model().get_value_gradient_tag().sample_size), phases(_phases)
+        , n_value_computations(c.fun().n_value_computations()), n_gradient_computations(c.fun().n_gradient_computations())
+        , n_hessian_vector_product_computations(c.fun().n_hessian_vector_product_computations())
+        , n_datapoints_accessed(c.fun().n_datapoints_accessed()), iteration_time(_iteration_time), elapsed_time(_elapsed_time){ }
+
+    /** @brief number of iterations performed */
+    unsigned int iter;
+    std::size_t N;
+    VectorType const & x;
+    VectorType const & g;
+    ScalarType value;
+    ScalarType gradient_norm;
+    /** @brief step of the previous iteration */
+    ScalarType alpha;
+    /** @brief directional derivative along the previous direction */
+    ScalarType dphi_0;
+    /** @brief number of samples of the gradient. 0 for deterministic models */
+    std::size_t sample_size;
+    /** @brief phases of the previous iteration */
+    phase_statistics phases;
+    unsigned int n_value_computations;
+    unsigned int n_gradient_computations;
+    unsigned int n_hessian_vector_product_computations;
+    unsigned int n_datapoints_accessed;
+    /** @brief wall-clock time of the previous iteration, in seconds */
+    double iteration_time;
+    /** @brief wall-clock time since the beginning of the run, in seconds */
+    double elapsed_time;
+};
+
+/** @brief Base class for an observer of the iterations
+ *
+ *  Called at the beginning of each iteration, with the state reached by the previous one, and once more when the optimization
+ *  terminates, with the final state and the phases of the last iteration. This last call is skipped when an observer requested the
+ *  termination, since the observers have already seen the final state.
+ */
+template<class BackendType>
+struct observer{
+    virtual ~observer(){ }
+    virtual void init(){ }
+    /** @return true to stop the optimization */
+    virtual bool operator()(iteration_info<BackendType> const & info) = 0;
+    /** @brief Called once the optimization has terminated */
+    virtual void finish(optimization_result const &){ }
+};
+
+}
+
+#endif
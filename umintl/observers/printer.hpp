@@ -0,0 +1,72 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+
+#ifndef UMINTL_OBSERVERS_PRINTER_HPP_
+#define UMINTL_OBSERVERS_PRINTER_HPP_
+
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "forwards.h"
+
+namespace umintl{
+
+/** @brief The printer class
+ *
+ *  Prints the progress of the optimization. The lines are buffered, and only written to the stream once buffer_size bytes have
+ *  accumulated and at the end of the optimization, so that a slow output does not slow down short iterations.
+ *  Used by the minimizer for verbosity levels of 2 and above.
+ */
+template<class BackendType>
+struct printer : public observer<BackendType>{
+    /** @brief The constructor
+     *
+     *  @param _os the output stream. Not owned : must outlive the optimization
+     *  @param _buffer_size number of bytes buffered before writing to the stream. The lines are written immediately if 0.
+     */
+    printer(std::ostream & _os = std::cout, std::size_t _buffer_size = 4096) : os(_os), buffer_size(_buffer_size){ }
+
+    void init(){
+        buffer_.str("");
+    }
+
+    bool operator()(iteration_info<BackendType> const & info){
+        buffer_ << "Ieration  " << info.iter
+                << "| cost : " << info.value
+                << "| NVal : " << info.n_value_computations
+                << "| NGrad : " << info.n_gradient_computations;
+        if(info.n_hessian_vector_product_computations)
+            buffer_ << "| NHv : " << info.n_hessian_vector_product_computations;
+        if(info.n_datapoints_accessed)
+            buffer_ << "| NAccesses " << (float)info.n_datapoints_accessed;
+        buffer_ << '\n';
+        if(buffer_.tellp() >= (std::streampos)buffer_size)
+            flush();
+        return false;
+    }
+
+    void finish(optimization_result const &){
+        flush();
+    }
+
+    std::ostream & os;
+    std::size_t buffer_size;
+
+private:
+    void flush(){
+        os << buffer_.str() << std::flush;
+        buffer_.str("");
+    }
+
+    std::ostringstream buffer_;
+};
+
+}
+
+#endif
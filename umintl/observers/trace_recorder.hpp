@@ -0,0 +1,233 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+
+#ifndef UMINTL_OBSERVERS_TRACE_RECORDER_HPP_
+#define UMINTL_OBSERVERS_TRACE_RECORDER_HPP_
+
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+#include <pthread.h>
+
+#include "umintl/tools/exception.hpp"
+
+#include "forwards.h"
+
+namespace umintl{
+
+/** @brief Fixed-size record of an iteration, as stored in a trace file */
+struct trace_record{
+    unsigned int iter;
+    unsigned int n_line_search_evaluations;
+    unsigned int n_value_computations;
+    unsigned int n_gradient_computations;
+    unsigned int n_hessian_vector_product_computations;
+    unsigned int n_datapoints_accessed;
+    unsigned long long sample_size;
+    double value;
+    double gradient_norm;
+    double dphi_0;
+    double alpha;
+    double direction_time;
+    double line_search_time;
+    double model_time;
+    double elapsed_time;
+};
+
+/** @brief Layout of the trace files : a header, followed by the records in the native byte order */
+struct trace_format{
+    static const char * magic(){ return "UMINTLTR"; }
+    static unsigned int version(){ return 1; }
+};
+
+/** @brief Reads back all the records of a trace file. Throws exceptions::io_error if the file is not a trace of this version */
+inline void load_trace(std::string const & filename, std::vector<trace_record> & records){
+    FILE * file = std::fopen(filename.c_str(), "rb");
+    if(!file)
+        throw exceptions::io_error("Cannot open " + filename);
+    char magic[8];
+    unsigned int header[2];
+    bool valid = std::fread(magic, 1, 8, file)==8 && std::memcmp(magic, trace_format::magic(), 8)==0
+              && std::fread(header, sizeof(unsigned int), 2, file)==2
+              && header[0]==trace_format::version() && header[1]==sizeof(trace_record);
+    if(!valid){
+        std::fclose(file);
+        throw exceptions::io_error("Incompatible trace : " + filename);
+    }
+    records.clear();
+    trace_record chunk[256];
+    std::size_t n;
+    while((n = std::fread(chunk, sizeof(trace_record), 256, file)) > 0)
+        records.insert(records.end(), chunk, chunk + n);
+    bool failed = std::ferror(file);
+    std::fclose(file);
+    if(failed)
+        throw exceptions::io_error("Cannot read " + filename);
+}
+
+/** @brief The trace_recorder class
+ *
+ *  Records every iteration in a binary trace file, without formatting any text during the optimization. The records are copied
+ *  into a preallocated ring buffer, which a background thread writes to the file whenever it is half full. The minimizer only
+ *  waits when the ring is full, that is when the disk cannot keep up with the iterations.
+ *  The file is read back with load_trace, or converted to CSV/JSON with the umintl-trace-convert utility.
+ */
+template<class BackendType>
+struct trace_recorder : public observer<BackendType>{
+private:
+    trace_recorder(trace_recorder const &);
+    trace_recorder & operator=(trace_recorder const &);
+
+    static void * run(void * args){
+        static_cast<trace_recorder *>(args)->loop();
+        return NULL;
+    }
+
+    void loop(){
+        std::size_t capacity = ring_.size();
+        pthread_mutex_lock(&mutex_);
+        while(true){
+            while(head_ - tail_ < (capacity+1)/2 && !stop_)
+                pthread_cond_wait(&cond_, &mutex_);
+            if(head_ == tail_)
+                break;
+            unsigned long long begin = tail_, end = head_;
+            pthread_mutex_unlock(&mutex_);
+
+            //The slots of [begin, end[ are not reused by the producer until tail_ is updated
+            bool failed = false;
+            while(begin < end){
+                std::size_t offset = begin % capacity;
+                std::size_t n = std::min((std::size_t)(end - begin), capacity - offset);
+                failed = failed || std::fwrite(&ring_[offset], sizeof(trace_record), n, file_) != n;
+                begin += n;
+            }
+
+            pthread_mutex_lock(&mutex_);
+            if(failed)
+                failed_ = true;
+            tail_ = end;
+            pthread_cond_broadcast(&cond_);
+        }
+        pthread_mutex_unlock(&mutex_);
+    }
+
+    void stop(){
+        if(!is_running_)
+            return;
+        pthread_mutex_lock(&mutex_);
+        stop_ = true;
+        pthread_cond_broadcast(&cond_);
+        pthread_mutex_unlock(&mutex_);
+        pthread_join(thread_, NULL);
+        is_running_ = false;
+    }
+
+    bool close(){
+        stop();
+        if(!file_)
+            return true;
+        bool ok = std::fclose(file_)==0 && !failed_;
+        file_ = NULL;
+        return ok;
+    }
+
+public:
+    /** @brief The constructor
+     *
+     *  @param _filename path of the trace file. Overwritten at the beginning of each optimization.
+     *  @param _capacity number of records of the ring buffer
+     */
+    trace_recorder(std::string const & _filename, std::size_t _capacity = 1024) : filename(_filename), ring_(std::max(_capacity,(std::size_t)2)), file_(NULL), is_running_(false){
+        pthread_mutex_init(&mutex_, NULL);
+        pthread_cond_init(&cond_, NULL);
+    }
+
+    ~trace_recorder(){
+        close();
+        pthread_mutex_destroy(&mutex_);
+        pthread_cond_destroy(&cond_);
+    }
+
+    void init(){
+        close();
+        file_ = std::fopen(filename.c_str(), "wb");
+        if(!file_)
+            throw exceptions::io_error("Cannot open " + filename);
+        unsigned int header[2] = {trace_format::version(), (unsigned int)sizeof(trace_record)};
+        if(std::fwrite(trace_format::magic(), 1, 8, file_)!=8 || std::fwrite(header, sizeof(unsigned int), 2, file_)!=2){
+            close();
+            throw exceptions::io_error("Cannot write " + filename);
+        }
+        head_ = tail_ = 0;
+        stop_ = false;
+        failed_ = false;
+        if(pthread_create(&thread_, NULL, &trace_recorder::run, this) != 0){
+            close();
+            throw exceptions::io_error("Cannot create the writer thread of " + filename);
+        }
+        is_running_ = true;
+    }
+
+    bool operator()(iteration_info<BackendType> const & info){
+        trace_record r;
+        r.iter = info.iter;
+        r.n_line_search_evaluations = info.phases.n_line_search_evaluations;
+        r.n_value_computations = info.n_value_computations;
+        r.n_gradient_computations = info.n_gradient_computations;
+        r.n_hessian_vector_product_computations = info.n_hessian_vector_product_computations;
+        r.n_datapoints_accessed = info.n_datapoints_accessed;
+        r.sample_size = info.sample_size;
+        r.value = info.value;
+        r.gradient_norm = info.gradient_norm;
+        r.dphi_0 = info.dphi_0;
+        r.alpha = info.alpha;
+        r.direction_time = info.phases.direction_time;
+        r.line_search_time = info.phases.line_search_time;
+        r.model_time = info.phases.model_time;
+        r.elapsed_time = info.elapsed_time;
+
+        std::size_t capacity = ring_.size();
+        pthread_mutex_lock(&mutex_);
+        while(head_ - tail_ == capacity)
+            pthread_cond_wait(&cond_, &mutex_);
+        ring_[head_ % capacity] = r;
+        head_++;
+        if(head_ - tail_ == (capacity+1)/2)
+            pthread_cond_signal(&cond_);
+        pthread_mutex_unlock(&mutex_);
+        return false;
+    }
+
+    /** @brief Writes the remaining records. Throws exceptions::io_error if the trace is incomplete */
+    void finish(optimization_result const &){
+        if(!close())
+            throw exceptions::io_error("Cannot write " + filename);
+    }
+
+    std::string filename;
+
+private:
+    std::vector<trace_record> ring_;
+    FILE * file_;
+    pthread_t thread_;
+    pthread_mutex_t mutex_;
+    pthread_cond_t cond_;
+    unsigned long long head_;
+    unsigned long long tail_;
+    bool stop_;
+    bool failed_;
+    bool is_running_;
+};
+
+}
+
+#endif
@@ -20,7 +20,8 @@ namespace umintl{
       enum termination_cause_type{
           LINE_SEARCH_FAILED,
           STOPPING_CRITERION,
-          MAX_ITERATION_REACHED
+          MAX_ITERATION_REACHED,
+          OBSERVER_REQUEST
       };
 
       /** @brief the final function value */
@@ -31,6 +32,10 @@ namespace umintl{
       std::size_t n_functions_eval;
       /** @brief the final number of gradient evaluations */
       std::size_t n_gradient_eval;
+      /** @brief the final number of hessian-vector products */
+      std::size_t n_hessian_vector_product_computations;
+      /** @brief the final number of data-points accessed by the evaluations */
+      std::size_t n_datapoints_accessed;
       /** @brief the cause of the termination */
       termination_cause_type termination_cause;
   };
@@ -0,0 +1,174 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+#ifndef UMINTL_PARALLEL_HOGWILD_HPP_
+#define UMINTL_PARALLEL_HOGWILD_HPP_
+
+#include <vector>
+#include <string>
+#include <algorithm>
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include "umintl/forwards.h"
+#include "umintl/directions/step_size.hpp"
+#include "umintl/tools/timer.hpp"
+#include "umintl/tools/exception.hpp"
+
+namespace umintl{
+
+/** @brief Statistics of a hogwild run */
+struct hogwild_result{
+    /** @brief number of samples processed, over all the workers */
+    std::size_t n_samples;
+    /** @brief number of sparse updates applied to the shared iterate */
+    std::size_t n_updates;
+    /** @brief wall-clock time, in seconds */
+    double time;
+    /** @brief throughput, in samples per second */
+    double samples_per_second;
+};
+
+/** @brief The hogwild class
+ *
+ *  Asynchronous lock-free stochastic gradient descent for sparse objectives (Niu et al., 2011 : "Hogwild! A Lock-Free Approach to
+ *  Parallelizing Stochastic Gradient Descent"). The dataset is split into one contiguous stream per worker thread. Each worker walks
+ *  its stream by mini-batches of sample_size samples, and applies the sparse gradient of each mini-batch to the shared iterate
+ *  without any lock : concurrent updates of the same coordinate may be lost, which is harmless when each sample only touches
+ *  a few coordinates. Requires a host backend, and an overload of :
+ *  void operator()(VectorType const & X, std::vector<std::size_t> & indices, std::vector<ScalarType> & values, umintl::sparse_gradient tag)
+ *  which appends the nonzero entries of the mean gradient over the samples of tag (repeated indices are summed). X is being
+ *  modified by the other workers while it is read, so the functor must be thread-safe and must not rely on its consistency.
+ */
+template<class BackendType>
+class hogwild{
+private:
+    typedef typename BackendType::ScalarType ScalarType;
+    typedef typename BackendType::VectorType VectorType;
+
+    template<class Fun>
+    struct worker{
+        hogwild const * parent;
+        Fun * fun;
+        ScalarType * x;
+        std::size_t begin;
+        std::size_t end;
+        std::size_t n_samples;
+        std::size_t n_updates;
+        bool failed;
+        std::string error;
+    };
+
+    /** @brief x += v, with relaxed atomic accesses. Concurrent read-modify-writes may overwrite each other */
+    static void relaxed_add(ScalarType * x, ScalarType v){
+#ifdef __GNUC__
+        ScalarType old;
+        __atomic_load(x, &old, __ATOMIC_RELAXED);
+        ScalarType res = old + v;
+        __atomic_store(x, &res, __ATOMIC_RELAXED);
+#else
+        *x += v;
+#endif
+    }
+
+    template<class Fun>
+    static void * run(void * args){
+        worker<Fun> & w = *static_cast<worker<Fun> *>(args);
+        hogwild const & h = *w.parent;
+        std::vector<std::size_t> indices;
+        std::vector<ScalarType> values;
+        unsigned int k = 0;
+        try{
+            for(unsigned int epoch = 0 ; epoch < h.n_epochs ; ++epoch){
+                for(std::size_t offset = w.begin ; offset < w.end ; offset += h.sample_size){
+                    sparse_gradient tag(STOCHASTIC, std::min(h.sample_size, w.end - offset), offset);
+                    indices.clear();
+                    values.clear();
+                    (*w.fun)(w.x, indices, values, tag);
+                    ScalarType eta = h.eta(k++);
+                    for(std::size_t j = 0 ; j < indices.size() ; ++j)
+                        relaxed_add(&w.x[indices[j]], -eta*values[j]);
+                    w.n_samples += tag.sample_size;
+                    w.n_updates++;
+                }
+            }
+        }
+        catch(std::exception const & e){
+            w.failed = true;
+            w.error = e.what();
+        }
+        return NULL;
+    }
+
+public:
+    /** @brief The constructor
+     *
+     *  @param _eta step size schedule, indexed by the number of mini-batches processed by the worker
+     *  @param _sample_size number of samples per update
+     *  @param _dataset_size number of samples in the dataset
+     *  @param _n_threads number of workers. Defaults to the number of online processors.
+     *  @param _n_epochs number of passes over the dataset
+     */
+    hogwild(step_size _eta, std::size_t _sample_size, std::size_t _dataset_size, unsigned int _n_threads = 0, unsigned int _n_epochs = 1)
+        : eta(_eta), sample_size(std::max(_sample_size,(std::size_t)1)), dataset_size(_dataset_size), n_threads(_n_threads), n_epochs(_n_epochs){
+        if(n_threads==0)
+            n_threads = std::max(::sysconf(_SC_NPROCESSORS_ONLN),1L);
+    }
+
+    template<class Fun>
+    hogwild_result operator()(VectorType & res, Fun & fun, VectorType const & x0, std::size_t N){
+        unsigned int n_workers = std::max((std::size_t)1, std::min((std::size_t)n_threads, dataset_size));
+        std::vector<worker<Fun> > workers(n_workers);
+        std::vector<pthread_t> threads(n_workers);
+        BackendType::copy(N,x0,res);
+        for(unsigned int t = 0 ; t < n_workers ; ++t){
+            worker<Fun> & w = workers[t];
+            w.parent = this;
+            w.fun = &fun;
+            w.x = &res[0];
+            w.begin = dataset_size*t/n_workers;
+            w.end = dataset_size*(t+1)/n_workers;
+            w.n_samples = 0;
+            w.n_updates = 0;
+            w.failed = false;
+        }
+
+        tools::timer timer;
+        unsigned int n_started = 0;
+        for( ; n_started < n_workers ; ++n_started)
+            if(pthread_create(&threads[n_started], NULL, &hogwild::run<Fun>, &workers[n_started]) != 0)
+                break;
+        for(unsigned int t = 0 ; t < n_started ; ++t)
+            pthread_join(threads[t], NULL);
+
+        hogwild_result result;
+        result.time = timer.get();
+        result.n_samples = 0;
+        result.n_updates = 0;
+        for(unsigned int t = 0 ; t < n_started ; ++t){
+            if(workers[t].failed)
+                throw exceptions::incompatible_parameters("Hogwild worker failed : " + workers[t].error);
+            result.n_samples += workers[t].n_samples;
+            result.n_updates += workers[t].n_updates;
+        }
+        if(n_started < n_workers)
+            throw exceptions::incompatible_parameters("Cannot create the hogwild threads");
+        result.samples_per_second = (result.time > 0)?result.n_samples/result.time:0;
+        return result;
+    }
+
+    step_size eta;
+    std::size_t sample_size;
+    std::size_t dataset_size;
+    unsigned int n_threads;
+    unsigned int n_epochs;
+};
+
+}
+
+#endif
@@ -0,0 +1,243 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+#ifndef UMINTL_PARALLEL_SHARED_MEMORY_HPP_
+#define UMINTL_PARALLEL_SHARED_MEMORY_HPP_
+
+#include <vector>
+#include <sstream>
+#include <cstring>
+#include <algorithm>
+
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <signal.h>
+
+#include "umintl/forwards.h"
+#include "umintl/tools/exception.hpp"
+
+namespace umintl{
+
+/** @brief The shared_memory_function class
+ *
+ *  Data-parallel evaluation of a sum-over-samples objective by P processes on a single node. The constructor forks P-1 worker
+ *  processes, which attach to a POSIX shared memory segment. The calling process keeps running the minimizer (direction and
+ *  line-search) : at each evaluation, it broadcasts x and the samples of the tag through the segment, every process evaluates
+ *  the functor on its shard of the samples, and the mean gradients are combined with a shared-memory allreduce, where each
+ *  process reduces a slice of the coordinates. The reduction is done in a fixed order, so that the result does not depend on the
+ *  scheduling of the processes.
+ *
+ *  Each process owns a copy of the functor, so that the functor does not need to be thread-safe. It must return averages over
+ *  its samples, and the backend must be a host backend. Deterministic tags are evaluated on the whole dataset. Hessian-vector
+ *  products are not distributed : use the finite-difference computation of the minimizer.
+ *
+ *  Must be destroyed in the process that created it. A worker which dies makes the next evaluation hang.
+ */
+template<class BackendType, class Fun>
+class shared_memory_function{
+private:
+    typedef typename BackendType::ScalarType ScalarType;
+    typedef typename BackendType::VectorType VectorType;
+
+    shared_memory_function(shared_memory_function const &);
+    shared_memory_function & operator=(shared_memory_function const &);
+
+    enum command_type{
+        COMMAND_VALUE_GRADIENT,
+        COMMAND_TERMINATE
+    };
+
+    struct control{
+        pthread_barrier_t barrier;
+        command_type command;
+        std::size_t sample_size;
+        std::size_t offset;
+    };
+
+    static std::size_t align(std::size_t bytes){
+        return (bytes + 63)/64*64;
+    }
+
+    void wait(){
+        pthread_barrier_wait(&control_->barrier);
+    }
+
+    /** @brief Evaluates the shard of process p, then reduces its slice of the coordinates */
+    void evaluate(std::size_t p){
+        std::size_t begin = control_->offset + control_->sample_size*p/P_;
+        std::size_t end = control_->offset + control_->sample_size*(p+1)/P_;
+        counts_[p] = end - begin;
+        failed_[p] = 0;
+        if(end > begin){
+            try{
+                ScalarType * g = gradients_ + p*N_;
+                VectorType gv = g;
+                fun_(x_, values_[p], gv, value_gradient(STOCHASTIC, end - begin, begin));
+            }
+            catch(...){
+                failed_[p] = 1;
+            }
+        }
+        wait();
+
+        std::size_t total = 0;
+        for(std::size_t q = 0 ; q < P_ ; ++q)
+            total += counts_[q];
+        for(std::size_t i = N_*p/P_ ; i < N_*(p+1)/P_ ; ++i){
+            ScalarType sum = 0;
+            for(std::size_t q = 0 ; q < P_ ; ++q)
+                if(counts_[q])
+                    sum += counts_[q]*gradients_[q*N_+i];
+            result_[i] = sum/total;
+        }
+        if(p==0){
+            ScalarType sum = 0;
+            for(std::size_t q = 0 ; q < P_ ; ++q)
+                if(counts_[q])
+                    sum += counts_[q]*values_[q];
+            *result_value_ = sum/total;
+        }
+        wait();
+    }
+
+    /** @brief Stops the workers and unmaps the segment. The workers of an incomplete pool cannot reach the barrier, and are killed */
+    void release(bool graceful){
+        if(graceful){
+            control_->command = COMMAND_TERMINATE;
+            wait();
+        }
+        else{
+            for(std::size_t p = 0 ; p < workers_.size() ; ++p)
+                kill(workers_[p], SIGKILL);
+        }
+        for(std::size_t p = 0 ; p < workers_.size() ; ++p)
+            waitpid(workers_[p], NULL, 0);
+        pthread_barrier_destroy(&control_->barrier);
+        munmap(data_, bytes_);
+    }
+
+    void worker_loop(std::size_t p){
+        while(true){
+            wait();
+            if(control_->command==COMMAND_TERMINATE)
+                _exit(0);
+            evaluate(p);
+        }
+    }
+
+public:
+    /** @brief The constructor
+     *
+     *  @param fun the functor. Copied in each worker process by fork()
+     *  @param N dimension of the problem
+     *  @param dataset_size number of samples, used for deterministic tags
+     *  @param n_processes number of processes, including the calling one
+     */
+    shared_memory_function(Fun & fun, std::size_t N, std::size_t dataset_size, std::size_t n_processes) : fun_(fun), N_(N), dataset_size_(dataset_size), P_(std::max(n_processes,(std::size_t)1)){
+        std::size_t control_bytes = align(sizeof(control));
+        std::size_t vector_bytes = align(N_*sizeof(ScalarType));
+        std::size_t scalars_bytes = align(P_*sizeof(ScalarType));
+        std::size_t counts_bytes = align(P_*sizeof(std::size_t));
+        std::size_t flags_bytes = align(P_*sizeof(int));
+        bytes_ = control_bytes + scalars_bytes + counts_bytes + flags_bytes + align(sizeof(ScalarType)) + (P_+2)*vector_bytes;
+
+        std::ostringstream name;
+        name << "/umintl-" << getpid() << "-" << this;
+        int fd = shm_open(name.str().c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if(fd < 0)
+            throw exceptions::io_error("Cannot create the shared memory segment " + name.str());
+        //The segment is only reachable through the mapping, which is inherited by the workers
+        shm_unlink(name.str().c_str());
+        if(ftruncate(fd, bytes_) != 0){
+            close(fd);
+            throw exceptions::io_error("Cannot resize the shared memory segment");
+        }
+        void * data = mmap(NULL, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if(data == MAP_FAILED)
+            throw exceptions::io_error("Cannot map the shared memory segment");
+        data_ = static_cast<char *>(data);
+
+        char * ptr = data_;
+        control_ = reinterpret_cast<control *>(ptr); ptr += control_bytes;
+        values_ = reinterpret_cast<ScalarType *>(ptr); ptr += scalars_bytes;
+        counts_ = reinterpret_cast<std::size_t *>(ptr); ptr += counts_bytes;
+        failed_ = reinterpret_cast<int *>(ptr); ptr += flags_bytes;
+        result_value_ = reinterpret_cast<ScalarType *>(ptr); ptr += align(sizeof(ScalarType));
+        x_ = reinterpret_cast<ScalarType *>(ptr); ptr += vector_bytes;
+        result_ = reinterpret_cast<ScalarType *>(ptr); ptr += vector_bytes;
+        gradients_ = reinterpret_cast<ScalarType *>(ptr);
+
+        pthread_barrierattr_t attr;
+        pthread_barrierattr_init(&attr);
+        pthread_barrierattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+        int status = pthread_barrier_init(&control_->barrier, &attr, P_);
+        pthread_barrierattr_destroy(&attr);
+        if(status != 0){
+            munmap(data_, bytes_);
+            throw exceptions::incompatible_parameters("Cannot create the process-shared barrier");
+        }
+
+        for(std::size_t p = 1 ; p < P_ ; ++p){
+            pid_t pid = fork();
+            if(pid == 0)
+                worker_loop(p);
+            if(pid < 0){
+                release(false);
+                throw exceptions::incompatible_parameters("Cannot fork the worker processes");
+            }
+            workers_.push_back(pid);
+        }
+    }
+
+    ~shared_memory_function(){
+        release(true);
+    }
+
+    std::size_t n_processes() const { return P_; }
+
+    void operator()(VectorType const & x, ScalarType & value, VectorType & gradient, umintl::value_gradient tag){
+        control_->command = COMMAND_VALUE_GRADIENT;
+        control_->sample_size = (tag.model==DETERMINISTIC)?dataset_size_:tag.sample_size;
+        control_->offset = (tag.model==DETERMINISTIC)?0:tag.offset;
+        std::memcpy(x_, &x[0], N_*sizeof(ScalarType));
+        wait();
+        evaluate(0);
+        for(std::size_t p = 0 ; p < P_ ; ++p)
+            if(failed_[p])
+                throw exceptions::incompatible_parameters("The evaluation of the functor failed in a worker process");
+        value = *result_value_;
+        for(std::size_t i = 0 ; i < N_ ; ++i)
+            gradient[i] = result_[i];
+    }
+
+private:
+    Fun & fun_;
+    std::size_t N_;
+    std::size_t dataset_size_;
+    std::size_t P_;
+    std::vector<pid_t> workers_;
+
+    std::size_t bytes_;
+    char * data_;
+    control * control_;
+    ScalarType * values_;
+    std::size_t * counts_;
+    int * failed_;
+    ScalarType * result_value_;
+    ScalarType * x_;
+    ScalarType * result_;
+    ScalarType * gradients_;
+};
+
+}
+
+#endif
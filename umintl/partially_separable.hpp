@@ -0,0 +1,177 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+#ifndef UMINTL_PARTIALLY_SEPARABLE_HPP_
+#define UMINTL_PARTIALLY_SEPARABLE_HPP_
+
+#include <vector>
+#include <algorithm>
+
+#include "umintl/forwards.h"
+#include "umintl/tools/shared_ptr.hpp"
+#include "umintl/tools/exception.hpp"
+
+namespace umintl{
+
+/** @brief Base class for an element function
+ *
+ *  An element function only depends on a small subset of the variables of the problem. It is evaluated
+ *  on the (dense) gathered sub-vector of these variables, and returns the gradient with respect to them.
+ */
+template<class BackendType>
+struct element_function{
+    typedef typename BackendType::ScalarType ScalarType;
+    virtual ~element_function(){ }
+    virtual void operator()(ScalarType const * x, ScalarType & value, ScalarType * gradient) const = 0;
+};
+
+/** @brief The partially separable function class
+ *
+ *  Objective of the form f(x) = sum_i f_i(U_i x), where U_i selects the few variables the element function f_i depends on.
+ *  Elements are greedily colored when registered, so that two elements of the same color never share a variable :
+ *  the elements of a color are evaluated in parallel and scatter their gradient without any conflict.
+ *  Can directly be passed to the minimizer, and enables the partitioned_quasi_newton direction.
+ */
+template<class BackendType>
+class partially_separable_function{
+public:
+    typedef typename BackendType::ScalarType ScalarType;
+    typedef typename BackendType::VectorType VectorType;
+
+    partially_separable_function(std::size_t N) : N_(N), var_elements_(N), offsets_(1,0){ }
+
+    /** @brief Registers an element function
+     *
+     *  @param f the element function. Ownership is transferred.
+     *  @param indices the indices of the variables f depends on
+     *  @return the index of the element
+     */
+    std::size_t add(element_function<BackendType> * f, std::vector<std::size_t> const & indices){
+        std::size_t e = elements_.size();
+        std::vector<bool> used;
+        for(std::vector<std::size_t>::const_iterator it = indices.begin() ; it != indices.end() ; ++it){
+            if(*it >= N_)
+                throw exceptions::incompatible_parameters("Element function index out of bounds");
+            for(std::vector<std::size_t>::const_iterator jt = var_elements_[*it].begin() ; jt != var_elements_[*it].end() ; ++jt){
+                std::size_t color = colors_[*jt];
+                if(color >= used.size())
+                    used.resize(color+1,false);
+                used[color] = true;
+            }
+        }
+        std::size_t color = std::find(used.begin(), used.end(), false) - used.begin();
+        for(std::vector<std::size_t>::const_iterator it = indices.begin() ; it != indices.end() ; ++it)
+            var_elements_[*it].push_back(e);
+        if(color >= by_color_.size())
+            by_color_.resize(color+1);
+        by_color_[color].push_back(e);
+
+        elements_.push_back(tools::shared_ptr<element_function<BackendType> >(f));
+        indices_.push_back(indices);
+        colors_.push_back(color);
+        offsets_.push_back(offsets_.back() + indices.size());
+        return e;
+    }
+
+    std::size_t N() const { return N_; }
+    std::size_t n_elements() const { return elements_.size(); }
+    std::size_t n_colors() const { return by_color_.size(); }
+    std::vector<std::size_t> const & indices(std::size_t e) const { return indices_[e]; }
+    std::vector<std::size_t> const & elements_of_color(std::size_t color) const { return by_color_[color]; }
+
+    /** @brief Offset of the element e in the concatenated element vectors (see element_gradients) */
+    std::size_t offset(std::size_t e) const { return offsets_[e]; }
+
+    /** @brief Total size of the concatenated element vectors, ie sum_i n_i */
+    std::size_t elements_size() const { return offsets_.back(); }
+
+    /** @brief Computes the gradient of each element function at x
+     *
+     *  The local gradients are stored contiguously in res, starting at offset(e). No scattering is involved,
+     *  so that all the elements are evaluated in a single parallel loop.
+     */
+    void element_gradients(VectorType const & x, std::vector<ScalarType> & res) const {
+        std::vector<ScalarType> xl(elements_size());
+        res.resize(elements_size());
+        long n_elements = elements_.size();
+        #ifdef _OPENMP
+        #pragma omp parallel for
+        #endif
+        for(long e = 0 ; e < n_elements ; ++e){
+            ScalarType value;
+            gather(e, x, &xl[offsets_[e]]);
+            (*elements_[e])(&xl[offsets_[e]], value, &res[offsets_[e]]);
+        }
+    }
+
+    /** @brief Element gradients of the last evaluation of the value and gradient, if it was at x
+     *
+     *  An evaluation computes all the element gradients before scattering them : they are kept, so that the element curvature
+     *  pairs of the accepted points can be formed without evaluating the function again.
+     *  @return false if the last evaluation was not at x
+     */
+    bool last_element_gradients(VectorType const & x, std::vector<ScalarType> & res) const {
+        if(last_x_.size() != N_)
+            return false;
+        for(std::size_t i = 0 ; i < N_ ; ++i)
+            if(last_x_[i] != x[i])
+                return false;
+        res = last_gl_;
+        return true;
+    }
+
+    void operator()(VectorType const & x, ScalarType & value, VectorType & gradient, umintl::value_gradient) const {
+        std::vector<ScalarType> xl(elements_size());
+        std::vector<ScalarType> & gl = last_gl_;
+        std::vector<ScalarType> values(elements_.size());
+        gl.resize(elements_size());
+        last_x_.resize(N_);
+        for(std::size_t i = 0 ; i < N_ ; ++i)
+            last_x_[i] = x[i];
+        for(std::size_t i = 0 ; i < N_ ; ++i)
+            gradient[i] = 0;
+        for(std::size_t c = 0 ; c < by_color_.size() ; ++c){
+            std::vector<std::size_t> const & elements = by_color_[c];
+            long n_elements = elements.size();
+            #ifdef _OPENMP
+            #pragma omp parallel for
+            #endif
+            for(long k = 0 ; k < n_elements ; ++k){
+                std::size_t e = elements[k];
+                gather(e, x, &xl[offsets_[e]]);
+                (*elements_[e])(&xl[offsets_[e]], values[e], &gl[offsets_[e]]);
+                for(std::size_t j = 0 ; j < indices_[e].size() ; ++j)
+                    gradient[indices_[e][j]] += gl[offsets_[e]+j];
+            }
+        }
+        //Sequential sum, so that the value does not depend on the number of threads
+        value = 0;
+        for(std::size_t e = 0 ; e < values.size() ; ++e)
+            value += values[e];
+    }
+
+private:
+    void gather(std::size_t e, VectorType const & x, ScalarType * res) const {
+        for(std::size_t j = 0 ; j < indices_[e].size() ; ++j)
+            res[j] = x[indices_[e][j]];
+    }
+
+    std::size_t N_;
+    std::vector<tools::shared_ptr<element_function<BackendType> > > elements_;
+    std::vector<std::vector<std::size_t> > indices_;
+    std::vector<std::size_t> colors_;
+    std::vector<std::vector<std::size_t> > by_color_;
+    std::vector<std::vector<std::size_t> > var_elements_;
+    std::vector<std::size_t> offsets_;
+    //Point and element gradients of the last evaluation
+    mutable std::vector<ScalarType> last_x_;
+    mutable std::vector<ScalarType> last_gl_;
+};
+
+}
+
+#endif
@@ -0,0 +1,243 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+#ifndef UMINTL_PHASE_PROFILER_HPP_
+#define UMINTL_PHASE_PROFILER_HPP_
+
+#include <vector>
+#include <iostream>
+#include <iomanip>
+
+#include "umintl/function_wrapper.hpp"
+#include "umintl/tools/perf_counters.hpp"
+#include "umintl/tools/shared_ptr.hpp"
+#include "umintl/tools/timer.hpp"
+
+namespace umintl{
+
+namespace tag{
+
+namespace phase{
+
+enum type{
+    /** Calls to the functor, wherever they happen */
+    EVALUATION,
+    /** Computation of the direction, excluding the evaluations */
+    DIRECTION,
+    /** Arithmetic of the line-search, excluding the evaluations */
+    LINE_SEARCH,
+    /** Stopping criterion */
+    STOPPING_TEST,
+    /** Update of the model, excluding the evaluations */
+    MODEL_UPDATE,
+    N_PHASES
+};
+
+}
+
+}
+
+/** @brief Cost of a phase, accumulated over all its occurrences */
+struct phase_profile{
+    phase_profile() : n_calls(0), time(0){
+        for(int e = 0 ; e < tools::perf_counters::N_EVENTS ; ++e)
+            counts[e] = 0;
+    }
+    unsigned int n_calls;
+    /** @brief wall-clock time, in seconds */
+    double time;
+    /** @brief hardware counts, indexed by tools::perf_counters::event */
+    unsigned long long counts[tools::perf_counters::N_EVENTS];
+};
+
+/** @brief The phase_profiler class
+ *
+ *  Attributes the wall-clock time and the hardware counters (cycles, instructions, LLC misses, branch misses) of the calling thread
+ *  to the phases of the minimizer. The phases nest : the evaluations of the functor performed by the line-search are attributed to
+ *  EVALUATION, and only the remaining work to LINE_SEARCH.
+ *  When the counters are unavailable, only the time and the number of calls are measured. Accumulates over successive runs until reset.
+ */
+class phase_profiler{
+private:
+    phase_profiler(phase_profiler const &);
+    phase_profiler & operator=(phase_profiler const &);
+
+    /** @brief Attributes the costs since the last sample to the innermost phase */
+    void sample(){
+        double now = timer_.get();
+        unsigned long long counts[tools::perf_counters::N_EVENTS];
+        counters_.read(counts);
+        if(!stack_.empty()){
+            phase_profile & p = profiles_[stack_.back()];
+            p.time += now - last_time_;
+            for(int e = 0 ; e < tools::perf_counters::N_EVENTS ; ++e)
+                p.counts[e] += counts[e] - last_counts_[e];
+        }
+        last_time_ = now;
+        for(int e = 0 ; e < tools::perf_counters::N_EVENTS ; ++e)
+            last_counts_[e] = counts[e];
+    }
+
+public:
+    phase_profiler(){ reset(); }
+
+    static const char * name(tag::phase::type phase){
+        static const char * names[] = {"evaluation", "direction", "line-search", "stopping test", "model update"};
+        return names[phase];
+    }
+
+    void begin(tag::phase::type phase){
+        sample();
+        stack_.push_back(phase);
+        profiles_[phase].n_calls++;
+    }
+
+    void end(){
+        sample();
+        if(!stack_.empty())
+            stack_.pop_back();
+    }
+
+    /** @brief Discards the measurements */
+    void reset(){
+        stack_.clear();
+        for(int p = 0 ; p < tag::phase::N_PHASES ; ++p)
+            profiles_[p] = phase_profile();
+        sample();
+    }
+
+    phase_profile const & operator[](tag::phase::type phase) const{ return profiles_[phase]; }
+
+    tools::perf_counters const & counters() const { return counters_; }
+
+    /** @brief Prints one line per phase. Instructions per cycle are shown when both counters are available */
+    void print(std::ostream & os) const{
+        tools::perf_counters::event events[] = {tools::perf_counters::CYCLES, tools::perf_counters::INSTRUCTIONS,
+                                                tools::perf_counters::LLC_MISSES, tools::perf_counters::BRANCH_MISSES};
+        bool has_ipc = counters_.available(tools::perf_counters::CYCLES) && counters_.available(tools::perf_counters::INSTRUCTIONS);
+        os << std::left << std::setw(16) << "phase" << std::right << std::setw(10) << "calls" << std::setw(14) << "time (s)";
+        for(int e = 0 ; e < tools::perf_counters::N_EVENTS ; ++e)
+            if(counters_.available(events[e]))
+                os << std::setw(16) << tools::perf_counters::name(events[e]);
+        if(has_ipc)
+            os << std::setw(8) << "IPC";
+        if(!counters_.available())
+            os << "  (hardware counters unavailable)";
+        os << std::endl;
+        for(int p = 0 ; p < tag::phase::N_PHASES ; ++p){
+            phase_profile const & prof = profiles_[p];
+            os << std::left << std::setw(16) << name((tag::phase::type)p) << std::right << std::setw(10) << prof.n_calls << std::setw(14) << prof.time;
+            for(int e = 0 ; e < tools::perf_counters::N_EVENTS ; ++e)
+                if(counters_.available(events[e]))
+                    os << std::setw(16) << prof.counts[events[e]];
+            if(has_ipc)
+                os << std::setw(8) << std::setprecision(3)
+                   << (prof.counts[tools::perf_counters::CYCLES]?(double)prof.counts[tools::perf_counters::INSTRUCTIONS]/prof.counts[tools::perf_counters::CYCLES]:0)
+                   << std::setprecision(6);
+            os << std::endl;
+        }
+    }
+
+private:
+    tools::perf_counters counters_;
+    tools::timer timer_;
+    std::vector<tag::phase::type> stack_;
+    phase_profile profiles_[tag::phase::N_PHASES];
+    double last_time_;
+    unsigned long long last_counts_[tools::perf_counters::N_EVENTS];
+};
+
+namespace detail{
+
+/** @brief Forwards to another function wrapper, and attributes its computations to tag::phase::EVALUATION */
+template<class BackendType>
+class profiled_function_wrapper : public function_wrapper<BackendType>{
+    typedef typename BackendType::ScalarType ScalarType;
+    typedef typename BackendType::VectorType VectorType;
+    typedef typename BackendType::MatrixType MatrixType;
+
+    /** @brief Ends the phase on exit, including by an exception */
+    struct evaluation_scope{
+        evaluation_scope(phase_profiler & profiler) : profiler_(profiler){ profiler_.begin(tag::phase::EVALUATION); }
+        ~evaluation_scope(){ profiler_.end(); }
+        phase_profiler & profiler_;
+    };
+
+public:
+    profiled_function_wrapper(function_wrapper<BackendType> * fun, tools::shared_ptr<phase_profiler> const & profiler) : fun_(fun), profiler_(profiler){ }
+
+    unsigned int n_value_computations() const { return fun_->n_value_computations(); }
+    unsigned int n_gradient_computations() const { return fun_->n_gradient_computations(); }
+    unsigned int n_hessian_vector_product_computations() const { return fun_->n_hessian_vector_product_computations(); }
+    unsigned int n_datapoints_accessed() const { return fun_->n_datapoints_accessed(); }
+    computation_type hessian_vector_product_computation() const { return fun_->hessian_vector_product_computation(); }
+
+    void compute_value_gradient(VectorType const & x, ScalarType & value, VectorType & gradient, value_gradient const & tag){
+        evaluation_scope scope(*profiler_);
+        fun_->compute_value_gradient(x,value,gradient,tag);
+    }
+
+    void extend_value_gradient(VectorType const & x, ScalarType & value, VectorType & gradient, value_gradient const & evaluated, value_gradient const & tag){
+        evaluation_scope scope(*profiler_);
+        fun_->extend_value_gradient(x,value,gradient,evaluated,tag);
+    }
+
+    void compute_hv_product(VectorType const & x, VectorType const & g, VectorType const & v, VectorType & Hv, hessian_vector_product const & tag){
+        evaluation_scope scope(*profiler_);
+        fun_->compute_hv_product(x,g,v,Hv,tag);
+    }
+
+    void compute_gradient_variance(VectorType const & x, VectorType & variance, gradient_variance const & tag){
+        evaluation_scope scope(*profiler_);
+        fun_->compute_gradient_variance(x,variance,tag);
+    }
+
+    void compute_value_gradient_variance(VectorType const & x, ScalarType & value, VectorType & gradient, VectorType & variance, value_gradient_variance const & tag){
+        evaluation_scope scope(*profiler_);
+        fun_->compute_value_gradient_variance(x,value,gradient,variance,tag);
+    }
+
+    void track_gradient_variance(bool track){ fun_->track_gradient_variance(track); }
+
+    void compute_hv_product_variance(VectorType const & x, VectorType const & v, VectorType & variance, hv_product_variance const & tag){
+        evaluation_scope scope(*profiler_);
+        fun_->compute_hv_product_variance(x,v,variance,tag);
+    }
+
+    void compute_residuals_jacobian(VectorType const & x, VectorType & r, MatrixType & J, residuals_jacobian const & tag){
+        evaluation_scope scope(*profiler_);
+        fun_->compute_residuals_jacobian(x,r,J,tag);
+    }
+
+    void compute_gauss_newton_product(VectorType const & x, VectorType const & v, VectorType & Gv, gauss_newton_vector_product const & tag){
+        evaluation_scope scope(*profiler_);
+        fun_->compute_gauss_newton_product(x,v,Gv,tag);
+    }
+
+    void compute_sample_derivatives(VectorType const & x, ScalarType & value, VectorType & derivatives, sample_derivatives const & tag){
+        evaluation_scope scope(*profiler_);
+        fun_->compute_sample_derivatives(x,value,derivatives,tag);
+    }
+
+    void compute_sample_combination(VectorType const & weights, VectorType & res, sample_combination const & tag){
+        evaluation_scope scope(*profiler_);
+        fun_->compute_sample_combination(weights,res,tag);
+    }
+
+    void save_state(tools::state_writer & writer) const { fun_->save_state(writer); }
+    void load_state(tools::state_reader & reader){ fun_->load_state(reader); }
+
+private:
+    tools::shared_ptr<function_wrapper<BackendType> > fun_;
+    tools::shared_ptr<phase_profiler> profiler_;
+};
+
+}
+
+}
+
+#endif
@@ -0,0 +1,163 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+#ifndef UMINTL_TOOLS_ASYNC_FILE_WRITER_HPP_
+#define UMINTL_TOOLS_ASYNC_FILE_WRITER_HPP_
+
+#include <vector>
+#include <string>
+#include <cstdio>
+
+#include <pthread.h>
+
+#include "umintl/tools/exception.hpp"
+
+namespace umintl{
+
+namespace tools{
+
+/** @brief The async_file_writer class
+ *
+ *  Writes snapshots to a file from a background thread. The snapshots are double-buffered : the caller fills a buffer
+ *  while the thread writes the previous one. A snapshot which is still pending when the next one is submitted is
+ *  replaced, so that submit never waits for the disk. Each snapshot is written to filename.tmp, then renamed, so that
+ *  the file always contains a complete snapshot.
+ */
+class async_file_writer{
+private:
+    async_file_writer(async_file_writer const &);
+    async_file_writer & operator=(async_file_writer const &);
+
+    static void * run(void * args){
+        static_cast<async_file_writer *>(args)->loop();
+        return NULL;
+    }
+
+    void loop(){
+        pthread_mutex_lock(&mutex_);
+        while(true){
+            while(!has_pending_ && !stop_)
+                pthread_cond_wait(&cond_, &mutex_);
+            if(!has_pending_)
+                break;
+            writing_.swap(pending_);
+            has_pending_ = false;
+            is_writing_ = true;
+            pthread_mutex_unlock(&mutex_);
+
+            std::string error = write(writing_);
+
+            pthread_mutex_lock(&mutex_);
+            is_writing_ = false;
+            if(!error.empty())
+                error_ = error;
+            else
+                n_written_++;
+            pthread_cond_broadcast(&cond_);
+        }
+        pthread_mutex_unlock(&mutex_);
+    }
+
+    std::string write(std::vector<char> const & data) const{
+        std::string tmp = filename_ + ".tmp";
+        FILE * file = std::fopen(tmp.c_str(), "wb");
+        if(!file)
+            return "Cannot open " + tmp;
+        bool failed = data.size() && std::fwrite(&data[0], 1, data.size(), file) != data.size();
+        failed = (std::fclose(file) != 0) || failed;
+        if(failed || std::rename(tmp.c_str(), filename_.c_str()) != 0)
+            return "Cannot write " + filename_;
+        return "";
+    }
+
+    void rethrow(){
+        if(!error_.empty()){
+            std::string error = error_;
+            error_.clear();
+            throw exceptions::io_error(error);
+        }
+    }
+
+public:
+    async_file_writer(std::string const & filename) : filename_(filename), has_pending_(false), is_writing_(false), stop_(false), n_written_(0){
+        pthread_mutex_init(&mutex_, NULL);
+        pthread_cond_init(&cond_, NULL);
+        if(pthread_create(&thread_, NULL, &async_file_writer::run, this) != 0){
+            pthread_mutex_destroy(&mutex_);
+            pthread_cond_destroy(&cond_);
+            throw exceptions::io_error("Cannot create the writer thread of " + filename);
+        }
+    }
+
+    ~async_file_writer(){
+        pthread_mutex_lock(&mutex_);
+        stop_ = true;
+        pthread_cond_signal(&cond_);
+        pthread_mutex_unlock(&mutex_);
+        pthread_join(thread_, NULL);
+        pthread_mutex_destroy(&mutex_);
+        pthread_cond_destroy(&cond_);
+    }
+
+    /** @brief Hands snapshot over to the writer, and gives back a buffer to be reused for the next snapshot. Reports the failure of a previous write */
+    void submit(std::vector<char> & snapshot){
+        pthread_mutex_lock(&mutex_);
+        pending_.swap(snapshot);
+        has_pending_ = true;
+        pthread_cond_signal(&cond_);
+        try{
+            rethrow();
+        }
+        catch(...){
+            pthread_mutex_unlock(&mutex_);
+            throw;
+        }
+        pthread_mutex_unlock(&mutex_);
+    }
+
+    /** @brief Waits until the last submitted snapshot is on disk */
+    void flush(){
+        pthread_mutex_lock(&mutex_);
+        while(has_pending_ || is_writing_)
+            pthread_cond_wait(&cond_, &mutex_);
+        try{
+            rethrow();
+        }
+        catch(...){
+            pthread_mutex_unlock(&mutex_);
+            throw;
+        }
+        pthread_mutex_unlock(&mutex_);
+    }
+
+    /** @brief Number of snapshots written so far */
+    unsigned int n_written(){
+        pthread_mutex_lock(&mutex_);
+        unsigned int res = n_written_;
+        pthread_mutex_unlock(&mutex_);
+        return res;
+    }
+
+private:
+    std::string filename_;
+    pthread_t thread_;
+    pthread_mutex_t mutex_;
+    pthread_cond_t cond_;
+    std::vector<char> pending_;
+    std::vector<char> writing_;
+    bool has_pending_;
+    bool is_writing_;
+    bool stop_;
+    std::string error_;
+    unsigned int n_written_;
+};
+
+}
+
+}
+
+#endif
@@ -20,6 +20,18 @@ private:
   std::string message_;
 };
 
+/** @brief Exception class in the case of input/output errors*/
+class io_error : public std::exception
+{
+public:
+  io_error() : message_() {}
+  io_error(std::string message) : message_("UMinTL: I/O error: " + message) {}
+  virtual const char* what() const throw() { return message_.c_str(); }
+  virtual ~io_error() throw() {}
+private:
+  std::string message_;
+};
+
 
 }
 
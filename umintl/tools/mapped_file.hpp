@@ -0,0 +1,181 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+#ifndef UMINTL_TOOLS_MAPPED_FILE_HPP
+#define UMINTL_TOOLS_MAPPED_FILE_HPP
+
+#include <string>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "umintl/tools/exception.hpp"
+
+namespace umintl{
+
+namespace tools{
+
+/** @brief Read-only memory mapping of a whole file
+ *
+ *  The pages are only read from the disk when they are first accessed, so that mapping a file is cheap regardless of its size.
+ *  Non copyable.
+ */
+class mapped_file{
+private:
+    mapped_file(mapped_file const &);
+    mapped_file & operator=(mapped_file const &);
+
+    static std::string error_string(std::string const & what, std::string const & path){
+        return what + " " + path + " : " + std::strerror(errno);
+    }
+
+public:
+    enum advice{
+        ADVICE_NORMAL = MADV_NORMAL,
+        ADVICE_SEQUENTIAL = MADV_SEQUENTIAL,
+        ADVICE_RANDOM = MADV_RANDOM,
+        ADVICE_WILLNEED = MADV_WILLNEED,
+        ADVICE_DONTNEED = MADV_DONTNEED
+    };
+
+    mapped_file(std::string const & path) : data_(NULL), size_(0){
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0)
+            throw exceptions::io_error(error_string("Cannot open",path));
+        struct stat st;
+        if(::fstat(fd, &st) < 0){
+            ::close(fd);
+            throw exceptions::io_error(error_string("Cannot stat",path));
+        }
+        size_ = st.st_size;
+        if(size_ > 0){
+            void * ptr = ::mmap(NULL, size_, PROT_READ, MAP_SHARED, fd, 0);
+            if(ptr == MAP_FAILED){
+                ::close(fd);
+                throw exceptions::io_error(error_string("Cannot map",path));
+            }
+            data_ = static_cast<char const *>(ptr);
+        }
+        //The mapping remains valid once the descriptor is closed
+        ::close(fd);
+    }
+
+    ~mapped_file(){
+        if(data_)
+            ::munmap(const_cast<char *>(data_), size_);
+    }
+
+    char const * data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+    /** @brief Hints the kernel about the use of the bytes [offset, offset + length)
+     *
+     *  The range is extended to page boundaries. Hints are advisory : failures are silently ignored.
+     */
+    void advise(std::size_t offset, std::size_t length, advice a) const{
+        if(data_==NULL || length==0 || offset >= size_)
+            return;
+        static const std::size_t page_size = ::sysconf(_SC_PAGESIZE);
+        std::size_t begin = offset - offset%page_size;
+        std::size_t end = std::min(offset + length, size_);
+        ::madvise(const_cast<char *>(data_) + begin, end - begin, a);
+    }
+
+    /** @brief Hints the kernel about the use of the whole file */
+    void advise(advice a) const{
+        advise(0, size_, a);
+    }
+
+private:
+    char const * data_;
+    std::size_t size_;
+};
+
+/** @brief Read-write memory mapping of a scratch file
+ *
+ *  The file is created (or truncated) with the requested size, and removed by the destructor. It is sparse until written, so
+ *  that its pages do not need to be read before they are first written. Non copyable.
+ */
+class scratch_mapped_file{
+private:
+    scratch_mapped_file(scratch_mapped_file const &);
+    scratch_mapped_file & operator=(scratch_mapped_file const &);
+
+    static std::string error_string(std::string const & what, std::string const & path){
+        return what + " " + path + " : " + std::strerror(errno);
+    }
+
+public:
+    scratch_mapped_file(std::string const & path, std::size_t size) : path_(path), data_(NULL), size_(size){
+        int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+        if(fd < 0)
+            throw exceptions::io_error(error_string("Cannot create",path));
+        if(::ftruncate(fd, size_) < 0){
+            ::close(fd);
+            ::unlink(path.c_str());
+            throw exceptions::io_error(error_string("Cannot resize",path));
+        }
+        if(size_ > 0){
+            void * ptr = ::mmap(NULL, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if(ptr == MAP_FAILED){
+                ::close(fd);
+                ::unlink(path.c_str());
+                throw exceptions::io_error(error_string("Cannot map",path));
+            }
+            data_ = static_cast<char *>(ptr);
+        }
+        ::close(fd);
+    }
+
+    ~scratch_mapped_file(){
+        if(data_)
+            ::munmap(data_, size_);
+        ::unlink(path_.c_str());
+    }
+
+    char * data() { return data_; }
+    std::size_t size() const { return size_; }
+
+    /** @brief Hints the kernel about the use of the bytes [offset, offset + length). See mapped_file::advise */
+    void advise(std::size_t offset, std::size_t length, mapped_file::advice a) const{
+        if(data_==NULL || length==0 || offset >= size_)
+            return;
+        std::size_t begin = offset - offset%page_size();
+        std::size_t end = std::min(offset + length, size_);
+        ::madvise(data_ + begin, end - begin, a);
+    }
+
+    /** @brief Starts writing back the modified pages of [offset, offset + length), without waiting for the disk */
+    void sync_async(std::size_t offset, std::size_t length) const{
+        if(data_==NULL || length==0 || offset >= size_)
+            return;
+        std::size_t begin = offset - offset%page_size();
+        std::size_t end = std::min(offset + length, size_);
+        ::msync(data_ + begin, end - begin, MS_ASYNC);
+    }
+
+private:
+    static std::size_t page_size(){
+        static const std::size_t res = ::sysconf(_SC_PAGESIZE);
+        return res;
+    }
+
+    std::string path_;
+    char * data_;
+    std::size_t size_;
+};
+
+}
+
+}
+
+#endif
@@ -0,0 +1,116 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+#ifndef UMINTL_TOOLS_PERF_COUNTERS_HPP_
+#define UMINTL_TOOLS_PERF_COUNTERS_HPP_
+
+#include <cstring>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <linux/perf_event.h>
+#endif
+
+namespace umintl{
+
+namespace tools{
+
+/** @brief The perf_counters class
+ *
+ *  Hardware counters of the calling thread, in user space, read through the perf_event interface of Linux. The counters are
+ *  opened as a single group, so that they are scheduled together and read with one system call.
+ *  Never throws : the counters which cannot be opened (other platforms, no PMU in a virtual machine, perf_event_paranoid > 2...)
+ *  are reported as unavailable, and read as 0.
+ */
+class perf_counters{
+private:
+    perf_counters(perf_counters const &);
+    perf_counters & operator=(perf_counters const &);
+
+public:
+    enum event{ CYCLES, INSTRUCTIONS, LLC_MISSES, BRANCH_MISSES, N_EVENTS };
+
+    static const char * name(event e){
+        static const char * names[] = {"cycles", "instructions", "LLC misses", "branch misses"};
+        return names[e];
+    }
+
+    perf_counters() : leader_(-1), n_opened_(0){
+        for(int e = 0 ; e < N_EVENTS ; ++e)
+            index_[e] = -1;
+#ifdef __linux__
+        static const unsigned long long configs[] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                                     PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+        for(int e = 0 ; e < N_EVENTS ; ++e){
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[e];
+            attr.read_format = PERF_FORMAT_GROUP;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.disabled = (leader_ < 0);
+            int fd = syscall(__NR_perf_event_open, &attr, 0, -1, leader_, 0);
+            if(fd < 0)
+                continue;
+            if(leader_ < 0)
+                leader_ = fd;
+            fds_[n_opened_] = fd;
+            index_[e] = n_opened_++;
+        }
+        if(leader_ >= 0)
+            ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    ~perf_counters(){
+#ifdef __linux__
+        for(int i = n_opened_ - 1 ; i >= 0 ; --i)
+            close(fds_[i]);
+#endif
+    }
+
+    /** @brief Whether at least one counter could be opened */
+    bool available() const{ return n_opened_ > 0; }
+
+    bool available(event e) const{ return index_[e] >= 0; }
+
+    /** @brief Current counts since the construction, indexed by event. Returns false, with all counts set to 0, if the counters cannot be read */
+    bool read(unsigned long long counts[N_EVENTS]) const{
+        for(int e = 0 ; e < N_EVENTS ; ++e)
+            counts[e] = 0;
+#ifdef __linux__
+        if(n_opened_ == 0)
+            return false;
+        //Layout of PERF_FORMAT_GROUP : the number of counters, followed by their values
+        unsigned long long buffer[1 + N_EVENTS];
+        if(::read(leader_, buffer, sizeof(buffer)) < (ssize_t)((1 + n_opened_)*sizeof(unsigned long long)))
+            return false;
+        for(int e = 0 ; e < N_EVENTS ; ++e)
+            if(index_[e] >= 0)
+                counts[e] = buffer[1 + index_[e]];
+        return true;
+#else
+        return false;
+#endif
+    }
+
+private:
+    int leader_;
+    int fds_[N_EVENTS];
+    int index_[N_EVENTS];
+    int n_opened_;
+};
+
+}
+
+}
+
+#endif
@@ -0,0 +1,145 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+#ifndef UMINTL_TOOLS_SERIALIZATION_HPP_
+#define UMINTL_TOOLS_SERIALIZATION_HPP_
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdio>
+
+#include "umintl/tools/exception.hpp"
+
+namespace umintl{
+
+namespace tools{
+
+/** @brief The state_writer class
+ *
+ *  Appends the state of the components of the minimizer to an in-memory buffer. Scalars are stored in the native
+ *  byte order, so that the buffer can only be read back on the same architecture. Vectors are accessed element-wise
+ *  with operator[], and therefore require a host backend.
+ */
+class state_writer{
+public:
+    state_writer(std::vector<char> & buffer) : buffer_(buffer){ }
+
+    template<class T>
+    void write(T const & value){
+        write_bytes(&value, sizeof(T));
+    }
+
+    void write_string(std::string const & str){
+        write<unsigned long long>(str.size());
+        write_bytes(str.data(), str.size());
+    }
+
+    /** @brief Writes the N first elements of x */
+    template<class ScalarType, class VectorType>
+    void write_vector(VectorType const & x, std::size_t N){
+        write<unsigned long long>(N);
+        std::size_t begin = buffer_.size();
+        buffer_.resize(begin + N*sizeof(ScalarType));
+        ScalarType * ptr = reinterpret_cast<ScalarType *>(&buffer_[begin]);
+        for(std::size_t i = 0 ; i < N ; ++i)
+            ptr[i] = x[i];
+    }
+
+private:
+    void write_bytes(void const * data, std::size_t size){
+        char const * ptr = static_cast<char const *>(data);
+        buffer_.insert(buffer_.end(), ptr, ptr + size);
+    }
+
+    std::vector<char> & buffer_;
+};
+
+/** @brief The state_reader class
+ *
+ *  Reads back, in the same order, the state written by a state_writer. Throws exceptions::io_error when the buffer
+ *  is too short or does not match the expected layout.
+ */
+class state_reader{
+public:
+    state_reader() : position_(0){ }
+    state_reader(std::vector<char> const & buffer) : buffer_(buffer), position_(0){ }
+
+    /** @brief Loads the whole file in memory */
+    void load(std::string const & filename){
+        FILE * file = std::fopen(filename.c_str(), "rb");
+        if(!file)
+            throw exceptions::io_error("Cannot open " + filename);
+        buffer_.clear();
+        char chunk[65536];
+        std::size_t n;
+        while((n = std::fread(chunk, 1, sizeof(chunk), file)) > 0)
+            buffer_.insert(buffer_.end(), chunk, chunk + n);
+        bool failed = std::ferror(file);
+        std::fclose(file);
+        if(failed)
+            throw exceptions::io_error("Cannot read " + filename);
+        position_ = 0;
+    }
+
+    template<class T>
+    T read(){
+        T value;
+        read_bytes(&value, sizeof(T));
+        return value;
+    }
+
+    std::string read_string(){
+        std::size_t size = read<unsigned long long>();
+        check(size);
+        std::string res(&buffer_[0] + position_, size);
+        position_ += size;
+        return res;
+    }
+
+    /** @brief Reads a vector of N elements into x */
+    template<class ScalarType, class VectorType>
+    void read_vector(VectorType & x, std::size_t N){
+        if(read<unsigned long long>() != N)
+            throw exceptions::io_error("Corrupted state : unexpected vector size");
+        check(N*sizeof(ScalarType));
+        for(std::size_t i = 0 ; i < N ; ++i){
+            ScalarType value;
+            std::memcpy(&value, &buffer_[position_], sizeof(ScalarType));
+            x[i] = value;
+            position_ += sizeof(ScalarType);
+        }
+    }
+
+    /** @brief Reads a string, and throws if it differs from expected */
+    void expect(std::string const & expected){
+        std::string str = read_string();
+        if(str != expected)
+            throw exceptions::io_error("Incompatible state : expected \"" + expected + "\", found \"" + str + "\"");
+    }
+
+private:
+    void check(std::size_t size){
+        if(position_ + size > buffer_.size())
+            throw exceptions::io_error("Corrupted state : unexpected end of data");
+    }
+
+    void read_bytes(void * data, std::size_t size){
+        check(size);
+        std::memcpy(data, &buffer_[0] + position_, size);
+        position_ += size;
+    }
+
+    std::vector<char> buffer_;
+    std::size_t position_;
+};
+
+}
+
+}
+
+#endif
@@ -0,0 +1,41 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+#ifndef UMINTL_TOOLS_TIMER_HPP_
+#define UMINTL_TOOLS_TIMER_HPP_
+
+#include <ctime>
+
+namespace umintl{
+
+namespace tools{
+
+/** @brief Wall-clock timer, based on the monotonic clock */
+class timer{
+public:
+    timer(){ start(); }
+
+    void start(){
+        clock_gettime(CLOCK_MONOTONIC, &start_);
+    }
+
+    /** @brief Seconds elapsed since the last call to start */
+    double get() const{
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return (now.tv_sec - start_.tv_sec) + 1e-9*(now.tv_nsec - start_.tv_nsec);
+    }
+
+private:
+    timespec start_;
+};
+
+}
+
+}
+
+#endif
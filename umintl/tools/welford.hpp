@@ -0,0 +1,65 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+#ifndef UMINTL_TOOLS_WELFORD_HPP_
+#define UMINTL_TOOLS_WELFORD_HPP_
+
+#include <cstddef>
+#include <vector>
+
+namespace umintl{
+
+namespace tools{
+
+/** @brief Streaming mean and variance of per-sample values and gradients
+ *
+ *  Welford's update : each sample is added once, so that a functor can return the mean gradient and its
+ *  (unbiased) variance in a single pass over the data, as required by the umintl::value_gradient_variance overload.
+ */
+template<class ScalarType>
+class welford{
+public:
+    welford(std::size_t N) : N_(N), count_(0), value_(0), mean_(N,0), m2_(N,0){ }
+
+    /** @brief Adds the value and the gradient of one sample */
+    void add(ScalarType value, ScalarType const * gradient){
+        ++count_;
+        value_ += (value - value_)/count_;
+        for(std::size_t i = 0 ; i < N_ ; ++i){
+            ScalarType delta = gradient[i] - mean_[i];
+            mean_[i] += delta/count_;
+            m2_[i] += delta*(gradient[i] - mean_[i]);
+        }
+    }
+
+    std::size_t count() const { return count_; }
+
+    /** @brief Mean of the values */
+    ScalarType value() const { return value_; }
+
+    /** @brief Mean of the gradients, and their variance (0 for less than two samples) */
+    template<class VectorType>
+    void get(VectorType & gradient, VectorType & variance) const {
+        for(std::size_t i = 0 ; i < N_ ; ++i){
+            gradient[i] = mean_[i];
+            variance[i] = (count_>1)?m2_[i]/(count_-1):0;
+        }
+    }
+
+private:
+    std::size_t N_;
+    std::size_t count_;
+    ScalarType value_;
+    std::vector<ScalarType> mean_;
+    std::vector<ScalarType> m2_;
+};
+
+}
+
+}
+
+#endif
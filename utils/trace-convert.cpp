@@ -0,0 +1,89 @@
+/* ===========================
+  Copyright (c) 2013 Philippe Tillet
+  UMinTL - Unconstrained Minimization Template Library
+
+  License : MIT X11 - See the LICENSE file in the root folder
+ * ===========================*/
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+#include "umintl/tools/exception.hpp"
+#include "umintl/observers/trace_recorder.hpp"
+
+using namespace umintl;
+
+static const char * fields[] = {"iter", "n_line_search_evaluations", "n_value_computations", "n_gradient_computations",
+                                "n_hessian_vector_product_computations", "n_datapoints_accessed", "sample_size",
+                                "value", "gradient_norm", "dphi_0", "alpha",
+                                "direction_time", "line_search_time", "model_time", "elapsed_time"};
+static const std::size_t n_fields = sizeof(fields)/sizeof(fields[0]);
+
+/** @brief Prints the fields of r, in the order of fields, separated by sep */
+void print_record(std::ostream & os, trace_record const & r, const char * sep){
+    os << r.iter << sep << r.n_line_search_evaluations << sep << r.n_value_computations << sep << r.n_gradient_computations
+       << sep << r.n_hessian_vector_product_computations << sep << r.n_datapoints_accessed << sep << r.sample_size
+       << sep << r.value << sep << r.gradient_norm << sep << r.dphi_0 << sep << r.alpha
+       << sep << r.direction_time << sep << r.line_search_time << sep << r.model_time << sep << r.elapsed_time;
+}
+
+void print_csv(std::ostream & os, std::vector<trace_record> const & records){
+    for(std::size_t i = 0 ; i < n_fields ; ++i)
+        os << (i?",":"") << fields[i];
+    os << '\n';
+    for(std::size_t k = 0 ; k < records.size() ; ++k){
+        print_record(os, records[k], ",");
+        os << '\n';
+    }
+}
+
+/** @brief One array per field, which is more compact than one object per record */
+void print_json(std::ostream & os, std::vector<trace_record> const & records){
+    std::vector<std::string> columns(n_fields);
+    for(std::size_t k = 0 ; k < records.size() ; ++k){
+        std::ostringstream line;
+        line << std::setprecision(17);
+        print_record(line, records[k], " ");
+        std::istringstream values(line.str());
+        for(std::size_t i = 0 ; i < n_fields ; ++i){
+            std::string value;
+            values >> value;
+            //inf and nan are not valid JSON
+            if(value.find_first_of("ni") != std::string::npos)
+                value = "null";
+            columns[i] += (k?",":"") + value;
+        }
+    }
+    os << "{\n";
+    for(std::size_t i = 0 ; i < n_fields ; ++i)
+        os << "  \"" << fields[i] << "\": [" << columns[i] << "]" << (i+1<n_fields?",":"") << '\n';
+    os << "}\n";
+}
+
+int main(int argc, char* argv[]){
+    bool json = argc==3 && std::strcmp(argv[1],"--json")==0;
+    if(argc!=2 && !json){
+        std::cerr << "Usage : " << argv[0] << " [--json] TRACE" << std::endl;
+        std::cerr << "Converts a trace written by umintl::trace_recorder to CSV (default) or JSON, on the standard output" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::vector<trace_record> records;
+    try{
+        load_trace(argv[argc-1], records);
+    }
+    catch(exceptions::io_error const & e){
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << std::setprecision(17);
+    if(json)
+        print_json(std::cout, records);
+    else
+        print_csv(std::cout, records);
+    return EXIT_SUCCESS;
+}